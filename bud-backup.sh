@@ -11,13 +11,14 @@
 
 usage()
 {
-    echo "Usage: $0 [-h] [-f] [-d] -k {yes|no|ask} -g /path/to/the/.gnupg/path -i /input/path | \
+    echo "Usage: $0 [-h] [-f] [-d] [-w] -k {yes|no|ask} -g /path/to/the/.gnupg/path -i /input/path | \
 sagittarius-mike | sagittarius-family | \
 virgo-wsl-mike | virgo-wsl-family | \
 virgo-wsl-video | virgo-wsl-music | virgo-wsl-photo"
     echo '  -h: help me'
     echo '  -f: force a full backup'
     echo '  -d: dry run'
+    echo '  -w: create the hash + ecc files of each volume during the backup'
     echo '  -k: keep .gnupg files'
     echo '  -g: path to .gnupg'
     echo '  -i: input path'
@@ -38,6 +39,8 @@ esac
 FULL=
 # Simulate a backup without changing anything on disk
 DRY=
+# Create the hash + ecc files of each volume as soon as duplicity closes it
+WATCH=
 # Answer to the last question to keep or not the gnupg directory
 KEEP_GNUPG=
 # The gnupg directory with keys
@@ -46,7 +49,7 @@ GNUPG_PATH=
 INPUT_PATH=
 
 # Process all the parameters
-while getopts ":hfdk:g:i:" option; do
+while getopts ":hfdwk:g:i:" option; do
     case "${option}" in
         f)
             FULL='full'
@@ -54,6 +57,9 @@ while getopts ":hfdk:g:i:" option; do
         d)
             DRY='--dry-run'
             ;;
+        w)
+            WATCH='yes'
+            ;;
         k)
             KEEP_GNUPG=${OPTARG}
             ;;
@@ -209,12 +215,28 @@ fi
 OPTIONS_GPG="--homedir=$GNUPG_PATH"
 
 echo 'Start stuff...'
+
+# The watcher must be ready before the first volume is closed (the volumes it misses are left to ecc.py create)
+# The hash + ecc paths are relative to the current directory, as the ones of hash-create.sh and ecc.py
+WATCH_PID=
+if [[ -n $WATCH && -z $DRY ]]; then
+    mkdir -p "$OUTPUT_PATH"
+    "$(dirname "$0")/ecc-schifra-255-32-8" -v watch --sha512 -i "./${OUTPUT_PATH#"$(pwd)"/}" &
+    WATCH_PID=$!
+fi
+
 # --allow-source-mismatch: when problem with domain name in an incremental backup
 # (But try to avoid it if possible)
 duplicity $FULL $DRY --volsize 2000 --progress --progress-rate 60 --gpg-binary gpg1 --gpg-options "$OPTIONS_GPG" $OPTIONS \
             --encrypt-key 63BAF710 --sign-key CA12167B \
             "$INPUT_PATH" "file://$OUTPUT_PATH"
 
+# The watcher stops once the last volumes are encoded
+if [[ -n $WATCH_PID ]]; then
+    kill -TERM "$WATCH_PID"
+    wait "$WATCH_PID"
+fi
+
 # Set (again) the interpretation of wildcard to manage chmod
 GLOBIGNORE=
 
@@ -0,0 +1,189 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+/*
+   Description: The crc index of the ecc files: the CRC32C check value,
+                the records round trip, and the decode of segments with
+                bursts beyond the errors only capacity (up to fec_length
+                symbols, found by the crc) and with a damaged crc.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "ecc-crc-index.hpp"
+#include "ecc-decoder.hpp"
+#include "ecc-encoder.hpp"
+
+
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+typedef schifra::reed_solomon::crc_index<code_length,fec_length> crc_index_t;
+
+bool crc_validation_test()
+{
+   // The check value of CRC32C
+   const unsigned char check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+   const unsigned char no_parity[fec_length] = { 0 };
+
+   crc_index_t crc;
+   schifra::crc32 reference( crc_index_t::polynomial, 0xFFFFFFFF );
+   reference.update( check, sizeof( check ) );
+   if( std::uint32_t( ~reference.crc() ) != 0xE3069283 )
+   {
+      std::cout << "Error - CRC32C check value: " << std::hex << std::uint32_t( ~reference.crc() ) << std::dec << std::endl;
+      return false;
+   }
+
+   // The parity is part of the crc of a codeword
+   if( crc.codeword_crc( check, sizeof( check ), no_parity ) == 0xE3069283 )
+   {
+      std::cout << "Error - CRC of a codeword without its parity" << std::endl;
+      return false;
+   }
+
+   std::vector<char> parity( 3 * fec_length );
+   std::vector<std::uint32_t> crcs = { 0x01020304, 0xFFFFFFFF, 0xE3069283 };
+   for( std::size_t i = 0; i < parity.size(); i++ )
+      parity[i] = char( i * 7 );
+
+   std::vector<char> records( 3 * crc_index_t::record_length );
+   crc_index_t::merge( parity.data(), crcs.data(), 3, records.data() );
+
+   std::vector<char> split_parity( parity.size() );
+   std::vector<std::uint32_t> split_crcs( 3 );
+   crc_index_t::split( records.data(), 3, split_parity.data(), split_crcs.data() );
+
+   if( split_parity != parity || split_crcs != crcs || records[fec_length] != 0x04 )
+   {
+      std::cout << "Error - Crc index records round trip" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+// A burst of iBurstLength bytes in every codeword of a segment (at a position depending on the codeword)
+bool burst_validation_test( const std::size_t iDataSize, const std::size_t iBurstLength, const bool iCrcIndex, const bool iDamagedCrc, const bool iExpected )
+{
+   typedef schifra::reed_solomon::batch_encoder<code_length,fec_length>    encoder_t;
+   typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length>    decoder_t;
+   typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length>   syndrome_t;
+   typedef schifra::reed_solomon::segment_encoder<code_length,fec_length>  segment_encoder_t;
+   typedef schifra::reed_solomon::segment_decoder<code_length,fec_length>  segment_decoder_t;
+   typedef schifra::reed_solomon::segment_verifier<code_length,fec_length> segment_verifier_t;
+
+   const schifra::galois::field field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
+
+   schifra::galois::field_polynomial generator( field );
+   if( !schifra::make_sequential_root_generator_polynomial( field, 120, fec_length, generator ) )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t encoder( field, generator );
+   const decoder_t decoder( field, 120 );
+   const syndrome_t syndrome( field, 120 );
+
+   const std::size_t block_count = ( iDataSize + data_length - 1 ) / data_length;
+
+   std::vector<char> data( iDataSize );
+   for( auto& byte : data )
+      byte = char( ::rand() );
+
+   std::vector<char> parity( block_count * fec_length );
+   std::vector<std::uint32_t> crcs( block_count );
+   segment_encoder_t( encoder, data.data(), data.size(), parity.data(), crcs.data() );
+
+   std::vector<char> damaged( data );
+   for( std::size_t i = 0; i < block_count; i++ )
+   {
+      const std::size_t size = std::min( data_length, iDataSize - i * data_length );
+      const std::size_t length = std::min( iBurstLength, size );
+      const std::size_t start = i * data_length + ( i * 37 ) % ( size - length + 1 );
+      for( std::size_t j = start; j < start + length; j++ )
+         damaged[j] = char( ~damaged[j] );
+   }
+
+   // A damaged crc of a clean codeword: the data is still output as is
+   if( iDamagedCrc )
+      crcs[0] ^= 1;
+
+   std::vector<char> output( iDataSize );
+   segment_decoder_t segment_decoder( decoder, syndrome, damaged.data(), damaged.size(), parity.data(), output.data(), 0, iCrcIndex ? crcs.data() : nullptr );
+
+   std::vector<schifra::reed_solomon::corrupted_block> corrupted;
+   segment_verifier_t( decoder, syndrome, damaged.data(), damaged.size(), parity.data(), corrupted, 0, iCrcIndex ? crcs.data() : nullptr );
+
+   bool correctable = !corrupted.empty() || !iBurstLength;
+   for( const auto& block : corrupted )
+      correctable = correctable && block.mCorrectable;
+
+   const bool decoded = !segment_decoder.failed_blocks() && output == data;
+   if( decoded != iExpected || correctable != iExpected )
+   {
+      std::cout << "Error - Segment of " << iDataSize << " bytes with bursts of " << iBurstLength << " bytes" << ( iCrcIndex ? " (crc index" : " (no crc index" ) << ( iDamagedCrc ? ", damaged crc)" : ")" )
+                << ": decoded " << decoded << ", correctable " << correctable << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   bool crc_index_validation_result = crc_validation_test() &&
+                                      burst_validation_test( 100 * data_length,  16, false, false, true  ) &&
+                                      burst_validation_test(   4 * data_length,  17, false, false, false ) &&
+                                      burst_validation_test( 100 * data_length,  17, true,  false, true  ) &&
+                                      burst_validation_test( 100 * data_length,  32, true,  false, true  ) &&
+                                      burst_validation_test(   4 * data_length,  33, true,  false, false ) &&
+                                      burst_validation_test(  50 * data_length + 100, 30, true, false, true ) &&
+                                      burst_validation_test(  50 * data_length + 100,  0, true, true,  true ) &&
+                                      burst_validation_test(  50 * data_length + 100, 10, true, true,  true ) ;
+
+   if( crc_index_validation_result )
+   {
+      std::cout << "ECC Crc Index Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Crc Index Validation Failure!" << std::endl;
+      return 1;
+   }
+}
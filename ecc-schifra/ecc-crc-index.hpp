@@ -0,0 +1,109 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_ECC_CRC_INDEX_HPP
+#define INCLUDE_ECC_CRC_INDEX_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "schifra_crc.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Crc index of an ecc file: a CRC32C of every codeword (its data bytes, without the padding
+         of the last one, then its parity), stored right after the parity of the codeword.
+
+         Layout: records of fec_length parity bytes + 4 crc bytes (little endian), one per codeword.
+         An ecc file without index holds the parity only: the sizes of both layouts never match
+         for the same data file, the layout is found from the sizes.
+
+         A matching crc tells a clean codeword without its syndrome, a mismatching one checks
+         the result of a decode (and the erasures tried when the errors only decode fails).
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class crc_index
+      {
+      public:
+
+         static const std::size_t crc_size = 4;
+         static const std::size_t record_length = fec_length + crc_size;
+
+         // CRC32C (Castagnoli), reflected
+         static const std::uint32_t polynomial = 0x82F63B78;
+
+         crc_index()
+         : mCrc( polynomial, 0xFFFFFFFF )
+         {
+         }
+
+         std::uint32_t codeword_crc( const unsigned char* iData, std::size_t iDataSize, const unsigned char* iParity )
+         {
+            mCrc.reset();
+            mCrc.update( iData, iDataSize );
+            mCrc.update( iParity, fec_length );
+            return static_cast<std::uint32_t>( ~mCrc.crc() );
+         }
+
+         // Records -> parity (fec_length bytes per codeword) + crcs
+         static void split( const char* iRecords, std::size_t iBlockCount, char* oParity, std::uint32_t* oCrcs )
+         {
+            for( std::size_t i = 0; i < iBlockCount; ++i, iRecords += record_length, oParity += fec_length )
+            {
+               std::memcpy( oParity, iRecords, fec_length );
+
+               const unsigned char* crc = reinterpret_cast<const unsigned char*>( iRecords + fec_length );
+               oCrcs[i] = std::uint32_t( crc[0] ) | ( std::uint32_t( crc[1] ) << 8 ) | ( std::uint32_t( crc[2] ) << 16 ) | ( std::uint32_t( crc[3] ) << 24 );
+            }
+         }
+
+         // Parity + crcs -> records
+         static void merge( const char* iParity, const std::uint32_t* iCrcs, std::size_t iBlockCount, char* oRecords )
+         {
+            for( std::size_t i = 0; i < iBlockCount; ++i, iParity += fec_length, oRecords += record_length )
+            {
+               std::memcpy( oRecords, iParity, fec_length );
+               for( std::size_t j = 0; j < crc_size; ++j )
+                  oRecords[fec_length + j] = static_cast<char>( ( iCrcs[i] >> ( 8 * j ) ) & 0xFF );
+            }
+         }
+
+      private:
+
+         crc32 mCrc;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
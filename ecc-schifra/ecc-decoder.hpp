@@ -24,12 +24,16 @@
 #define INCLUDE_ECC_DECODER_HPP
 
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <fstream>
+#include <vector>
 
+#include "schifra_reed_solomon_batch_syndrome.hpp"
 #include "schifra_reed_solomon_block.hpp"
-#include "schifra_reed_solomon_decoder.hpp"
-#include "schifra_fileio.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "ecc-crc-index.hpp"
+#include "ecc-pipeline.hpp"
 
 
 namespace schifra
@@ -38,117 +42,419 @@ namespace schifra
    namespace reed_solomon
    {
 
+      /*
+         Erased symbols of codeword iBlock (its unreadable bytes, see sector_reader), in oPositions.
+         Return their count: 0 without any, or with more than fec_length (too many to help the decode).
+         With S erasures, a codeword is corrected up to E errors besides them while 2E + S <= fec_length.
+      */
+      template <std::size_t fec_length>
+      inline std::size_t find_erasures( const std::vector<codeword_erasure>* iErasures, const std::uint64_t iBlock, std::size_t oPositions[] )
+      {
+         if( !iErasures || iErasures->empty() )
+            return 0;
+
+         auto erasure = std::lower_bound( iErasures->begin(), iErasures->end(), iBlock, []( const codeword_erasure& iErasure, std::uint64_t iIndex ) { return iErasure.mBlock < iIndex; } );
+
+         std::size_t count = 0;
+         for( ; erasure != iErasures->end() && erasure->mBlock == iBlock; ++erasure )
+         {
+            if( count == fec_length )
+               return 0;
+
+            oPositions[count++] = erasure->mPosition;
+         }
+
+         return count;
+      }
+
+      /*
+         Decode of a codeword of a file with a crc index, in place (the last codeword is zero padded).
+
+         The errors only decode corrects up to fec_length / 2 symbols. When it fails, or when its result
+         doesn't match the crc (a miscorrection), windows of fec_length consecutive symbols are erased one
+         after the other: a burst up to fec_length symbols is corrected, and the crc tells the right window
+         (an erasure decode of fec_length symbols always succeeds, it can't be trusted without the crc).
+         If no window matches but the errors only decode succeeded, the crc itself is the damaged one.
+         The known erasures of the codeword (unreadable bytes) are tried first.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      inline bool decode_with_crc( const fixed_decoder<code_length,fec_length>& iDecoder,
+                                   byte_block<code_length,fec_length>& ioBlock,
+                                   const std::size_t iDataSize,
+                                   const std::uint32_t iCrc,
+                                   crc_index<code_length,fec_length>& ioCrcIndex,
+                                   typename fixed_decoder<code_length,fec_length>::workspace& ioWorkspace,
+                                   const std::size_t iErasures[] = 0,
+                                   const std::size_t iErasureCount = 0 )
+      {
+         typedef byte_block<code_length,fec_length> block_type;
+
+         // The padding of the last codeword is known: a result which changes it is wrong
+         auto matches = [&]( const block_type& iBlock )
+         {
+            for( std::size_t i = iDataSize; i < data_length; ++i )
+            {
+               if( iBlock.data[i] )
+                  return false;
+            }
+
+            return ioCrcIndex.codeword_crc( iBlock.data, iDataSize, iBlock.data + data_length ) == iCrc;
+         };
+
+         const block_type received = ioBlock;
+         if( iErasureCount )
+         {
+            if( iDecoder.decode( ioBlock, iErasures, iErasureCount, ioWorkspace ) && matches( ioBlock ) )
+               return true;
+
+            ioBlock = received;
+         }
+
+         const bool decoded = iDecoder.decode( ioBlock, ioWorkspace );
+         if( decoded && matches( ioBlock ) )
+            return true;
+
+         const block_type errors_only = ioBlock;
+
+         std::size_t erasures[fec_length];
+         for( std::size_t start = 0; start + fec_length <= code_length; ++start )
+         {
+            // A window inside the padding erases nothing unknown
+            if( start >= iDataSize && start + fec_length <= data_length )
+               continue;
+
+            for( std::size_t i = 0; i < fec_length; ++i )
+               erasures[i] = start + i;
+
+            ioBlock = received;
+            if( iDecoder.decode( ioBlock, erasures, fec_length, ioWorkspace ) && matches( ioBlock ) )
+               return true;
+         }
+
+         ioBlock = decoded ? errors_only : received;
+         return decoded;
+      }
+
+      /*
+         Codewords covering a byte range of a data file: to decode the range, only their data (from
+         first_block * data_length) and their parity records are read, then the bytes before and after
+         the range are dropped. The range is clamped to the data file (an offset past its end is empty).
+         With the interleaved layout, the codewords are whole groups of iGroupBlockCount codewords.
+      */
+      template <std::size_t data_length>
+      struct codeword_range
+      {
+         codeword_range( const std::uint64_t iOffset, const std::uint64_t iLength, const std::uint64_t iDataSize, const std::uint64_t iGroupBlockCount = 1 )
+         {
+            offset = std::min( iOffset, iDataSize );
+            length = std::min( iLength, iDataSize - offset );
+            first_block = offset / data_length / iGroupBlockCount * iGroupBlockCount;
+
+            const std::uint64_t file_block_count = ( iDataSize + data_length - 1 ) / data_length;
+            std::uint64_t end_block = length ? ( offset + length + data_length - 1 ) / data_length : first_block;
+            end_block = std::min( ( end_block + iGroupBlockCount - 1 ) / iGroupBlockCount * iGroupBlockCount, file_block_count );
+            block_count = end_block - first_block;
+            data_offset = first_block * data_length;
+            data_size = std::min( end_block * data_length, iDataSize ) - data_offset;
+         }
+
+         // Bytes of the range inside a segment of decoded data starting at iSegmentOffset: [oBegin, oEnd)
+         void segment_part( const std::uint64_t iSegmentOffset, const std::size_t iSegmentSize, std::size_t& oBegin, std::size_t& oEnd ) const
+         {
+            const std::uint64_t segment_end = iSegmentOffset + iSegmentSize;
+            const std::uint64_t begin = std::min( std::max( offset, iSegmentOffset ), segment_end );
+            const std::uint64_t end = std::max( std::min( offset + length, segment_end ), begin );
+
+            oBegin = std::size_t( begin - iSegmentOffset );
+            oEnd = std::size_t( end - iSegmentOffset );
+         }
+
+         std::uint64_t offset;      // The range, clamped to the data file
+         std::uint64_t length;
+         std::uint64_t first_block; // The codewords covering it
+         std::uint64_t block_count;
+         std::uint64_t data_offset; // Their data (the last one may be partial)
+         std::uint64_t data_size;
+      };
+
       template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
       class segment_decoder
       {
       public:
 
-         typedef decoder<code_length,fec_length> decoder_type;
-         typedef typename decoder_type::block_type block_type;
+         typedef fixed_decoder<code_length,fec_length> decoder_type;
+         typedef batch_syndrome<code_length,fec_length> syndrome_type;
+         typedef typename decoder_type::byte_block_type block_type;
+         typedef typename decoder_type::workspace workspace_type;
+
+         // Number of codewords checked by one call of the syndrome filter
+         static const std::size_t batch_block_count = 256;
 
          segment_decoder( const decoder_type& iDecoder,
-                          const std::vector<char>& iInputDataSegment,
-                          const std::vector<char>& iInputEccSegment,
-                          std::vector<char>& oOutputDataSegment )
+                          const syndrome_type& iSyndrome,
+                          const char* iInputDataSegment,
+                          std::size_t iInputDataSize,
+                          const char* iInputEccSegment,
+                          char* oOutputDataSegment,
+                          std::uint64_t iFirstBlockIndex = 0,
+                          const std::uint32_t* iCrcs = 0,
+                          const std::vector<codeword_erasure>* iErasures = 0 )
+         : mFirstBlockIndex( iFirstBlockIndex ),
+           mFailedBlocks( 0 ),
+           mCrcs( iCrcs ),
+           mErasures( iErasures )
          {
-            std::size_t remaining_bytes = iInputDataSegment.size();
-            if( remaining_bytes == 0 )
+            const std::size_t input_size = iInputDataSize;
+            if( input_size == 0 )
             {
-               std::cout << "reed_solomon::segment_decoder() - Error: empty segment." << std::endl;
+               std::cerr << "reed_solomon::segment_decoder() - Error: empty segment." << std::endl;
                return;
             }
 
-            mCurrentBlockIndex = 0;
+            // Clean codewords are output as is, only the flagged ones are decoded and overwritten
+            std::copy( iInputDataSegment, iInputDataSegment + input_size, oOutputDataSegment );
 
-            while( remaining_bytes >= data_length )
+            const char* data = iInputDataSegment;
+            const char* fec = iInputEccSegment;
+            char* output = oOutputDataSegment;
+
+            const std::size_t full_block_count = input_size / data_length;
+            const std::size_t remaining_bytes = input_size % data_length;
+
+            unsigned char flags[batch_block_count];
+
+            for( std::size_t first_block = 0; first_block < full_block_count; first_block += batch_block_count )
             {
-               process_complete_block( iDecoder, iInputDataSegment, iInputEccSegment, oOutputDataSegment );
-               remaining_bytes -= data_length;
-               mCurrentBlockIndex++;
+               const std::size_t block_count = std::min( batch_block_count, full_block_count - first_block );
+
+               if( !iSyndrome.check_batch( reinterpret_cast<const unsigned char*>( data + first_block * data_length ),
+                                           reinterpret_cast<const unsigned char*>( fec + first_block * fec_length ),
+                                           block_count,
+                                           flags ) )
+                  continue;
+
+               for( std::size_t i = 0; i < block_count; ++i )
+               {
+                  if( flags[i] )
+                     process_block( iDecoder, data, fec, output, first_block + i, data_length );
+               }
             }
 
             if( remaining_bytes > 0 )
             {
-               process_partial_block( iDecoder, iInputDataSegment, iInputEccSegment, oOutputDataSegment, remaining_bytes );
+               process_block( iDecoder, data, fec, output, full_block_count, remaining_bytes );
             }
          }
 
+         // Number of codewords which could not be corrected (their data is copied as is)
+         std::size_t failed_blocks() const
+         {
+            return mFailedBlocks;
+         }
+
       private:
 
-         inline void process_complete_block( const decoder_type& iDecoder,
-                                             const std::vector<char>& iInputDataSegment,
-                                             const std::vector<char>& iInputEccSegment,
-                                             std::vector<char>& oOutputDataSegment )
+         // Full decoding of one codeword, in place in the output (the partial last one is zero padded)
+         inline void process_block( const decoder_type& iDecoder,
+                                    const char* iData,
+                                    const char* iFec,
+                                    char* ioOutput,
+                                    const std::size_t& iBlockIndex,
+                                    const std::size_t& iDataSize )
          {
-            int start_data = mCurrentBlockIndex * data_length;
-            const char* data = &iInputDataSegment.data()[start_data];
-            int start_fec = mCurrentBlockIndex * fec_length;
-            const char* fec = &iInputEccSegment.data()[start_fec];
+            std::uint8_t* output = reinterpret_cast<std::uint8_t*>( &ioOutput[iBlockIndex * data_length] );
+            const char* fec = &iFec[iBlockIndex * fec_length];
+
+            std::size_t erasures[fec_length];
+            const std::size_t erasure_count = find_erasures<fec_length>( mErasures, mFirstBlockIndex + iBlockIndex, erasures );
 
-            for( std::size_t i = 0; i < data_length; ++i )
+            std::copy( fec, fec + fec_length, mBlock.data + data_length );
+
+            bool decoded = false;
+            if( mCrcs )
             {
-               mBlock.data[i] = static_cast<typename block_type::symbol_type>( data[i] );
+               std::copy( output, output + iDataSize, mBlock.data );
+               std::fill( mBlock.data + iDataSize, mBlock.data + data_length, 0 );
+
+               decoded = decode_with_crc( iDecoder, mBlock, iDataSize, mCrcs[iBlockIndex], mCrcIndex, mWorkspace, erasures, erasure_count );
+               if( decoded )
+                  std::copy( mBlock.data, mBlock.data + iDataSize, output );
             }
-            for( std::size_t i = 0; i < fec_length; ++i )
+            else if( iDataSize == data_length && !erasure_count )
             {
-               mBlock.fec( i ) = static_cast<typename block_type::symbol_type>( fec[i] );
+               decoded = iDecoder.decode( output, mBlock.data + data_length, mWorkspace );
             }
-
-            if( !iDecoder.decode( mBlock ) )
+            else
             {
-               std::cout << "reed_solomon::segment_decoder.process_complete_block() - Error during decoding of block " << mCurrentBlockIndex << "!" << std::endl;
-               return;
+               std::copy( output, output + iDataSize, mBlock.data );
+               std::fill( mBlock.data + iDataSize, mBlock.data + data_length, 0 );
+
+               // A failed erasure decode may leave a partial correction: the errors only decode starts again from the received codeword
+               if( erasure_count )
+               {
+                  decoded = iDecoder.decode( mBlock, erasures, erasure_count, mWorkspace );
+                  if( !decoded )
+                  {
+                     std::copy( output, output + iDataSize, mBlock.data );
+                     std::fill( mBlock.data + iDataSize, mBlock.data + data_length, 0 );
+                     std::copy( fec, fec + fec_length, mBlock.data + data_length );
+                  }
+               }
+
+               if( !decoded )
+                  decoded = iDecoder.decode( mBlock, mWorkspace );
+               if( decoded )
+                  std::copy( mBlock.data, mBlock.data + iDataSize, output );
             }
 
-            for( std::size_t i = 0; i < data_length; ++i )
+            if( !decoded )
             {
-               oOutputDataSegment.push_back( static_cast<char>( mBlock[i] ) );
+               std::cerr << "reed_solomon::segment_decoder.process_block() - Error during decoding of block " << mFirstBlockIndex + iBlockIndex << "!" << std::endl;
+               mFailedBlocks++;
+
+               // A failed correction may have been partially applied: output the received data
+               const char* data = &iData[iBlockIndex * data_length];
+               std::copy( data, data + iDataSize, output );
             }
          }
 
-         inline void process_partial_block( const decoder_type& iDecoder,
-                                            const std::vector<char>& iInputDataSegment,
-                                            const std::vector<char>& iInputEccSegment,
-                                            std::vector<char>& oOutputDataSegment,
-                                            const std::size_t& iDataRemainingSize )
+         block_type mBlock;         // Parity of the codeword being decoded (and the whole padded last codeword)
+         workspace_type mWorkspace; // Scratch polynomials of the decoder, reused for every flagged block of the segment
+         std::uint64_t mFirstBlockIndex;
+         std::size_t mFailedBlocks;
+         const std::uint32_t* mCrcs; // Crc index of the segment (null: the ecc file has none)
+         crc_index<code_length,fec_length> mCrcIndex;
+         const std::vector<codeword_erasure>* mErasures; // Unreadable symbols, sorted (null: none)
+      };
+
+      /*
+         Check of a segment without output: the syndromes of all the codewords are computed,
+         the flagged ones are decoded in a scratch block to tell if they can be corrected.
+
+         With a crc index, a codeword whose crc matches is clean without its syndrome, only the
+         other ones are decoded (a crc mismatch on a clean codeword is a damaged crc, not reported).
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class segment_verifier
+      {
+      public:
+
+         typedef fixed_decoder<code_length,fec_length> decoder_type;
+         typedef batch_syndrome<code_length,fec_length> syndrome_type;
+         typedef typename decoder_type::byte_block_type block_type;
+         typedef typename decoder_type::workspace workspace_type;
+
+         static const std::size_t batch_block_count = 256;
+
+         // oCorruptedBlocks receives the corrupted codewords, in increasing index order
+         segment_verifier( const decoder_type& iDecoder,
+                           const syndrome_type& iSyndrome,
+                           const char* iInputDataSegment,
+                           std::size_t iInputDataSize,
+                           const char* iInputEccSegment,
+                           std::vector<corrupted_block>& oCorruptedBlocks,
+                           std::uint64_t iFirstBlockIndex = 0,
+                           const std::uint32_t* iCrcs = 0,
+                           const std::vector<codeword_erasure>* iErasures = 0 )
+         : mFirstBlockIndex( iFirstBlockIndex ),
+           mCrcs( iCrcs ),
+           mErasures( iErasures )
          {
-            int start_data = mCurrentBlockIndex * data_length;
-            const char* data = &iInputDataSegment.data()[start_data];
-            int start_fec = mCurrentBlockIndex * fec_length;
-            const char* fec = &iInputEccSegment.data()[start_fec];
+            const char* data = iInputDataSegment;
+            const char* fec = iInputEccSegment;
+
+            const std::size_t full_block_count = iInputDataSize / data_length;
+            const std::size_t remaining_bytes = iInputDataSize % data_length;
 
-            for( std::size_t i = 0; i < iDataRemainingSize; ++i )
+            if( mCrcs )
             {
-               mBlock.data[i] = static_cast<typename block_type::symbol_type>( data[i] );
+               const std::size_t block_count = full_block_count + ( remaining_bytes ? 1 : 0 );
+               for( std::size_t i = 0; i < block_count; ++i )
+               {
+                  const std::size_t data_size = i < full_block_count ? data_length : remaining_bytes;
+                  const unsigned char* block_data = reinterpret_cast<const unsigned char*>( data + i * data_length );
+                  const unsigned char* block_fec = reinterpret_cast<const unsigned char*>( fec + i * fec_length );
+                  if( mCrcIndex.codeword_crc( block_data, data_size, block_fec ) == mCrcs[i] )
+                     continue;
+
+                  const bool correctable = check_block( iDecoder, data, fec, i, data_size );
+                  if( !correctable || mBlock.errors_detected )
+                     oCorruptedBlocks.push_back( { iFirstBlockIndex + i, correctable } );
+               }
+
+               return;
             }
 
-            if( iDataRemainingSize < data_length )
+            unsigned char flags[batch_block_count];
+
+            for( std::size_t first_block = 0; first_block < full_block_count; first_block += batch_block_count )
             {
-               for( std::size_t i = iDataRemainingSize; i < data_length; ++i )
+               const std::size_t block_count = std::min( batch_block_count, full_block_count - first_block );
+
+               if( !iSyndrome.check_batch( reinterpret_cast<const unsigned char*>( data + first_block * data_length ),
+                                           reinterpret_cast<const unsigned char*>( fec + first_block * fec_length ),
+                                           block_count,
+                                           flags ) )
+                  continue;
+
+               for( std::size_t i = 0; i < block_count; ++i )
                {
-                  mBlock.data[i] = 0;
+                  if( flags[i] )
+                     oCorruptedBlocks.push_back( { iFirstBlockIndex + first_block + i, check_block( iDecoder, data, fec, first_block + i, data_length ) } );
                }
             }
 
-            for( std::size_t i = 0; i < fec_length; ++i )
+            if( remaining_bytes > 0 )
             {
-               mBlock.fec( i ) = static_cast<typename block_type::symbol_type>( fec[i] );
+               bool correctable = check_block( iDecoder, data, fec, full_block_count, remaining_bytes );
+               if( !correctable || mBlock.errors_detected )
+                  oCorruptedBlocks.push_back( { iFirstBlockIndex + full_block_count, correctable } );
             }
+         }
+
+      private:
 
-            if( !iDecoder.decode( mBlock ) )
+         // Return true if the codeword can be decoded (the partial last one is zero padded)
+         inline bool check_block( const decoder_type& iDecoder,
+                                  const char* iData,
+                                  const char* iFec,
+                                  const std::size_t& iBlockIndex,
+                                  const std::size_t& iDataSize )
+         {
+            const char* data = &iData[iBlockIndex * data_length];
+            const char* fec = &iFec[iBlockIndex * fec_length];
+
+            auto load = [&]()
             {
-               std::cout << "reed_solomon::segment_decoder.process_partial_block() - Error during decoding of block " << mCurrentBlockIndex << "!" << std::endl;
-               return;
-            }
+               std::copy( data, data + iDataSize, mBlock.data );
+               std::fill( mBlock.data + iDataSize, mBlock.data + data_length, 0 );
+               std::copy( fec, fec + fec_length, mBlock.data + data_length );
+            };
+
+            std::size_t erasures[fec_length];
+            const std::size_t erasure_count = find_erasures<fec_length>( mErasures, mFirstBlockIndex + iBlockIndex, erasures );
+
+            load();
+            if( mCrcs )
+               return decode_with_crc( iDecoder, mBlock, iDataSize, mCrcs[iBlockIndex], mCrcIndex, mWorkspace, erasures, erasure_count );
 
-            for( std::size_t i = 0; i < iDataRemainingSize; ++i )
+            if( erasure_count )
             {
-               oOutputDataSegment.push_back( static_cast<char>( mBlock.data[i] ) );
+               if( iDecoder.decode( mBlock, erasures, erasure_count, mWorkspace ) )
+                  return true;
+
+               load();
             }
+
+            return iDecoder.decode( mBlock, mWorkspace );
          }
 
          block_type mBlock;
-         std::size_t mCurrentBlockIndex;
+         workspace_type mWorkspace;
+         std::uint64_t mFirstBlockIndex;
+         const std::uint32_t* mCrcs;
+         crc_index<code_length,fec_length> mCrcIndex;
+         const std::vector<codeword_erasure>* mErasures;
       };
 
    } // namespace reed_solomon
@@ -24,12 +24,12 @@
 #define INCLUDE_ECC_ENCODER_HPP
 
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <fstream>
 
-#include "schifra_reed_solomon_block.hpp"
-#include "schifra_reed_solomon_encoder.hpp"
-#include "schifra_fileio.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "ecc-crc-index.hpp"
 
 
 namespace schifra
@@ -43,70 +43,55 @@ namespace schifra
       {
       public:
 
-         typedef encoder<code_length,fec_length> encoder_type;
-         typedef typename encoder_type::block_type block_type;
+         typedef batch_encoder<code_length,fec_length> encoder_type;
 
+         // oOutputSegment must hold the parity of all the codewords (the last one may be partial), oCrcs (optional) their crc
          segment_encoder( const encoder_type& iEncoder,
-                          const std::vector<char>& iInputSegment,
-                          std::vector<char>& oOutputSegment )
+                          const char* iInputSegment,
+                          std::size_t iInputSize,
+                          char* oOutputSegment,
+                          std::uint32_t* oCrcs = 0 )
          {
-            std::size_t remaining_bytes = iInputSegment.size();
-            if( remaining_bytes == 0 )
+            const std::size_t input_size = iInputSize;
+            if( input_size == 0 )
             {
-               std::cout << "reed_solomon::segment_encoder() - Error: empty segment." << std::endl;
+               std::cerr << "reed_solomon::segment_encoder() - Error: empty segment." << std::endl;
                return;
             }
 
-            std::size_t chunk_start = 0;
+            // Full blocks are encoded in place, in batches, straight from the input buffer
+            const std::size_t full_block_count = input_size / data_length;
+            const std::size_t remaining_bytes = input_size % data_length;
 
-            while( remaining_bytes >= data_length )
+            const unsigned char* data = reinterpret_cast<const unsigned char*>( iInputSegment );
+            unsigned char* fec = reinterpret_cast<unsigned char*>( oOutputSegment );
+
+            if( !iEncoder.encode_batch( data, full_block_count, fec ) )
             {
-               process_block( iEncoder, iInputSegment, oOutputSegment, chunk_start, data_length );
-               remaining_bytes -= data_length;
-               chunk_start += data_length;
+               std::cerr << "reed_solomon::segment_encoder() - Error during encoding of blocks!" << std::endl;
+               return;
             }
 
+            // The last partial block is zero padded
             if( remaining_bytes > 0 )
             {
-               process_block( iEncoder, iInputSegment, oOutputSegment, chunk_start, remaining_bytes );
-            }
-         }
+               unsigned char last_block[data_length] = { 0 };
+               std::copy( data + full_block_count * data_length, data + input_size, last_block );
 
-      private:
-
-         inline void process_block( const encoder_type& iEncoder,
-                                    const std::vector<char>& iInputSegment,
-                                    std::vector<char>& oOutputSegment,
-                                    const std::size_t& iChunkStart,
-                                    const std::size_t& iChunkSize )
-         {
-            const char* data_buffer = &iInputSegment.data()[iChunkStart];
-            for( std::size_t i = 0; i < iChunkSize; ++i )
-            {
-               mBlock.data[i] = ( data_buffer[i] & 0xFF );
-            }
-
-            if ( iChunkSize < data_length )
-            {
-               for( std::size_t i = iChunkSize; i < data_length; ++i )
+               if( !iEncoder.encode_batch( last_block, 1, fec + full_block_count * fec_length ) )
                {
-                  mBlock.data[i] = 0x00;
+                  std::cerr << "reed_solomon::segment_encoder() - Error during encoding of last block!" << std::endl;
+                  return;
                }
             }
 
-            if( !iEncoder.encode( mBlock ) )
+            if( oCrcs )
             {
-               std::cout << "reed_solomon::segment_encoder.process_block() - Error during encoding of block!" << std::endl;
-               return;
-            }
-
-            for( std::size_t i = 0; i < fec_length; ++i )
-            {
-               oOutputSegment.push_back( static_cast<char>( mBlock.fec( i ) & 0xFF ) );
+               crc_index<code_length,fec_length> crc;
+               for( std::size_t i = 0; i * data_length < input_size; ++i )
+                  oCrcs[i] = crc.codeword_crc( data + i * data_length, std::min( data_length, input_size - i * data_length ), fec + i * fec_length );
             }
          }
-
-         block_type mBlock;
       };
    
    } // namespace reed_solomon
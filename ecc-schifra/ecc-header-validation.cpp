@@ -0,0 +1,183 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The header of the ecc files: round trip of all the fields,
+                recovery from damaged copies (one intact copy, or a vote of
+                4 damaged ones), and no header found in raw parity records
+                or in a header whose copies are all destroyed.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ecc-header.hpp"
+
+
+typedef schifra::reed_solomon::ecc_header tHeader;
+
+tHeader MakeHeader()
+{
+   tHeader header;
+   header.mLayout = tHeader::e_layout_crc_index;
+   header.mFieldDescriptor = 8;
+   header.mPrimitivePolynomial = 0x11D;
+   header.mGenPolyIndex = 120;
+   header.mCodeLength = 255;
+   header.mFecLength = 32;
+   header.mSourceSize = 2097152000;
+   header.mSourceMtime = -1234567890123;
+   header.mSourceMtimeNsec = 999999999;
+   header.set_hex_hash( std::string( 64, 'a' ) + std::string( 64, '9' ) );
+
+   return header;
+}
+
+bool IsSameHeader( const tHeader& iA, const tHeader& iB )
+{
+   return iA.mVersion == iB.mVersion && iA.mLayout == iB.mLayout && iA.mHeaderSize == iB.mHeaderSize &&
+          iA.mFieldDescriptor == iB.mFieldDescriptor && iA.mPrimitivePolynomial == iB.mPrimitivePolynomial &&
+          iA.mGenPolyIndex == iB.mGenPolyIndex && iA.mCodeLength == iB.mCodeLength && iA.mFecLength == iB.mFecLength &&
+          iA.mSourceSize == iB.mSourceSize && iA.mSourceMtime == iB.mSourceMtime && iA.mSourceMtimeNsec == iB.mSourceMtimeNsec &&
+          iA.hex_hash() == iB.hex_hash();
+}
+
+void Corrupt( std::vector<char>& ioBytes, std::size_t iOffset, std::size_t iSize )
+{
+   for( std::size_t i = iOffset; i < iOffset + iSize; ++i )
+      ioBytes[i] = static_cast<char>( ioBytes[i] ^ ( 1 + ::rand() % 255 ) );
+}
+
+bool header_validation_test()
+{
+   const tHeader header = MakeHeader();
+
+   std::vector<char> bytes( tHeader::header_size );
+   header.write( bytes.data() );
+
+   tHeader read;
+   std::size_t damaged_copies = 0;
+   if( !read.read( bytes.data(), bytes.size(), damaged_copies ) || damaged_copies || !IsSameHeader( header, read ) )
+   {
+      std::cout << "Error - Round trip of a header" << std::endl;
+      return false;
+   }
+
+   if( read.hex_hash() != std::string( 64, 'a' ) + std::string( 64, '9' ) || tHeader().hex_hash().length() )
+   {
+      std::cout << "Error - Hash of a header" << std::endl;
+      return false;
+   }
+
+   // A truncated header is not read
+   if( read.read( bytes.data(), bytes.size() - 1, damaged_copies ) )
+   {
+      std::cout << "Error - Read of a truncated header" << std::endl;
+      return false;
+   }
+
+   // 3 copies damaged: the intact one is used
+   for( std::size_t intact = 0; intact < tHeader::copy_count; ++intact )
+   {
+      std::vector<char> damaged( bytes );
+      for( std::size_t copy = 0; copy < tHeader::copy_count; ++copy )
+      {
+         if( copy != intact )
+            Corrupt( damaged, copy * tHeader::copy_stride + std::size_t( ::rand() ) % tHeader::record_size, 1 );
+      }
+
+      tHeader recovered;
+      if( !recovered.read( damaged.data(), damaged.size(), damaged_copies ) || damaged_copies != tHeader::copy_count - 1 || !IsSameHeader( header, recovered ) )
+      {
+         std::cout << "Error - Header with only copy " << intact << " intact" << std::endl;
+         return false;
+      }
+   }
+
+   // All the copies damaged, at different bytes: the vote restores the record
+   for( std::size_t round = 0; round < 100; ++round )
+   {
+      std::vector<char> damaged( bytes );
+      for( std::size_t copy = 0; copy < tHeader::copy_count; ++copy )
+         Corrupt( damaged, copy * tHeader::copy_stride + copy * 64 + std::size_t( ::rand() ) % 56, 8 );
+
+      tHeader recovered;
+      if( !recovered.read( damaged.data(), damaged.size(), damaged_copies ) || damaged_copies != tHeader::copy_count || !IsSameHeader( header, recovered ) )
+      {
+         std::cout << "Error - Vote of 4 damaged copies" << std::endl;
+         return false;
+      }
+   }
+
+   // The same byte damaged in 3 copies can't be voted
+   {
+      std::vector<char> damaged( bytes );
+      for( std::size_t copy = 0; copy < tHeader::copy_count; ++copy )
+         damaged[copy * tHeader::copy_stride + 40] = static_cast<char>( copy == 0 ? damaged[40] ^ 0x01 : damaged[40] ^ 0x80 );
+      damaged[tHeader::copy_stride + 41] ^= 0x01;
+      damaged[3 * tHeader::copy_stride + 41] ^= 0x02;
+
+      tHeader recovered;
+      if( recovered.read( damaged.data(), damaged.size(), damaged_copies ) )
+      {
+         std::cout << "Error - Read of a header with all its copies destroyed" << std::endl;
+         return false;
+      }
+   }
+
+   // The parity records of a headerless ecc file
+   for( std::size_t round = 0; round < 100; ++round )
+   {
+      std::vector<char> parity( tHeader::header_size );
+      Corrupt( parity, 0, parity.size() );
+
+      tHeader recovered;
+      if( recovered.read( parity.data(), parity.size(), damaged_copies ) )
+      {
+         std::cout << "Error - Header found in parity records" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand( 0x4EAD );
+
+   if( header_validation_test() )
+   {
+      std::cout << "ECC Header Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Header Validation Failure!" << std::endl;
+      return 1;
+   }
+}
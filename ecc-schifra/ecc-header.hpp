@@ -0,0 +1,252 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_ECC_HEADER_HPP
+#define INCLUDE_ECC_HEADER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "schifra_crc.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Header of an ecc file: what the parity is (code, layout of the records)
+         and what it protects (size, mtime and optionally sha512 of the data file).
+
+         Layout: header_size bytes, then the parity records (on a sector boundary).
+         The record_size bytes record is stored copy_count times, copy_stride bytes
+         apart, each copy with its own crc32 (the one of zlib). The first intact copy
+         is used, else a byte by byte vote of the copies (a byte kept by 2 of them).
+
+         Record (little endian): magic, version, layout, header size, field descriptor,
+         primitive polynomial (bit i: coefficient of x^i), generator polynomial index,
+         code length, fec length, data mtime (ns), data size, data mtime (s),
+         hash type, hash, reserved (zero), crc32 of all the bytes before it.
+
+         The ecc files written before the header are only parity records: they don't
+         start with a valid record, and their layout is found from their size.
+      */
+      struct ecc_header
+      {
+         static const std::size_t header_size = 4096;
+         static const std::size_t record_size = 256;
+         static const std::size_t copy_count = 4;
+         static const std::size_t copy_stride = header_size / copy_count;
+         static const std::size_t hash_size = 64;
+
+         static const std::uint16_t current_version = 1;
+
+         // Layout of the parity records, after the header
+         enum parity_layout : std::uint16_t
+         {
+            e_layout_parity      = 0,  // fec_length parity bytes per codeword
+            e_layout_crc_index   = 1,  // fec_length parity bytes + crc32c of the codeword (see crc_index)
+            e_layout_interleaved = 2   // fec_length parity bytes per codeword, codewords spread over the sectors (see sector_interleaver)
+         };
+
+         enum hash_type : std::uint8_t
+         {
+            e_hash_none   = 0,
+            e_hash_sha512 = 1
+         };
+
+         std::uint16_t mVersion = current_version;
+         std::uint16_t mLayout = e_layout_parity;
+         std::uint32_t mHeaderSize = header_size;     // Offset of the parity records
+         std::uint32_t mFieldDescriptor = 0;
+         std::uint32_t mPrimitivePolynomial = 0;
+         std::uint32_t mGenPolyIndex = 0;
+         std::uint32_t mCodeLength = 0;
+         std::uint32_t mFecLength = 0;
+         std::uint64_t mSourceSize = 0;
+         std::int64_t  mSourceMtime = 0;              // Seconds
+         std::uint32_t mSourceMtimeNsec = 0;
+         std::uint8_t  mHashType = e_hash_none;
+         unsigned char mHash[hash_size] = {};
+
+         // The whole header: all the copies of the record, zero padded
+         void write( char oHeader[header_size] ) const
+         {
+            unsigned char record[record_size] = {};
+
+            std::memcpy( record, magic, sizeof( magic ) );
+            Store( record +  8, mVersion, 2 );
+            Store( record + 10, mLayout, 2 );
+            Store( record + 12, mHeaderSize, 4 );
+            Store( record + 16, mFieldDescriptor, 4 );
+            Store( record + 20, mPrimitivePolynomial, 4 );
+            Store( record + 24, mGenPolyIndex, 4 );
+            Store( record + 28, mCodeLength, 4 );
+            Store( record + 32, mFecLength, 4 );
+            Store( record + 36, mSourceMtimeNsec, 4 );
+            Store( record + 40, mSourceSize, 8 );
+            Store( record + 48, static_cast<std::uint64_t>( mSourceMtime ), 8 );
+            record[56] = mHashType;
+            std::memcpy( record + 64, mHash, hash_size );
+            Store( record + crc_offset, Checksum( record ), 4 );
+
+            std::memset( oHeader, 0, header_size );
+            for( std::size_t i = 0; i < copy_count; ++i )
+               std::memcpy( oHeader + i * copy_stride, record, record_size );
+         }
+
+         /*
+            False if there is no record in the first iSize bytes of the file (a headerless
+            ecc file, or all the copies destroyed). oDamagedCopies: the copies which failed
+            their crc (to rewrite them).
+         */
+         bool read( const char* iHeader, std::size_t iSize, std::size_t& oDamagedCopies )
+         {
+            oDamagedCopies = copy_count;
+            if( iSize < header_size )
+               return false;
+
+            const unsigned char* header = reinterpret_cast<const unsigned char*>( iHeader );
+            const unsigned char* intact = 0;
+            for( std::size_t i = 0; i < copy_count; ++i )
+            {
+               const unsigned char* copy = header + i * copy_stride;
+               if( IsValid( copy ) )
+               {
+                  oDamagedCopies--;
+                  intact = intact ? intact : copy;
+               }
+            }
+
+            unsigned char voted[record_size];
+            if( !intact )
+            {
+               for( std::size_t j = 0; j < record_size; ++j )
+               {
+                  voted[j] = header[j];
+                  for( std::size_t a = 0; a < copy_count; ++a )
+                  {
+                     for( std::size_t b = a + 1; b < copy_count; ++b )
+                     {
+                        if( header[a * copy_stride + j] == header[b * copy_stride + j] )
+                           voted[j] = header[a * copy_stride + j];
+                     }
+                  }
+               }
+
+               if( !IsValid( voted ) )
+                  return false;
+
+               intact = voted;
+            }
+
+            mVersion = static_cast<std::uint16_t>( Load( intact + 8, 2 ) );
+            mLayout = static_cast<std::uint16_t>( Load( intact + 10, 2 ) );
+            mHeaderSize = static_cast<std::uint32_t>( Load( intact + 12, 4 ) );
+            mFieldDescriptor = static_cast<std::uint32_t>( Load( intact + 16, 4 ) );
+            mPrimitivePolynomial = static_cast<std::uint32_t>( Load( intact + 20, 4 ) );
+            mGenPolyIndex = static_cast<std::uint32_t>( Load( intact + 24, 4 ) );
+            mCodeLength = static_cast<std::uint32_t>( Load( intact + 28, 4 ) );
+            mFecLength = static_cast<std::uint32_t>( Load( intact + 32, 4 ) );
+            mSourceMtimeNsec = static_cast<std::uint32_t>( Load( intact + 36, 4 ) );
+            mSourceSize = Load( intact + 40, 8 );
+            mSourceMtime = static_cast<std::int64_t>( Load( intact + 48, 8 ) );
+            mHashType = intact[56];
+            std::memcpy( mHash, intact + 64, hash_size );
+
+            return true;
+         }
+
+         // The hash as sha512sum prints it (empty without hash)
+         std::string hex_hash() const
+         {
+            if( mHashType != e_hash_sha512 )
+               return std::string();
+
+            static const char hex[] = "0123456789abcdef";
+            std::string result( 2 * hash_size, '0' );
+            for( std::size_t i = 0; i < hash_size; i++ )
+            {
+               result[2 * i] = hex[mHash[i] >> 4];
+               result[2 * i + 1] = hex[mHash[i] & 0x0F];
+            }
+
+            return result;
+         }
+
+         // false: not a hex digest of hash_size bytes
+         bool set_hex_hash( const std::string& iHash )
+         {
+            if( iHash.length() != 2 * hash_size || iHash.find_first_not_of( "0123456789abcdef" ) != std::string::npos )
+               return false;
+
+            for( std::size_t i = 0; i < hash_size; i++ )
+               mHash[i] = static_cast<unsigned char>( std::stoul( iHash.substr( 2 * i, 2 ), nullptr, 16 ) );
+            mHashType = e_hash_sha512;
+
+            return true;
+         }
+
+      private:
+
+         static constexpr char magic[8] = { 'S', 'C', 'H', 'I', 'F', 'R', 'A', 0x1A };
+         static const std::size_t crc_offset = record_size - 4;
+
+         static void Store( unsigned char* oBytes, std::uint64_t iValue, std::size_t iSize )
+         {
+            for( std::size_t i = 0; i < iSize; ++i )
+               oBytes[i] = static_cast<unsigned char>( iValue >> ( 8 * i ) );
+         }
+
+         static std::uint64_t Load( const unsigned char* iBytes, std::size_t iSize )
+         {
+            std::uint64_t value = 0;
+            for( std::size_t i = 0; i < iSize; ++i )
+               value |= std::uint64_t( iBytes[i] ) << ( 8 * i );
+
+            return value;
+         }
+
+         static std::uint32_t Checksum( const unsigned char* iRecord )
+         {
+            crc32 crc( 0xEDB88320, 0xFFFFFFFF );
+            crc.update( iRecord, crc_offset );
+
+            return static_cast<std::uint32_t>( ~crc.crc() );
+         }
+
+         static bool IsValid( const unsigned char* iRecord )
+         {
+            return !std::memcmp( iRecord, magic, sizeof( magic ) ) && Load( iRecord + crc_offset, 4 ) == Checksum( iRecord );
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,240 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+/*
+   Description: The sector interleaved layout of the ecc files: the tiled
+                transpose, and the round trip of segments with whole dead
+                sectors in the data and in the parity, which the contiguous
+                layout can't correct.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "schifra_reed_solomon_interleaving.hpp"
+#include "ecc-decoder.hpp"
+#include "ecc-encoder.hpp"
+#include "ecc-interleave.hpp"
+
+
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+typedef schifra::reed_solomon::batch_encoder<code_length,fec_length>                encoder_t;
+typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length>                decoder_t;
+typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length>               syndrome_t;
+typedef schifra::reed_solomon::segment_encoder<code_length,fec_length>              segment_encoder_t;
+typedef schifra::reed_solomon::segment_decoder<code_length,fec_length>              segment_decoder_t;
+typedef schifra::reed_solomon::interleaved_segment_encoder<code_length,fec_length>  interleaved_encoder_t;
+typedef schifra::reed_solomon::interleaved_segment_decoder<code_length,fec_length>  interleaved_decoder_t;
+typedef schifra::reed_solomon::interleaved_segment_verifier<code_length,fec_length> interleaved_verifier_t;
+
+const std::size_t sector_size = interleaved_encoder_t::sector_size;
+const std::size_t group_size = interleaved_encoder_t::group_block_count * data_length;
+
+bool transpose_validation_test()
+{
+   const std::size_t sizes[] = { 1, 2, 31, 32, 63, 64, 65, 223, 300 };
+   for( const std::size_t rows : sizes )
+   {
+      for( const std::size_t columns : sizes )
+      {
+         std::vector<unsigned char> in( rows * columns );
+         for( auto& byte : in )
+            byte = static_cast<unsigned char>( ::rand() );
+
+         std::vector<unsigned char> out( in.size() );
+         schifra::reed_solomon::transpose( in.data(), rows, columns, out.data() );
+
+         for( std::size_t row = 0; row < rows; ++row )
+         {
+            for( std::size_t column = 0; column < columns; ++column )
+            {
+               if( out[column * rows + row] != in[row * columns + column] )
+               {
+                  std::cout << "Error - Transpose of " << rows << " x " << columns << " bytes" << std::endl;
+                  return false;
+               }
+            }
+         }
+      }
+   }
+
+   return true;
+}
+
+// Overwrite whole sectors (random bytes) of a buffer
+void kill_sectors( std::vector<char>& ioBuffer, const std::vector<std::size_t>& iSectors )
+{
+   for( const std::size_t sector : iSectors )
+   {
+      for( std::size_t i = sector * sector_size; i < std::min( ( sector + 1 ) * sector_size, ioBuffer.size() ); ++i )
+         ioBuffer[i] = static_cast<char>( ::rand() );
+   }
+}
+
+/*
+   A segment of iDataSize bytes, with iGroupDeadSectors dead sectors in each of its full groups
+   and a dead sector of parity: the interleaved layout decodes it, the contiguous one doesn't
+*/
+bool round_trip_validation_test( const encoder_t& iEncoder, const decoder_t& iDecoder, const syndrome_t& iSyndrome, const std::size_t iDataSize, const std::size_t iGroupDeadSectors )
+{
+   const std::size_t block_count = ( iDataSize + data_length - 1 ) / data_length;
+
+   std::vector<char> data( iDataSize );
+   for( auto& byte : data )
+      byte = static_cast<char>( ::rand() );
+
+   std::vector<char> ecc( block_count * fec_length );
+   std::vector<char> contiguous_ecc( ecc.size() );
+   interleaved_encoder_t( iEncoder, data.data(), data.size(), ecc.data() );
+   segment_encoder_t( iEncoder, data.data(), data.size(), contiguous_ecc.data() );
+
+   // The interleaved parity of a codeword is the parity of its column of the group
+   if( iDataSize >= group_size )
+   {
+      std::vector<char> column( data_length );
+      for( std::size_t k = 0; k < data_length; ++k )
+         column[k] = data[k * interleaved_encoder_t::group_block_count + 5];
+
+      std::vector<char> parity( fec_length );
+      segment_encoder_t( iEncoder, column.data(), data_length, parity.data() );
+      for( std::size_t k = 0; k < fec_length; ++k )
+      {
+         if( parity[k] != ecc[k * interleaved_encoder_t::group_block_count + 5] )
+         {
+            std::cout << "Error - Interleaved parity of codeword 5 (" << iDataSize << " bytes)" << std::endl;
+            return false;
+         }
+      }
+   }
+
+   std::vector<char> damaged( data );
+   std::vector<std::size_t> sectors;
+   const std::size_t group_sectors = group_size / sector_size;
+   for( std::size_t group = 0; group < iDataSize / group_size; ++group )
+   {
+      for( std::size_t i = 0; i < iGroupDeadSectors; ++i )
+         sectors.push_back( group * group_sectors + ( i * 37 + 3 ) % group_sectors );
+   }
+   kill_sectors( damaged, sectors );
+
+   // A few bytes in the partial last group
+   if( iDataSize % group_size )
+      damaged[iDataSize - 1] ^= 0x5A;
+
+   // A parity sector of the first group
+   if( iDataSize >= group_size )
+      kill_sectors( ecc, { 7 } );
+
+   std::vector<char> output( iDataSize );
+   interleaved_decoder_t decoder( iDecoder, iSyndrome, damaged.data(), damaged.size(), ecc.data(), output.data() );
+   if( decoder.failed_blocks() || output != data )
+   {
+      std::cout << "Error - Interleaved decode of " << iDataSize << " bytes with " << sectors.size() << " dead sector(s): " << decoder.failed_blocks() << " failed block(s)" << std::endl;
+      return false;
+   }
+
+   std::vector<schifra::reed_solomon::corrupted_block> corrupted;
+   interleaved_verifier_t( iDecoder, iSyndrome, damaged.data(), damaged.size(), ecc.data(), corrupted );
+   for( const auto& block : corrupted )
+   {
+      if( !block.mCorrectable || block.mIndex >= block_count )
+      {
+         std::cout << "Error - Interleaved verify of " << iDataSize << " bytes: block " << block.mIndex << std::endl;
+         return false;
+      }
+   }
+   if( sectors.size() && corrupted.empty() )
+   {
+      std::cout << "Error - Interleaved verify of " << iDataSize << " bytes: no corrupted block" << std::endl;
+      return false;
+   }
+
+   // The same dead sectors are beyond the contiguous layout
+   if( sectors.size() )
+   {
+      std::vector<char> contiguous_output( iDataSize );
+      segment_decoder_t contiguous_decoder( iDecoder, iSyndrome, damaged.data(), damaged.size(), contiguous_ecc.data(), contiguous_output.data() );
+      if( !contiguous_decoder.failed_blocks() )
+      {
+         std::cout << "Error - Contiguous decode of " << sectors.size() << " dead sector(s) succeeded" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool interleave_validation_test()
+{
+   const schifra::galois::field field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
+
+   schifra::galois::field_polynomial generator( field );
+   if( !schifra::make_sequential_root_generator_polynomial( field, 120, fec_length, generator ) )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t encoder( field, generator );
+   const decoder_t decoder( field, 120 );
+   const syndrome_t syndrome( field, 120 );
+
+   const std::size_t sizes[] = { 1, 222, 223, 224, 100000, group_size - 1, group_size, group_size + 1, 2 * group_size + 12345 };
+   for( const std::size_t size : sizes )
+   {
+      // Each dead sector costs one symbol per codeword: fec_length / 2 with the one of parity
+      if( !round_trip_validation_test( encoder, decoder, syndrome, size, fec_length / 2 - 1 ) )
+         return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand( 0x1F0A2B );
+
+   if( transpose_validation_test() && interleave_validation_test() )
+   {
+      std::cout << "ECC Interleave Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Interleave Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,267 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_ECC_INTERLEAVE_HPP
+#define INCLUDE_ECC_INTERLEAVE_HPP
+
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "schifra_reed_solomon_interleaving.hpp"
+#include "ecc-decoder.hpp"
+#include "ecc-encoder.hpp"
+#include "ecc-pipeline.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Sector interleaved layout of the ecc files: the codewords are cut into groups of
+         group_block_count codewords, and inside a group, codeword j takes the data bytes
+         j, j + n, j + 2n, ... of the group (n: its codewords, group_block_count except for
+         the last group of a file). The data is a data_length x n matrix, a codeword is one
+         of its columns. The parity of the group is stored the same way: fec_length rows of
+         n bytes, parity symbol k of codeword j at k * n + j.
+
+         With one codeword per byte of a sector, a whole dead sector (of the data file or of
+         the ecc file) costs each codeword of its group one symbol at most, instead of wiping
+         out the ~18 consecutive codewords it holds in the contiguous layout.
+
+         The data file is untouched: the groups are transposed to contiguous codewords (and
+         back), a tiled transpose which runs in the cache, before the usual segment codecs.
+         A segment must start on a group boundary. The erasures (unreadable bytes) are already
+         in codeword positions, see unreadable_erasures.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class sector_interleaver
+      {
+      public:
+
+         static const std::size_t sector_size = 4096;
+         static const std::size_t group_block_count = sector_size;
+
+         // Codewords of the group of iDataSize bytes (the last group of a file is partial)
+         static std::size_t group_blocks( const std::size_t iDataSize )
+         {
+            return ( iDataSize + data_length - 1 ) / data_length;
+         }
+
+         // Data of a group to its contiguous codewords (the bytes after iDataSize are zero)
+         static void gather( const char* iData, const std::size_t iDataSize, unsigned char* oCodewords, std::vector<unsigned char>& ioPadded )
+         {
+            const std::size_t block_count = group_blocks( iDataSize );
+            const unsigned char* data = reinterpret_cast<const unsigned char*>( iData );
+            if( iDataSize != block_count * data_length )
+            {
+               ioPadded.assign( block_count * data_length, 0 );
+               std::copy( data, data + iDataSize, ioPadded.begin() );
+               data = ioPadded.data();
+            }
+
+            transpose( data, data_length, block_count, oCodewords );
+         }
+
+         // Contiguous codewords back to the data of a group (iDataSize bytes)
+         static void scatter( const unsigned char* iCodewords, const std::size_t iDataSize, char* oData, std::vector<unsigned char>& ioPadded )
+         {
+            const std::size_t block_count = group_blocks( iDataSize );
+            unsigned char* data = reinterpret_cast<unsigned char*>( oData );
+            if( iDataSize == block_count * data_length )
+            {
+               transpose( iCodewords, block_count, data_length, data );
+               return;
+            }
+
+            ioPadded.resize( block_count * data_length );
+            transpose( iCodewords, block_count, data_length, ioPadded.data() );
+            std::copy( ioPadded.begin(), ioPadded.begin() + iDataSize, data );
+         }
+
+         // Parity of the codewords of a group (block_count x fec_length) to its stored rows (fec_length x block_count), and back
+         static void scatter_parity( const unsigned char* iParity, const std::size_t iBlockCount, char* oEcc )
+         {
+            transpose( iParity, iBlockCount, fec_length, reinterpret_cast<unsigned char*>( oEcc ) );
+         }
+
+         static void gather_parity( const char* iEcc, const std::size_t iBlockCount, unsigned char* oParity )
+         {
+            transpose( reinterpret_cast<const unsigned char*>( iEcc ), fec_length, iBlockCount, oParity );
+         }
+
+      protected:
+
+         // Group buffers of a worker, reused by all its segments
+         struct workspace
+         {
+            std::vector<unsigned char> codewords;
+            std::vector<unsigned char> parity;
+            std::vector<unsigned char> output;
+            std::vector<unsigned char> padded;
+         };
+
+         static workspace& thread_workspace()
+         {
+            static thread_local workspace scratch;
+            scratch.codewords.resize( group_block_count * data_length );
+            scratch.parity.resize( group_block_count * fec_length );
+            scratch.output.resize( group_block_count * data_length );
+            return scratch;
+         }
+      };
+
+      // segment_encoder of the sector interleaved layout
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class interleaved_segment_encoder : public sector_interleaver<code_length,fec_length>
+      {
+      public:
+
+         typedef sector_interleaver<code_length,fec_length> interleaver_type;
+         typedef batch_encoder<code_length,fec_length> encoder_type;
+
+         interleaved_segment_encoder( const encoder_type& iEncoder,
+                                      const char* iInputSegment,
+                                      std::size_t iInputSize,
+                                      char* oOutputSegment )
+         {
+            typename interleaver_type::workspace& scratch = interleaver_type::thread_workspace();
+            const std::size_t group_size = interleaver_type::group_block_count * data_length;
+
+            for( std::size_t start = 0, group = 0; start < iInputSize; start += group_size, ++group )
+            {
+               const std::size_t size = std::min( group_size, iInputSize - start );
+               const std::size_t block_count = interleaver_type::group_blocks( size );
+
+               interleaver_type::gather( iInputSegment + start, size, scratch.codewords.data(), scratch.padded );
+               segment_encoder<code_length,fec_length>( iEncoder, reinterpret_cast<const char*>( scratch.codewords.data() ), block_count * data_length, reinterpret_cast<char*>( scratch.parity.data() ) );
+               interleaver_type::scatter_parity( scratch.parity.data(), block_count, oOutputSegment + group * interleaver_type::group_block_count * fec_length );
+            }
+         }
+      };
+
+      // segment_decoder of the sector interleaved layout
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class interleaved_segment_decoder : public sector_interleaver<code_length,fec_length>
+      {
+      public:
+
+         typedef sector_interleaver<code_length,fec_length> interleaver_type;
+         typedef fixed_decoder<code_length,fec_length> decoder_type;
+         typedef batch_syndrome<code_length,fec_length> syndrome_type;
+
+         interleaved_segment_decoder( const decoder_type& iDecoder,
+                                      const syndrome_type& iSyndrome,
+                                      const char* iInputDataSegment,
+                                      std::size_t iInputDataSize,
+                                      const char* iInputEccSegment,
+                                      char* oOutputDataSegment,
+                                      std::uint64_t iFirstBlockIndex = 0,
+                                      const std::vector<codeword_erasure>* iErasures = 0 )
+         : mFailedBlocks( 0 )
+         {
+            typename interleaver_type::workspace& scratch = interleaver_type::thread_workspace();
+            const std::size_t group_size = interleaver_type::group_block_count * data_length;
+
+            for( std::size_t start = 0, group = 0; start < iInputDataSize; start += group_size, ++group )
+            {
+               const std::size_t size = std::min( group_size, iInputDataSize - start );
+               const std::size_t block_count = interleaver_type::group_blocks( size );
+               const std::size_t first_block = group * interleaver_type::group_block_count;
+
+               interleaver_type::gather( iInputDataSegment + start, size, scratch.codewords.data(), scratch.padded );
+               interleaver_type::gather_parity( iInputEccSegment + first_block * fec_length, block_count, scratch.parity.data() );
+
+               segment_decoder<code_length,fec_length> decoder( iDecoder, iSyndrome,
+                                                                reinterpret_cast<const char*>( scratch.codewords.data() ), block_count * data_length,
+                                                                reinterpret_cast<const char*>( scratch.parity.data() ),
+                                                                reinterpret_cast<char*>( scratch.output.data() ),
+                                                                iFirstBlockIndex + first_block, 0, iErasures );
+               mFailedBlocks += decoder.failed_blocks();
+
+               interleaver_type::scatter( scratch.output.data(), size, oOutputDataSegment + start, scratch.padded );
+            }
+         }
+
+         std::size_t failed_blocks() const
+         {
+            return mFailedBlocks;
+         }
+
+      private:
+
+         std::size_t mFailedBlocks;
+      };
+
+      // segment_verifier of the sector interleaved layout
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class interleaved_segment_verifier : public sector_interleaver<code_length,fec_length>
+      {
+      public:
+
+         typedef sector_interleaver<code_length,fec_length> interleaver_type;
+         typedef fixed_decoder<code_length,fec_length> decoder_type;
+         typedef batch_syndrome<code_length,fec_length> syndrome_type;
+
+         interleaved_segment_verifier( const decoder_type& iDecoder,
+                                       const syndrome_type& iSyndrome,
+                                       const char* iInputDataSegment,
+                                       std::size_t iInputDataSize,
+                                       const char* iInputEccSegment,
+                                       std::vector<corrupted_block>& oCorruptedBlocks,
+                                       std::uint64_t iFirstBlockIndex = 0,
+                                       const std::vector<codeword_erasure>* iErasures = 0 )
+         {
+            typename interleaver_type::workspace& scratch = interleaver_type::thread_workspace();
+            const std::size_t group_size = interleaver_type::group_block_count * data_length;
+
+            for( std::size_t start = 0, group = 0; start < iInputDataSize; start += group_size, ++group )
+            {
+               const std::size_t size = std::min( group_size, iInputDataSize - start );
+               const std::size_t block_count = interleaver_type::group_blocks( size );
+               const std::size_t first_block = group * interleaver_type::group_block_count;
+
+               interleaver_type::gather( iInputDataSegment + start, size, scratch.codewords.data(), scratch.padded );
+               interleaver_type::gather_parity( iInputEccSegment + first_block * fec_length, block_count, scratch.parity.data() );
+
+               segment_verifier<code_length,fec_length>( iDecoder, iSyndrome,
+                                                         reinterpret_cast<const char*>( scratch.codewords.data() ), block_count * data_length,
+                                                         reinterpret_cast<const char*>( scratch.parity.data() ),
+                                                         oCorruptedBlocks,
+                                                         iFirstBlockIndex + first_block, 0, iErasures );
+            }
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
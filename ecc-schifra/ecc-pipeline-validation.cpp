@@ -0,0 +1,210 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The work stealing pool (every task runs once, an idle worker
+                steals the tasks queued behind a busy one) and the segment
+                pipeline (chunks hashed and written in stream order whatever the
+                order of their ranges, reader and writer failures reported).
+*/
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ecc-pipeline.hpp"
+#include "ecc-thread-pool.hpp"
+
+
+typedef schifra::reed_solomon::work_stealing_pool tPool;
+typedef schifra::reed_solomon::segment_pipeline tPipeline;
+typedef schifra::reed_solomon::segment_chunk tChunk;
+
+bool pool_validation_test()
+{
+   const std::size_t task_count = 10000;
+
+   std::vector<std::atomic<std::uint32_t>> runs( task_count );
+   std::uint64_t pool_task_count = 0;
+
+   {
+      tPool pool( 4 );
+
+      for( std::size_t i = 0; i < task_count; i++ )
+         pool.submit( [&runs, i]{ runs[i]++; } );
+
+      // The destructor runs the queued tasks before joining the workers
+      while( pool_task_count < task_count )
+      {
+         pool_task_count = 0;
+         for( std::size_t i = 0; i < pool.thread_count(); i++ )
+            pool_task_count += pool.task_count( i );
+         std::this_thread::yield();
+      }
+   }
+
+   for( std::size_t i = 0; i < task_count; i++ )
+   {
+      if( runs[i] != 1 )
+      {
+         std::cout << "Error - Pool task " << i << " ran " << runs[i] << " time(s)" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool pool_stealing_validation_test()
+{
+   const std::size_t task_count = 64;
+
+   std::atomic<bool> release( false );
+   std::atomic<std::size_t> done( 0 );
+
+   tPool pool( 2 );
+
+   // The first task blocks a worker, half of the next ones are queued behind it
+   pool.submit( [&release]{ while( !release ) std::this_thread::yield(); } );
+   for( std::size_t i = 0; i < task_count; i++ )
+      pool.submit( [&done]{ done++; } );
+
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+   while( done < task_count && std::chrono::steady_clock::now() < deadline )
+      std::this_thread::yield();
+
+   const bool stolen = ( done == task_count );
+   release = true;
+
+   if( !stolen )
+      std::cout << "Error - Pool tasks queued behind a busy worker were not stolen" << std::endl;
+
+   return stolen;
+}
+
+// The ranges of a chunk write their blocks with a delay depending on their position, so they complete out of order
+bool pipeline_validation_test( std::size_t iChunkCount, std::size_t iBlockCount, std::size_t iReadError, std::size_t iWriteError )
+{
+   const std::size_t chunk_block_count = 100;
+   const std::size_t range_block_count = 7;
+
+   tPool pool( 3 );
+   tPipeline pipeline( iChunkCount, pool, range_block_count );
+
+   std::size_t next_block = 0;
+   std::size_t read_count = 0;
+   std::uint64_t next_write = 0;
+   std::vector<std::uint64_t> written;
+   std::vector<std::uint64_t> hashed;
+   bool valid = true;
+
+   auto reader = [&]( tChunk& ioChunk )
+   {
+      if( read_count++ == iReadError )
+         return tPipeline::eReadStatus::kError;
+      if( next_block == iBlockCount )
+         return tPipeline::eReadStatus::kEnd;
+
+      ioChunk.mFirstBlock = next_block;
+      ioChunk.mBlockCount = std::min( chunk_block_count, iBlockCount - next_block );
+      ioChunk.mData.assign( ioChunk.mBlockCount, 0 );
+      next_block += ioChunk.mBlockCount;
+
+      return tPipeline::eReadStatus::kChunk;
+   };
+
+   auto processor = []( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+   {
+      std::this_thread::sleep_for( std::chrono::microseconds( ( 13 - iFirstBlock % 13 ) * 20 ) );
+      for( std::size_t i = iFirstBlock; i < iFirstBlock + iBlockCount; i++ )
+         ioChunk.mData[i] = char( ( ioChunk.mFirstBlock + i ) % 127 );
+   };
+
+   auto writer = [&]( const tChunk& iChunk )
+   {
+      if( iChunk.mIndex != next_write++ )
+         valid = false;
+      for( std::size_t i = 0; i < iChunk.mBlockCount; i++ )
+         valid = valid && iChunk.mData[i] == char( ( iChunk.mFirstBlock + i ) % 127 );
+
+      written.push_back( iChunk.mIndex );
+      return written.size() != iWriteError + 1;
+   };
+
+   // The hasher only looks at the chunk positions: the processor of this test writes mData
+   auto hasher = [&]( const tChunk& iChunk )
+   {
+      hashed.push_back( iChunk.mIndex );
+   };
+
+   const bool result = pipeline.run( reader, processor, writer, hasher );
+   const bool expected_result = iReadError == std::size_t( -1 ) && iWriteError == std::size_t( -1 );
+   const std::size_t chunk_count = ( iBlockCount + chunk_block_count - 1 ) / chunk_block_count;
+
+   if( result != expected_result )
+   {
+      std::cout << "Error - Pipeline run returned " << result << " instead of " << expected_result << std::endl;
+      return false;
+   }
+
+   if( expected_result && written.size() != chunk_count )
+      valid = false;
+
+   for( std::size_t i = 0; i < hashed.size(); i++ )
+      valid = valid && hashed[i] == i;
+   if( expected_result && hashed.size() != chunk_count )
+      valid = false;
+
+   if( !valid )
+      std::cout << "Error - Pipeline of " << iChunkCount << " chunk(s) over " << iBlockCount << " blocks: wrong order or content" << std::endl;
+
+   return valid;
+}
+
+int main()
+{
+   const std::size_t none = std::size_t( -1 );
+
+   bool pipeline_validation_result = pool_validation_test() &&
+                                     pool_stealing_validation_test() &&
+                                     pipeline_validation_test( 1,    0, none, none ) &&
+                                     pipeline_validation_test( 1,  950, none, none ) &&
+                                     pipeline_validation_test( 4, 2000, none, none ) &&
+                                     pipeline_validation_test( 4, 2050,    5, none ) &&
+                                     pipeline_validation_test( 4, 2050, none,    3 ) ;
+
+   if( pipeline_validation_result )
+   {
+      std::cout << "ECC Pipeline Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Pipeline Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,298 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_ECC_PIPELINE_HPP
+#define INCLUDE_ECC_PIPELINE_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ecc-thread-pool.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      // A codeword with a non-zero syndrome
+      struct corrupted_block
+      {
+         std::uint64_t mIndex;       // Index of the codeword inside the whole file
+         bool          mCorrectable;
+      };
+
+      // A symbol of a codeword known to be wrong (its byte could not be read, see sector_reader)
+      struct codeword_erasure
+      {
+         std::uint64_t mBlock;    // Index of the codeword inside the whole file
+         std::size_t   mPosition; // Symbol of the codeword: the data from 0, then the parity from data_length
+      };
+
+      // A unit of work flowing through the pipeline: a contiguous range of codewords
+      struct segment_chunk
+      {
+         std::uint64_t                mIndex = 0;          // Position of the chunk inside the stream (used to keep the output ordered)
+         std::size_t                  mFile = 0;           // File of the chunk, when the stream covers several files
+         std::uint64_t                mFirstBlock = 0;     // Index of the first codeword of the chunk inside the whole file
+         std::size_t                  mBlockCount = 0;     // Number of codewords of the chunk (the last one may be partial)
+         std::vector<char>            mData;               // Data bytes (input of encode/decode)
+         std::vector<char>            mEcc;                // Ecc bytes (output of encode, input of decode)
+         std::vector<std::uint32_t>   mCrcs;               // Crc of the codewords, when the ecc file has a crc index (empty otherwise)
+         std::vector<char>            mOutput;             // Decoded data bytes (output of decode)
+         std::vector<codeword_erasure> mErasures;          // Symbols of the chunk which could not be read, sorted (input of decode/verify)
+         std::atomic<std::size_t>     mFailedBlocks { 0 }; // Number of codewords which could not be corrected
+         std::size_t                  mPendingRanges = 0;  // Ranges of the chunk not processed yet
+         bool                         mPendingHash = false; // The hasher didn't process the chunk yet
+         std::vector<corrupted_block> mCorruptedBlocks;    // Codewords with errors (output of verify, unordered)
+         std::mutex                   mCorruptedMutex;     // Ranges of the chunk add their corrupted codewords concurrently
+      };
+
+      template <typename T>
+      class blocking_queue
+      {
+      public:
+
+         void push( const T& iValue )
+         {
+            {
+               std::lock_guard<std::mutex> lock( mMutex );
+               mQueue.push_back( iValue );
+            }
+            mCondition.notify_one();
+         }
+
+         // Return false when the queue is closed and empty
+         bool pop( T& oValue )
+         {
+            std::unique_lock<std::mutex> lock( mMutex );
+            mCondition.wait( lock, [this]{ return !mQueue.empty() || mClosed; } );
+            if( mQueue.empty() )
+               return false;
+
+            oValue = mQueue.front();
+            mQueue.pop_front();
+            return true;
+         }
+
+         void close()
+         {
+            {
+               std::lock_guard<std::mutex> lock( mMutex );
+               mClosed = true;
+            }
+            mCondition.notify_all();
+         }
+
+      private:
+
+         std::mutex              mMutex;
+         std::condition_variable mCondition;
+         std::deque<T>           mQueue;
+         bool                    mClosed = false;
+      };
+
+      /*
+         Reader -> workers -> writer pipeline over a fixed pool of reusable chunks.
+
+         - the reader fills free chunks sequentially (disk reads overlap the RS work)
+         - each chunk is cut into ranges of codewords, processed by the work stealing pool
+           in any order; every range writes at its own offset inside the chunk buffers
+         - the optional hasher consumes the chunks in stream order in its own thread, alongside
+           the workers (a digest of the whole stream never takes a worker from the RS work);
+           it only reads the input data, which the processors don't modify
+         - the writer consumes the chunks in stream order, then gives them back to the pool
+
+         The memory used is bounded by the number of chunks in the pool, and the output
+         doesn't depend on which worker processed which range.
+      */
+      class segment_pipeline
+      {
+      public:
+
+         enum class eReadStatus
+         {
+            kChunk,
+            kEnd,
+            kError,
+         };
+
+         typedef std::function<eReadStatus( segment_chunk& )>                     reader_t;
+         typedef std::function<void( segment_chunk&, std::size_t, std::size_t )>  processor_t; // chunk, first block (in the chunk), block count
+         typedef std::function<bool( const segment_chunk& )>                      writer_t;
+         typedef std::function<void( const segment_chunk& )>                      hasher_t;
+
+         segment_pipeline( std::size_t iChunkCount, work_stealing_pool& ioPool, std::size_t iRangeBlockCount )
+         : mChunks( iChunkCount ? iChunkCount : 1 ),
+           mPool( ioPool ),
+           mRangeBlockCount( iRangeBlockCount ? iRangeBlockCount : 1 )
+         {
+         }
+
+         // Return false if the reader or the writer failed
+         bool run( const reader_t& iReader, const processor_t& iProcessor, const writer_t& iWriter, const hasher_t& iHasher = hasher_t() )
+         {
+            mAbort = false;
+
+            blocking_queue<segment_chunk*> free_chunks;
+            blocking_queue<segment_chunk*> ordered_chunks;
+            blocking_queue<segment_chunk*> hashed_chunks;
+            for( auto& chunk : mChunks )
+               free_chunks.push( &chunk );
+
+            bool read_error = false;
+
+            std::thread reader( [&]()
+            {
+               std::uint64_t index = 0;
+               segment_chunk* chunk = nullptr;
+               while( !mAbort && free_chunks.pop( chunk ) )
+               {
+                  chunk->mIndex = index;
+                  chunk->mFailedBlocks = 0;
+                  chunk->mCorruptedBlocks.clear();
+
+                  eReadStatus status = iReader( *chunk );
+                  if( status != eReadStatus::kChunk )
+                  {
+                     read_error = ( status == eReadStatus::kError );
+                     break;
+                  }
+
+                  if( iHasher )
+                  {
+                     std::lock_guard<std::mutex> lock( mRangesMutex );
+                     chunk->mPendingHash = true;
+                  }
+
+                  Dispatch( *chunk, iProcessor );
+                  if( iHasher )
+                     hashed_chunks.push( chunk );
+                  ordered_chunks.push( chunk );
+                  index++;
+               }
+
+               hashed_chunks.close();
+               ordered_chunks.close();
+            } );
+
+            // The hasher sees the chunks in stream order, like the writer (which waits for it)
+            std::thread hasher;
+            if( iHasher )
+            {
+               hasher = std::thread( [&]()
+               {
+                  segment_chunk* chunk = nullptr;
+                  while( hashed_chunks.pop( chunk ) )
+                  {
+                     if( !mAbort )
+                        iHasher( *chunk );
+
+                     std::lock_guard<std::mutex> lock( mRangesMutex );
+                     chunk->mPendingHash = false;
+                     mRangesCondition.notify_all();
+                  }
+               } );
+            }
+
+            // The writer runs in the calling thread and keeps the stream order
+            bool write_error = false;
+            segment_chunk* chunk = nullptr;
+            while( ordered_chunks.pop( chunk ) )
+            {
+               {
+                  std::unique_lock<std::mutex> lock( mRangesMutex );
+                  mRangesCondition.wait( lock, [&]{ return !chunk->mPendingRanges && !chunk->mPendingHash; } );
+               }
+
+               if( !mAbort && !iWriter( *chunk ) )
+               {
+                  write_error = true;
+                  mAbort = true;
+                  free_chunks.close();
+               }
+
+               free_chunks.push( chunk );
+            }
+
+            mAbort = true;
+            free_chunks.close();
+
+            reader.join();
+            if( hasher.joinable() )
+               hasher.join();
+
+            return !read_error && !write_error;
+         }
+
+      private:
+
+         void Dispatch( segment_chunk& ioChunk, const processor_t& iProcessor )
+         {
+            const std::size_t range_count = ( ioChunk.mBlockCount + mRangeBlockCount - 1 ) / mRangeBlockCount;
+            if( !range_count )
+               return;
+
+            {
+               std::lock_guard<std::mutex> lock( mRangesMutex );
+               ioChunk.mPendingRanges = range_count;
+            }
+
+            for( std::size_t first_block = 0; first_block < ioChunk.mBlockCount; first_block += mRangeBlockCount )
+            {
+               const std::size_t block_count = std::min( mRangeBlockCount, ioChunk.mBlockCount - first_block );
+
+               mPool.submit( [this, &ioChunk, &iProcessor, first_block, block_count]()
+               {
+                  if( !mAbort )
+                     iProcessor( ioChunk, first_block, block_count );
+
+                  std::lock_guard<std::mutex> lock( mRangesMutex );
+                  if( !--ioChunk.mPendingRanges )
+                     mRangesCondition.notify_all();
+               } );
+            }
+         }
+
+         std::vector<segment_chunk>               mChunks;
+         work_stealing_pool&                      mPool;
+         const std::size_t                        mRangeBlockCount;
+         std::atomic<bool>                        mAbort { false };
+
+         std::mutex                               mRangesMutex;
+         std::condition_variable                  mRangesCondition;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,240 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The repair journal: a committed transaction is replayed
+                into the data file by a new journal (the recovery of an
+                interrupted repair), a torn or corrupted journal is dropped,
+                and a range outside the data file is never written.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ecc-repair-journal.hpp"
+
+
+typedef schifra::reed_solomon::repair_journal tJournal;
+
+const std::size_t data_size = 100000;
+
+std::vector<char> ReadFile( const std::string& iPath )
+{
+   std::vector<char> bytes( data_size + 1 );
+   const int file = ::open( iPath.c_str(), O_RDONLY );
+   const ssize_t count = file >= 0 ? ::read( file, bytes.data(), bytes.size() ) : -1;
+   if( file >= 0 )
+      ::close( file );
+
+   bytes.resize( count > 0 ? std::size_t( count ) : 0 );
+   return bytes;
+}
+
+bool WriteFile( const std::string& iPath, const std::vector<char>& iBytes )
+{
+   const int file = ::open( iPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+   const bool written = file >= 0 && ::write( file, iBytes.data(), iBytes.size() ) == ssize_t( iBytes.size() );
+   if( file >= 0 )
+      ::close( file );
+
+   return written;
+}
+
+// Commit the ranges of ioExpected (offset, size) with random bytes, and apply them to ioExpected
+bool CommitTransaction( const std::string& iJournal, const std::vector<std::pair<std::uint64_t, std::uint64_t>>& iRanges, std::vector<char>& ioExpected )
+{
+   tJournal journal( iJournal );
+   journal.begin();
+   for( const auto& range : iRanges )
+   {
+      std::vector<char> bytes( std::size_t( range.second ) );
+      for( auto& byte : bytes )
+         byte = char( ::rand() );
+
+      journal.add( range.first, bytes.data(), range.second );
+
+      if( range.first <= ioExpected.size() && range.second <= ioExpected.size() - range.first )
+         std::copy( bytes.begin(), bytes.end(), ioExpected.begin() + std::ptrdiff_t( range.first ) );
+   }
+
+   // The process "dies" here: the journal object goes away without apply()
+   return journal.commit();
+}
+
+// Replay the journal left by an interrupted repair, as RepairFile() does: return false if it's not applied
+bool Replay( const std::string& iJournal, const std::string& iData, std::uint64_t& oBytesWritten )
+{
+   oBytesWritten = 0;
+   if( !tJournal::exists( iJournal ) )
+      return false;
+
+   tJournal journal( iJournal );
+   const int data = ::open( iData.c_str(), O_RDWR );
+   const bool applied = data >= 0 && journal.open() && journal.load() && journal.apply( data, oBytesWritten );
+   if( data >= 0 )
+      ::close( data );
+
+   return applied;
+}
+
+bool repair_journal_validation_test()
+{
+   const std::string data_path = "data";
+   const std::string journal_path = "data.repair-journal";
+
+   std::vector<char> original( data_size );
+   for( auto& byte : original )
+      byte = char( ::rand() );
+
+   if( !WriteFile( data_path, original ) )
+   {
+      std::cout << "Error - Data file could not be written" << std::endl;
+      return false;
+   }
+
+   // A journal is only created by its first commit: one without transaction leaves no file
+   {
+      tJournal journal( journal_path );
+      journal.begin();
+      if( journal.open() || !journal.clear() || !journal.remove() || tJournal::exists( journal_path ) )
+      {
+         std::cout << "Error - Journal created before its first commit" << std::endl;
+         return false;
+      }
+   }
+
+   // Replay of a complete transaction, up to the last byte of the file
+   std::vector<char> expected = original;
+   std::uint64_t written = 0;
+   if( !CommitTransaction( journal_path, { { 0, 10 }, { 5000, 223 }, { data_size - 77, 77 } }, expected ) ||
+       !Replay( journal_path, data_path, written ) || written != 10 + 223 + 77 || ReadFile( data_path ) != expected )
+   {
+      std::cout << "Error - Replay of a committed transaction" << std::endl;
+      return false;
+   }
+
+   // A second replay is idempotent
+   if( !Replay( journal_path, data_path, written ) || ReadFile( data_path ) != expected )
+   {
+      std::cout << "Error - Second replay of a committed transaction" << std::endl;
+      return false;
+   }
+
+   // A cleared journal holds no transaction
+   {
+      tJournal journal( journal_path );
+      if( !journal.open() || !journal.clear() || Replay( journal_path, data_path, written ) )
+      {
+         std::cout << "Error - Replay of a cleared journal" << std::endl;
+         return false;
+      }
+   }
+
+   // A torn journal (its end not written) and a corrupted one are dropped, the data file is untouched
+   const std::vector<char> current = expected;
+   for( int damage = 0; damage < 2; damage++ )
+   {
+      std::vector<char> unused = current;
+      if( !CommitTransaction( journal_path, { { 100, 1000 }, { 20000, 3000 } }, unused ) )
+      {
+         std::cout << "Error - Commit of a transaction" << std::endl;
+         return false;
+      }
+
+      std::vector<char> journal_bytes = ReadFile( journal_path );
+      if( damage == 0 )
+         journal_bytes.resize( journal_bytes.size() - 1500 );
+      else
+         journal_bytes[journal_bytes.size() / 2] ^= 0x10;
+      WriteFile( journal_path, journal_bytes );
+
+      if( Replay( journal_path, data_path, written ) || written || ReadFile( data_path ) != current )
+      {
+         std::cout << "Error - Replay of a " << ( damage == 0 ? "torn" : "corrupted" ) << " journal" << std::endl;
+         return false;
+      }
+   }
+
+   // A range past the end of the data file: nothing is written, not even the valid ranges before it
+   for( const std::uint64_t offset : { std::uint64_t( data_size - 10 ), std::uint64_t( data_size + 1 ), std::uint64_t( -5 ) } )
+   {
+      std::vector<char> unused = current;
+      if( !CommitTransaction( journal_path, { { 0, 100 }, { offset, 11 } }, unused ) )
+      {
+         std::cout << "Error - Commit of a transaction" << std::endl;
+         return false;
+      }
+
+      if( Replay( journal_path, data_path, written ) || written || ReadFile( data_path ) != current )
+      {
+         std::cout << "Error - Replay of a range outside the data file (offset " << offset << ")" << std::endl;
+         return false;
+      }
+   }
+
+   tJournal journal( journal_path );
+   if( !journal.open() || !journal.remove() || tJournal::exists( journal_path ) )
+   {
+      std::cout << "Error - Removal of the journal" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand( 0x9B05688 );
+
+   // The journal is created next to the data file, in a scratch directory
+   char directory[] = "/tmp/ecc-repair-journal-validation.XXXXXX";
+   if( !::mkdtemp( directory ) || ::chdir( directory ) != 0 )
+   {
+      std::cout << "Error - Scratch directory could not be created" << std::endl;
+      return 1;
+   }
+
+   const bool repair_journal_validation_result = repair_journal_validation_test();
+
+   ::unlink( "data" );
+   ::unlink( "data.repair-journal" );
+   ::rmdir( directory );
+
+   if( repair_journal_validation_result )
+   {
+      std::cout << "ECC Repair Journal Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Repair Journal Validation Failure!" << std::endl;
+      return 1;
+   }
+}
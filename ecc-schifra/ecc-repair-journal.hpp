@@ -0,0 +1,333 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+#ifndef INCLUDE_ECC_REPAIR_JOURNAL_HPP
+#define INCLUDE_ECC_REPAIR_JOURNAL_HPP
+
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "schifra_crc.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Redo journal of an in place repair.
+
+         The corrected byte ranges of a chunk are first written to the journal
+         (and synced), then to the data file (and synced), then the journal is
+         emptied. If the process dies in between, the data file may hold a mix
+         of old and new bytes: replaying the journal (the writes are idempotent)
+         completes the repair. A transaction not fully written to the journal
+         fails its crc and is dropped, the data file was not touched yet.
+
+         Layout: magic, range count, ranges (offset, size, bytes), crc32 of
+         everything after the magic.
+      */
+      class repair_journal
+      {
+      public:
+
+         explicit repair_journal( const std::string& iPath )
+         : mPath( iPath )
+         {
+         }
+
+         ~repair_journal()
+         {
+            if( mFile >= 0 )
+               ::close( mFile );
+         }
+
+         repair_journal( const repair_journal& ) = delete;
+         repair_journal& operator=( const repair_journal& ) = delete;
+
+         const std::string& path() const
+         {
+            return mPath;
+         }
+
+         static bool exists( const std::string& iPath )
+         {
+            struct stat status;
+            return ::stat( iPath.c_str(), &status ) == 0;
+         }
+
+         // Open the journal left by an interrupted repair (a new journal is only created by the first commit)
+         bool open()
+         {
+            mFile = ::open( mPath.c_str(), O_RDWR );
+            return mFile >= 0;
+         }
+
+         // Load the transaction of an interrupted repair, return false if there is no complete one
+         bool load()
+         {
+            struct stat status;
+            if( ::fstat( mFile, &status ) != 0 || std::uint64_t( status.st_size ) < header_size + sizeof( std::uint32_t ) )
+               return false;
+
+            mBuffer.resize( std::size_t( status.st_size ) );
+            if( !ReadAt( mBuffer.data(), mBuffer.size(), 0 ) || std::memcmp( mBuffer.data(), magic, sizeof( magic ) ) )
+            {
+               mBuffer.clear();
+               return false;
+            }
+
+            std::uint32_t stored_crc;
+            std::memcpy( &stored_crc, mBuffer.data() + mBuffer.size() - sizeof( stored_crc ), sizeof( stored_crc ) );
+            mBuffer.resize( mBuffer.size() - sizeof( stored_crc ) );
+
+            if( stored_crc != Checksum() || !IsWellFormed() )
+            {
+               mBuffer.clear();
+               return false;
+            }
+
+            return true;
+         }
+
+         // Start a new transaction
+         void begin()
+         {
+            mBuffer.assign( magic, magic + sizeof( magic ) );
+            mBuffer.resize( header_size, 0 );
+            mRangeCount = 0;
+         }
+
+         void add( std::uint64_t iOffset, const char* iBytes, std::uint64_t iSize )
+         {
+            Append( &iOffset, sizeof( iOffset ) );
+            Append( &iSize, sizeof( iSize ) );
+            Append( iBytes, std::size_t( iSize ) );
+
+            mRangeCount++;
+            std::memcpy( mBuffer.data() + sizeof( magic ), &mRangeCount, sizeof( mRangeCount ) );
+         }
+
+         // Make the transaction durable, nothing is written to the data file before
+         bool commit()
+         {
+            if( mFile < 0 )
+               mFile = ::open( mPath.c_str(), O_RDWR | O_CREAT, 0644 );
+            if( mFile < 0 )
+               return false;
+
+            const std::uint32_t crc = Checksum();
+
+            if( ::ftruncate( mFile, 0 ) != 0 || !WriteAt( mBuffer.data(), mBuffer.size(), 0 ) || !WriteAt( &crc, sizeof( crc ), mBuffer.size() ) )
+               return false;
+
+            if( ::fsync( mFile ) != 0 )
+               return false;
+
+            // The entry of a new journal must be durable too, else a crash could lose the whole file
+            if( !mDirectorySynced )
+               mDirectorySynced = SyncDirectory();
+
+            return mDirectorySynced;
+         }
+
+         // Write the ranges of the transaction to the data file and sync it, return the number of bytes written
+         bool apply( int iDataFile, std::uint64_t& oBytesWritten )
+         {
+            oBytesWritten = 0;
+
+            // A repair only rewrites bytes of the data file: a range beyond its end belongs to another file, nothing is written
+            struct stat status;
+            if( ::fstat( iDataFile, &status ) != 0 )
+               return false;
+
+            const std::uint64_t data_size = std::uint64_t( status.st_size );
+            if( !Parse( [data_size]( std::uint64_t iOffset, const char*, std::uint64_t iSize ) { return iOffset <= data_size && iSize <= data_size - iOffset; } ) )
+               return false;
+
+            if( !Parse( [&]( std::uint64_t iOffset, const char* iBytes, std::uint64_t iSize )
+                        {
+                           if( !WriteAt( iDataFile, iBytes, std::size_t( iSize ), iOffset ) )
+                              return false;
+
+                           oBytesWritten += iSize;
+                           return true;
+                        } ) )
+               return false;
+
+            return ::fsync( iDataFile ) == 0;
+         }
+
+         // The transaction is in the data file: forget it
+         bool clear()
+         {
+            mBuffer.clear();
+            mRangeCount = 0;
+
+            return mFile < 0 || ( ::ftruncate( mFile, 0 ) == 0 && ::fsync( mFile ) == 0 );
+         }
+
+         // The repair is complete (or holds no transaction to replay): a journal never created is fine
+         bool remove()
+         {
+            if( mFile >= 0 )
+               ::close( mFile );
+            mFile = -1;
+            mDirectorySynced = false;
+
+            return ::unlink( mPath.c_str() ) == 0 || errno == ENOENT;
+         }
+
+      private:
+
+         static constexpr char magic[8] = { 'E', 'C', 'C', 'R', 'E', 'P', 'J', '1' };
+         static const std::size_t header_size = sizeof( magic ) + sizeof( std::uint64_t );
+
+         void Append( const void* iBytes, std::size_t iSize )
+         {
+            const char* bytes = static_cast<const char*>( iBytes );
+            mBuffer.insert( mBuffer.end(), bytes, bytes + iSize );
+         }
+
+         std::uint32_t Checksum() const
+         {
+            schifra::crc32 crc( 0xEDB88320, 0xFFFFFFFF );
+            crc.update( reinterpret_cast<const unsigned char*>( mBuffer.data() + sizeof( magic ) ), mBuffer.size() - sizeof( magic ) );
+
+            return std::uint32_t( crc.crc() );
+         }
+
+         // Walk the ranges of the transaction, check they exactly fill the buffer
+         template <typename Visitor>
+         bool Parse( const Visitor& iVisitor ) const
+         {
+            std::uint64_t range_count;
+            std::memcpy( &range_count, mBuffer.data() + sizeof( magic ), sizeof( range_count ) );
+
+            std::size_t position = header_size;
+            for( std::uint64_t i = 0; i < range_count; i++ )
+            {
+               std::uint64_t offset;
+               std::uint64_t size;
+               if( mBuffer.size() - position < sizeof( offset ) + sizeof( size ) )
+                  return false;
+
+               std::memcpy( &offset, mBuffer.data() + position, sizeof( offset ) );
+               std::memcpy( &size, mBuffer.data() + position + sizeof( offset ), sizeof( size ) );
+               position += sizeof( offset ) + sizeof( size );
+               if( mBuffer.size() - position < size )
+                  return false;
+
+               if( !iVisitor( offset, mBuffer.data() + position, size ) )
+                  return false;
+
+               position += std::size_t( size );
+            }
+
+            return position == mBuffer.size();
+         }
+
+         bool IsWellFormed() const
+         {
+            return Parse( []( std::uint64_t, const char*, std::uint64_t ) { return true; } );
+         }
+
+         bool SyncDirectory() const
+         {
+            const std::string::size_type separator = mPath.rfind( '/' );
+            const std::string directory = separator == std::string::npos ? "." : separator == 0 ? "/" : mPath.substr( 0, separator );
+
+            const int file = ::open( directory.c_str(), O_RDONLY | O_DIRECTORY );
+            if( file < 0 )
+               return false;
+
+            const bool synced = ::fsync( file ) == 0;
+            ::close( file );
+
+            return synced;
+         }
+
+         bool ReadAt( char* oBytes, std::size_t iSize, std::uint64_t iOffset ) const
+         {
+            while( iSize )
+            {
+               const ssize_t count = ::pread( mFile, oBytes, iSize, off_t( iOffset ) );
+               if( count < 0 && errno == EINTR )
+                  continue;
+               if( count <= 0 )
+                  return false;
+
+               oBytes += count;
+               iSize -= std::size_t( count );
+               iOffset += std::uint64_t( count );
+            }
+
+            return true;
+         }
+
+         bool WriteAt( const void* iBytes, std::size_t iSize, std::uint64_t iOffset ) const
+         {
+            return WriteAt( mFile, iBytes, iSize, iOffset );
+         }
+
+         static bool WriteAt( int iFile, const void* iBytes, std::size_t iSize, std::uint64_t iOffset )
+         {
+            const char* bytes = static_cast<const char*>( iBytes );
+            while( iSize )
+            {
+               const ssize_t count = ::pwrite( iFile, bytes, iSize, off_t( iOffset ) );
+               if( count < 0 && errno == EINTR )
+                  continue;
+               if( count <= 0 )
+                  return false;
+
+               bytes += count;
+               iSize -= std::size_t( count );
+               iOffset += std::uint64_t( count );
+            }
+
+            return true;
+         }
+
+         std::string       mPath;
+         int               mFile = -1;
+         std::vector<char> mBuffer;     // The current transaction, without its crc
+         std::uint64_t     mRangeCount = 0;
+         bool              mDirectorySynced = false; // The directory entry of the journal is durable
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,551 @@
+#!/usr/bin/env bash
+#
+# Copyright (c) 2019 m-ll. All Rights Reserved.
+#
+# Licensed under the MIT License.
+# See LICENSE file in the project root for full license information.
+#
+# 2b13c8312f53d4b9202b6c8c0f0e790d10044f9a00d8bab3edf3cd287457c979
+# 29c355784a3921aa290371da87bce9c1617b8584ca6ac6fb17fb37ba4a07d191
+#
+
+usage()
+{
+	echo "Usage: $0 [-h] [executable]"
+	echo '  -h: help me'
+	echo '  executable: the ecc-schifra-255-32-8 to validate (default: ../ecc-schifra-255-32-8)'
+	exit 2
+}
+
+# Process all the parameters
+while getopts ":h" option; do
+    case "${option}" in
+        h|*)
+            usage
+            ;;
+    esac
+done
+shift $((OPTIND-1))
+
+EXECUTABLE=$(realpath "${1:-../ecc-schifra-255-32-8}")
+if [[ ! -x "$EXECUTABLE" ]]; then
+	usage
+fi
+
+WORK_DIRECTORY=$(mktemp -d)
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+cd "$WORK_DIRECTORY" || exit 1
+
+FAILURES=0
+
+#---
+
+# Report a failed check
+#
+# $1: what failed
+fail()
+{
+	echo "Failure: $1"
+	FAILURES=$((FAILURES + 1))
+}
+
+# Run the executable quietly
+#
+# $@: its arguments
+ecc()
+{
+	"$EXECUTABLE" "$@" >/dev/null 2>&1
+}
+
+# Create a file of random bytes
+#
+# $1: the file
+# $2: its size
+create_file()
+{
+	head -c "$2" /dev/urandom > "$1"
+}
+
+# Overwrite bytes of a file with random bytes
+#
+# $1: the file
+# $2: the offset of the first byte
+# $3: the number of bytes
+corrupt_file()
+{
+	head -c "$3" /dev/urandom | dd of="$1" bs=1 seek="$2" conv=notrunc status=none
+}
+
+# Corrupt 8 bytes (correctable) of every 10th codeword of the first 100
+#
+# $1: the file
+corrupt_codewords()
+{
+	local size
+	size=$(stat -c %s "$1")
+
+	for (( block = 0; block < 100 && (block + 1) * 223 <= size; block += 10 )); do
+		corrupt_file "$1" $((block * 223 + 100)) 8
+	done
+}
+
+#---
+
+# Encode then decode files of all the sizes around the codeword and chunk boundaries, clean and damaged
+check_round_trip()
+{
+	for size in 0 1 222 223 224 100000 3000001; do
+		create_file data "$size"
+		cp data damaged
+		corrupt_codewords damaged
+
+		ecc encode -i data -o data.ecc || fail "encode of $size bytes"
+		ecc decode -i data -e data.ecc -o decoded && cmp -s decoded data || fail "decode of $size clean bytes"
+		ecc decode -i damaged -e data.ecc -o decoded && cmp -s decoded data || fail "decode of $size damaged bytes"
+		ecc --memory 1 decode -i damaged -e data.ecc -o decoded && cmp -s decoded data || fail "decode of $size damaged bytes in small chunks"
+	done
+}
+
+# Verify clean, correctable and uncorrectable files: its exit status tells them apart, and it writes nothing
+check_verify()
+{
+	create_file data 1000000
+	ecc encode -i data -o data.ecc || fail "encode before verify"
+
+	local status
+	ecc verify -i data -e data.ecc; status=$?
+	[[ $status -eq 0 ]] || fail "verify of a clean file: status $status"
+
+	cp data damaged
+	corrupt_codewords damaged
+	cp damaged damaged.copy
+	cp data.ecc data.ecc.copy
+	local files
+	files=$(ls)
+	ecc verify -i damaged -e data.ecc; status=$?
+	[[ $status -eq 2 ]] || fail "verify of a correctable file: status $status"
+	cmp -s damaged damaged.copy && cmp -s data.ecc data.ecc.copy || fail "verify modified its inputs"
+	[[ "$(ls)" == "$files" ]] || fail "verify created files"
+
+	# 20 bytes of a codeword: beyond its 16 correctable errors
+	corrupt_file damaged 2230 20
+	ecc verify -i damaged -e data.ecc; status=$?
+	[[ $status -eq 3 ]] || fail "verify of an uncorrectable file: status $status"
+
+	ecc verify -i data -e missing.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "verify without ecc file: status $status"
+}
+
+# Repair damaged files in place, the journal is removed once done
+check_repair()
+{
+	for size in 1000 3000001; do
+		create_file data "$size"
+		ecc encode -i data -o data.ecc || fail "encode before repair"
+
+		cp data damaged
+		corrupt_codewords damaged
+		ecc repair -i damaged -e data.ecc && cmp -s damaged data || fail "repair of $size bytes"
+		[[ ! -e damaged.repair-journal ]] || fail "journal left by the repair of $size bytes"
+
+		ecc repair -i damaged -e data.ecc && cmp -s damaged data || fail "repair of $size clean bytes"
+	done
+
+	# A repair which fails before its first write (a truncated ecc file) leaves no journal
+	local status
+	corrupt_codewords damaged
+	truncate -s 1000 data.ecc
+	ecc repair -i damaged -e data.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "repair with a truncated ecc file: status $status"
+	[[ ! -e damaged.repair-journal ]] || fail "journal left by a repair which failed before its first write"
+
+	ecc encode -i data -o data.ecc || fail "encode before repair"
+	"$EXECUTABLE" -v repair -i damaged -e data.ecc > repair.log 2>&1 && cmp -s damaged data || fail "repair after a failed one"
+	grep -q "interrupted repair" repair.log && fail "repair after a failed one found an interrupted repair"
+
+	# A repaired file gets back the mtime of its ecc file: a later batch encode doesn't report it as changed
+	mkdir -p repair-tree
+	create_file repair-tree/data.gpg 3000001
+	ecc encode -i repair-tree || fail "batch encode before repair"
+	touch -d '1 hour ago' repair-tree/data.gpg
+	corrupt_codewords repair-tree/data.gpg
+	ecc repair -i repair-tree/data.gpg -e ecc-schifra-255-32-8/repair-tree/data.gpg.ecc-schifra-255-32-8 || fail "repair of a batch encoded file"
+	"$EXECUTABLE" -v encode -i repair-tree > encode.log 2>&1
+	grep -q "changed since" encode.log && fail "batch encode after a repair reported the repaired file as changed"
+}
+
+# Encode/verify/decode directory trees and manifests in one process, with the paths and skip rules of ecc.py
+check_batch()
+{
+	local status file
+	mkdir -p tree/a/b tree/c
+	create_file tree/empty.gpg 0
+	create_file tree/a/small.gpg 1000
+	create_file tree/a/b/big.gpg 3000001
+	create_file tree/c/other.gpg 224
+	create_file tree/c/not-encrypted 1000
+
+	ecc --memory 1 encode -i tree || fail "batch encode"
+	for file in tree/empty.gpg tree/a/small.gpg tree/a/b/big.gpg tree/c/other.gpg; do
+		[[ -f "ecc-schifra-255-32-8/$file.ecc-schifra-255-32-8" ]] || fail "batch encode of $file"
+	done
+	[[ ! -e ecc-schifra-255-32-8/tree/c/not-encrypted.ecc-schifra-255-32-8 ]] || fail "batch encode of a file which is not a .gpg"
+
+	# The existing ecc files are skipped
+	echo "not overwritten" > ecc-schifra-255-32-8/tree/c/other.gpg.ecc-schifra-255-32-8
+	ecc encode -i tree || fail "batch encode with existing ecc files"
+	grep -q "not overwritten" ecc-schifra-255-32-8/tree/c/other.gpg.ecc-schifra-255-32-8 || fail "batch encode overwrote an existing ecc file"
+	rm ecc-schifra-255-32-8/tree/c/other.gpg.ecc-schifra-255-32-8
+	printf 'tree/c/other.gpg\n' > manifest
+	ecc encode --manifest manifest || fail "batch encode of a manifest"
+
+	ecc verify -i tree; status=$?
+	[[ $status -eq 0 ]] || fail "batch verify of clean files: status $status"
+
+	cp tree/a/b/big.gpg big.copy
+	corrupt_codewords tree/a/b/big.gpg
+	ecc verify -i tree/a -i tree/c; status=$?
+	[[ $status -eq 2 ]] || fail "batch verify of a correctable file: status $status"
+
+	ecc --memory 1 decode -i tree || fail "batch decode"
+	cmp -s ecc-regenerated/tree/a/b/big.gpg.regenerated big.copy || fail "batch decode of a damaged file"
+	for file in tree/empty.gpg tree/a/small.gpg tree/c/other.gpg; do
+		cmp -s "ecc-regenerated/$file.regenerated" "$file" || fail "batch decode of $file"
+	done
+
+	ecc verify -i tree/missing; status=$?
+	[[ $status -eq 1 ]] || fail "batch verify of a missing input: status $status"
+
+	# A single file without its ecc/output file (as ecc.py passes it): a batch of one
+	create_file single.gpg 5000
+	ecc encode -i single.gpg && [[ -f ecc-schifra-255-32-8/single.gpg.ecc-schifra-255-32-8 ]] || fail "batch encode of a single file"
+	ecc verify -i single.gpg; status=$?
+	[[ $status -eq 0 ]] || fail "batch verify of a single file: status $status"
+	ecc decode -i single.gpg && cmp -s ecc-regenerated/single.gpg.regenerated single.gpg || fail "batch decode of a single file"
+}
+
+# Hash the data in the same read as the ecc: the hash files of sha512sum, checked by verify with the syndromes
+check_sha512()
+{
+	local status
+	rm -rf sha512
+	mkdir -p hashed
+	create_file hashed/data.gpg 1000000
+	create_file hashed/empty.gpg 0
+
+	ecc --sha512 encode -i hashed/data.gpg -o data.ecc || fail "encode with sha512"
+	[[ "$(cat sha512/hashed/data.gpg.sha512)" == "$(sha512sum hashed/data.gpg)" ]] || fail "sha512 of a single file"
+
+	ecc --sha512 encode -i hashed || fail "batch encode with sha512"
+	sha512sum --quiet --check sha512/hashed/data.gpg.sha512 sha512/hashed/empty.gpg.sha512 || fail "batch sha512 files"
+
+	ecc --sha512 verify -i hashed; status=$?
+	[[ $status -eq 0 ]] || fail "verify with sha512 of clean files: status $status"
+
+	cp hashed/data.gpg data.copy
+	corrupt_codewords hashed/data.gpg
+	ecc --sha512 verify -i hashed/data.gpg -e data.ecc; status=$?
+	[[ $status -eq 2 ]] || fail "verify with sha512 of a correctable file: status $status"
+
+	# The ecc of the damaged data: no corrupted codeword, but the data is not the hashed one
+	ecc encode -i hashed/data.gpg -o damaged.ecc || fail "encode of damaged data"
+	ecc --sha512 verify -i hashed/data.gpg -e damaged.ecc; status=$?
+	[[ $status -eq 3 ]] || fail "verify with sha512 of a consistently damaged file: status $status"
+
+	cp data.copy hashed/data.gpg
+	rm sha512/hashed/data.gpg.sha512
+	ecc --sha512 verify -i hashed/data.gpg -e data.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "verify with a missing sha512 file: status $status"
+
+	ecc --sha512 decode -i hashed/data.gpg -e data.ecc -o decoded; status=$?
+	[[ $status -eq 1 ]] || fail "decode with sha512: status $status"
+}
+
+# An ecc file with a crc index: bursts up to 32 bytes in a codeword are corrected (16 without the index)
+check_crc_index()
+{
+	local status
+	create_file data 1000000
+	ecc encode --crc-index -i data -o indexed.ecc || fail "encode with a crc index"
+	ecc encode -i data -o plain.ecc || fail "encode without crc index"
+	[[ $(stat -c %s indexed.ecc) -eq $(( 4096 + ( $(stat -c %s plain.ecc) - 4096 ) / 32 * 36 )) ]] || fail "size of an ecc file with a crc index"
+
+	ecc verify -i data -e indexed.ecc; status=$?
+	[[ $status -eq 0 ]] || fail "verify with a crc index of a clean file: status $status"
+
+	cp data damaged
+	corrupt_file damaged $((223 * 10 + 50)) 30
+	corrupt_file damaged $((223 * 2000 + 191)) 32
+	ecc verify -i damaged -e plain.ecc; status=$?
+	[[ $status -eq 3 ]] || fail "verify without crc index of 30 bytes bursts: status $status"
+	ecc verify -i damaged -e indexed.ecc; status=$?
+	[[ $status -eq 2 ]] || fail "verify with a crc index of 30 bytes bursts: status $status"
+	ecc --memory 1 decode -i damaged -e indexed.ecc -o decoded && cmp -s decoded data || fail "decode with a crc index of 30 bytes bursts"
+	ecc repair -i damaged -e indexed.ecc && cmp -s damaged data || fail "repair with a crc index of 30 bytes bursts"
+
+	mkdir -p indexed
+	create_file indexed/data.gpg 100000
+	ecc --crc-index encode -i indexed || fail "batch encode with a crc index"
+	[[ $(stat -c %s ecc-schifra-255-32-8/indexed/data.gpg.ecc-schifra-255-32-8) -eq $(( 4096 + 449 * 36 )) ]] || fail "batch encode with a crc index: size"
+	ecc verify -i indexed; status=$?
+	[[ $status -eq 0 ]] || fail "batch verify with a crc index: status $status"
+}
+
+# The header of the ecc files: its copies, the data file it was made for, its digest, and the headerless files of before
+check_header()
+{
+	local status layout
+	create_file data 100000
+	ecc encode -i data -o data.ecc || fail "encode with a header"
+	[[ $(stat -c %s data.ecc) -eq $(( 4096 + 449 * 32 )) ]] || fail "size of an ecc file with a header"
+
+	# A damaged copy is reported as correctable and rewritten by repair, 4 damaged copies are voted
+	cp data.ecc damaged.ecc
+	corrupt_file damaged.ecc 20 8
+	ecc verify -i data -e damaged.ecc; status=$?
+	[[ $status -eq 2 ]] || fail "verify with a damaged header copy: status $status"
+	ecc repair -i data -e damaged.ecc && cmp -s damaged.ecc data.ecc || fail "repair of a damaged header copy"
+	for copy in 0 1 2 3; do
+		corrupt_file damaged.ecc $(( copy * 1024 + 10 + copy * 40 )) 4
+	done
+	ecc decode -i data -e damaged.ecc -o decoded && cmp -s decoded data || fail "decode with 4 damaged header copies"
+
+	# A destroyed header: the layout is found from the size
+	corrupt_file damaged.ecc 0 4096
+	cp data damaged
+	corrupt_codewords damaged
+	ecc decode -i damaged -e damaged.ecc -o decoded && cmp -s decoded data || fail "decode with a destroyed header"
+
+	# A data file of another size than the recorded one
+	cp data longer
+	printf 'x' >> longer
+	ecc verify -i longer -e data.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "verify of a data file of another size: status $status"
+
+	# The digest of --sha512 is also stored in the header, and checked by verify without the hash file
+	rm -rf sha512
+	ecc --sha512 encode -i data -o hashed.ecc || fail "encode with sha512 and a header"
+	rm -rf sha512
+	ecc verify -i data -e hashed.ecc; status=$?
+	[[ $status -eq 0 ]] || fail "verify with the digest of the header of a clean file: status $status"
+	ecc encode -i damaged -o damaged.ecc || fail "encode of damaged data"
+	dd if=hashed.ecc of=damaged.ecc bs=4096 count=1 conv=notrunc status=none
+	ecc verify -i damaged -e damaged.ecc; status=$?
+	[[ $status -eq 3 ]] || fail "verify with the digest of the header of a consistently damaged file: status $status"
+
+	# The headerless ecc files of before, with and without crc index
+	for layout in "" --crc-index; do
+		ecc encode $layout -i data -o data.ecc || fail "encode $layout before removing the header"
+		tail -c +4097 data.ecc > headerless.ecc
+		ecc verify -i data -e headerless.ecc; status=$?
+		[[ $status -eq 0 ]] || fail "verify $layout of a headerless ecc file: status $status"
+		ecc decode -i damaged -e headerless.ecc -o decoded && cmp -s decoded data || fail "decode $layout with a headerless ecc file"
+		cp damaged repaired
+		ecc repair -i repaired -e headerless.ecc && cmp -s repaired data || fail "repair $layout with a headerless ecc file"
+	done
+
+	# 1024 codewords: a headerless crc index is as big as a destroyed header + the parities, the layout isn't guessed
+	create_file ambiguous $(( 223 * 1024 ))
+	ecc encode --crc-index -i ambiguous -o ambiguous.ecc || fail "encode --crc-index of 1024 codewords"
+	tail -c +4097 ambiguous.ecc > headerless.ecc
+	ecc verify -i ambiguous -e headerless.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "verify of an ambiguous headerless ecc file: status $status"
+	ecc encode -i ambiguous -o ambiguous.ecc || fail "encode of 1024 codewords"
+	corrupt_file ambiguous.ecc 0 4096
+	ecc verify -i ambiguous -e ambiguous.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "verify of an ambiguous destroyed header: status $status"
+}
+
+# Decode to the standard output ('-o -'), for a restore piped into gpg: only the data goes there, not the log
+check_standard_output()
+{
+	local status
+	create_file data 3000001
+	ecc encode -i data -o data.ecc || fail "encode before decode to the standard output"
+	cp data damaged
+	corrupt_codewords damaged
+
+	"$EXECUTABLE" -v -v --memory 1 decode -i damaged -e data.ecc -o - 2>/dev/null | cmp -s - data || fail "decode to the standard output"
+	"$EXECUTABLE" -v --memory 1 decode -i damaged -e data.ecc -o - 2>/dev/null | head -c 1000 > /dev/null; status=${PIPESTATUS[0]}
+	[[ $status -eq 1 ]] || fail "decode to a closed standard output: status $status"
+
+	ecc encode -i data -o -; status=$?
+	[[ $status -eq 1 && ! -e - ]] || fail "encode to the standard output: status $status"
+}
+
+# Decode a byte range (--offset/--length): only the codewords covering it are read, the damaged ones are corrected
+check_range()
+{
+	local status offset length crc_index
+	create_file data 3000001
+	for crc_index in "" --crc-index; do
+		ecc $crc_index encode -i data -o data.ecc || fail "encode $crc_index before range decode"
+		cp data damaged
+		corrupt_codewords damaged
+
+		for offset in 0 1 222 223 1000000 2999999 3000001 4000000; do
+			for length in 0 1 223 300000 5000000; do
+				ecc --memory 1 decode --offset "$offset" --length "$length" -i damaged -e data.ecc -o range || fail "range decode $crc_index at $offset + $length"
+				cmp -s range <(tail -c +$((offset + 1)) data | head -c "$length") || fail "range $crc_index at $offset + $length"
+			done
+		done
+	done
+
+	"$EXECUTABLE" decode --offset 1000 -i damaged -e data.ecc -o - 2>/dev/null | cmp -s - <(tail -c +1001 data) || fail "range to the end on the standard output"
+
+	ecc encode --offset 1000 -i data -o range.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "range of an encode: status $status"
+	ecc decode --offset -5 -i damaged -e data.ecc -o range; status=$?
+	[[ $status -eq 1 ]] || fail "negative offset: status $status"
+}
+
+# Encode a stream while writing it to the data file (encode --tee): same records as a second pass, in one read
+check_tee()
+{
+	local status size
+	rm -rf sha512
+	for size in 0 1000 3000001; do
+		create_file stream "$size"
+		ecc encode -i stream -o stream.ecc || fail "encode of $size bytes before tee"
+
+		ecc --memory 1 --sha512 encode --tee -i teed -o teed.ecc < stream && cmp -s teed stream || fail "tee of $size bytes"
+		cmp -s <(tail -c +4097 teed.ecc) <(tail -c +4097 stream.ecc) || fail "tee of $size bytes: parity"
+		[[ "$(cut -d ' ' -f 1 sha512/teed.sha512)" == "$(sha512sum < stream | cut -d ' ' -f 1)" ]] || fail "tee of $size bytes: sha512"
+		ecc verify -i teed -e teed.ecc; status=$?
+		[[ $status -eq 0 ]] || fail "verify after the tee of $size bytes: status $status"
+		rm -rf sha512
+	done
+
+	ecc --crc-index encode --tee -i teed -o teed.ecc < stream && cmp -s teed stream || fail "tee with a crc index"
+	ecc verify -i teed -e teed.ecc; status=$?
+	[[ $status -eq 0 ]] || fail "verify after a tee with a crc index: status $status"
+
+	ecc verify --tee -i teed -e teed.ecc < stream; status=$?
+	[[ $status -eq 1 ]] || fail "tee of a verify: status $status"
+}
+
+# Watch a directory tree while files are written (watch): the .gpg files closed after the start are encoded, even just before the stop
+check_watch()
+{
+	local pid status file
+	rm -rf sha512 watched
+	mkdir -p watched
+	create_file watched/before.gpg 1000
+
+	"$EXECUTABLE" -v --sha512 watch -i watched > watch.log 2>&1 &
+	pid=$!
+	for _ in $(seq 50); do
+		grep -q "watched" watch.log && break
+		sleep 0.1
+	done
+
+	create_file watched/volume.gpg 3000001
+	mkdir watched/sub
+	sleep 0.2 # the new directory is watched from its own event
+	create_file watched/sub/small.gpg 1000
+	create_file watched/not-encrypted 1000
+	create_file moved.gpg 224
+	mv moved.gpg watched/moved.gpg
+
+	kill -TERM "$pid"
+	wait "$pid"; status=$?
+	[[ $status -eq 0 ]] || fail "watch: status $status"
+
+	for file in watched/volume.gpg watched/sub/small.gpg watched/moved.gpg; do
+		[[ -f "ecc-schifra-255-32-8/$file.ecc-schifra-255-32-8" && -f "sha512/$file.sha512" ]] || fail "watch of $file"
+	done
+	[[ ! -e ecc-schifra-255-32-8/watched/before.gpg.ecc-schifra-255-32-8 ]] || fail "watch of a file closed before the start"
+	[[ ! -e ecc-schifra-255-32-8/watched/not-encrypted.ecc-schifra-255-32-8 ]] || fail "watch of a file which is not a .gpg"
+
+	rm watched/before.gpg
+	ecc --sha512 verify -i watched; status=$?
+	[[ $status -eq 0 ]] || fail "verify after watch: status $status"
+
+	ecc watch -i watched/volume.gpg; status=$?
+	[[ $status -eq 1 ]] || fail "watch of a file: status $status"
+}
+
+# Kill whole 4096 bytes sectors (interleaved layout): every codeword of a group loses one symbol per dead sector at most
+check_interleave()
+{
+	local status sector offset length
+	create_file data 3000001
+	ecc encode --interleave -i data -o interleaved.ecc || fail "encode with an interleaved layout"
+	ecc encode -i data -o plain.ecc || fail "encode without an interleaved layout"
+	[[ $(stat -c %s interleaved.ecc) -eq $(stat -c %s plain.ecc) ]] || fail "size of an ecc file with an interleaved layout"
+
+	ecc verify -i data -e interleaved.ecc; status=$?
+	[[ $status -eq 0 ]] || fail "verify with an interleaved layout of a clean file: status $status"
+
+	# 12 sectors of the 3 full groups (223 sectors each) and 1 sector of the parity of the first one
+	cp data damaged
+	for sector in 3 20 50 100 150 222 223 300 400 445 446 600; do
+		corrupt_file damaged $((sector * 4096)) 4096
+	done
+	cp interleaved.ecc damaged.ecc
+	corrupt_file damaged.ecc $((4096 + 5 * 4096)) 4096
+
+	ecc verify -i damaged -e plain.ecc; status=$?
+	[[ $status -eq 3 ]] || fail "verify without an interleaved layout of dead sectors: status $status"
+	ecc verify -i damaged -e damaged.ecc; status=$?
+	[[ $status -eq 2 ]] || fail "verify with an interleaved layout of dead sectors: status $status"
+	ecc --memory 1 decode -i damaged -e damaged.ecc -o decoded && cmp -s decoded data || fail "decode with an interleaved layout of dead sectors"
+
+	for offset in 0 1 913407 913408 2999999; do
+		for length in 1 223 1000000; do
+			ecc decode --offset "$offset" --length "$length" -i damaged -e damaged.ecc -o range || fail "range decode with an interleaved layout at $offset + $length"
+			cmp -s range <(tail -c +$((offset + 1)) data | head -c "$length") || fail "range with an interleaved layout at $offset + $length"
+		done
+	done
+
+	ecc repair -i damaged -e damaged.ecc && cmp -s damaged data || fail "repair with an interleaved layout of dead sectors"
+
+	ecc encode --interleave --tee -i teed -o teed.ecc < data && cmp -s <(tail -c +4097 teed.ecc) <(tail -c +4097 interleaved.ecc) || fail "tee with an interleaved layout"
+
+	ecc encode --interleave --crc-index -i data -o both.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "interleaved layout with a crc index: status $status"
+	ecc verify --interleave -i data -e interleaved.ecc; status=$?
+	[[ $status -eq 1 ]] || fail "interleaved layout of a verify: status $status"
+}
+
+# An option without its value (the last argument): the usage, not a crash
+check_arguments()
+{
+	local option status
+	create_file data 1000
+	for option in -i -e -o --memory --engine --manifest; do
+		"$EXECUTABLE" decode -i data -e data.ecc -o decoded "$option" > usage.log 2>&1; status=$?
+		[[ $status -eq 1 ]] && grep -q "Usage" usage.log || fail "$option without its value: status $status"
+	done
+
+	# A budget which isn't a number of MB, or whose bytes overflow
+	local memory
+	for memory in 12abc -1 0 17592186044417; do
+		"$EXECUTABLE" --memory "$memory" encode -i data -o data.ecc > usage.log 2>&1; status=$?
+		[[ $status -eq 1 ]] && grep -q "Usage" usage.log || fail "--memory $memory: status $status"
+	done
+	ecc --memory 12 encode -i data -o data.ecc || fail "--memory 12"
+}
+
+#---
+
+check_round_trip
+check_verify
+check_repair
+check_batch
+check_sha512
+check_crc_index
+check_header
+check_standard_output
+check_range
+check_tee
+check_watch
+check_interleave
+check_arguments
+
+if [[ $FAILURES -ne 0 ]]; then
+	echo "ecc-schifra-255-32-8 validation: $FAILURES failure(s)"
+	exit 1
+fi
+
+echo "ecc-schifra-255-32-8 successfully validated!"
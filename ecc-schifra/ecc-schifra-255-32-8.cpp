@@ -20,25 +20,98 @@
 */
 
 
+#include <algorithm>
 #include <any>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <math.h>
 #include <map>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "schifra_fileio.hpp"
 #include "schifra_galois_field.hpp"
-#include "schifra_sequential_root_generator_polynomial_creator.hpp"
-#include "schifra_reed_solomon_decoder.hpp"
-#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "ecc-crc-index.hpp"
 #include "ecc-decoder.hpp"
 #include "ecc-encoder.hpp"
+#include "ecc-header.hpp"
+#include "ecc-interleave.hpp"
+#include "ecc-pipeline.hpp"
+#include "ecc-repair-journal.hpp"
+#include "ecc-sector-reader.hpp"
+#include "ecc-sha512.hpp"
+#include "ecc-static-field.hpp"
+#include "ecc-thread-pool.hpp"
 
 //---
 
-typedef std::vector<char> tBigChunk;
+const std::size_t field_descriptor    =   8;
+const std::size_t gen_poly_index      = 120;
+const std::size_t gen_poly_root_count =  32;
+const std::size_t code_length         = 255;
+const std::size_t fec_length          =  32;
+const std::size_t data_length         = code_length - fec_length;
+// Bit i: coefficient of x^i of the primitive polynomial of the field
+constexpr std::uint32_t primitive_polynomial = schifra::galois::primitive_polynomial_bits( schifra::galois::primitive_polynomial06, schifra::galois::primitive_polynomial_size06 );
+
+// The field and the generator polynomial of the code, computed at compile time
+typedef schifra::galois::static_field<field_descriptor,primitive_polynomial> static_field_t;
+typedef schifra::galois::static_generator<static_field_t,gen_poly_index,gen_poly_root_count> static_generator_t;
+static_assert( static_field_t::size == code_length, "the codewords are the size of the field" );
+
+typedef schifra::reed_solomon::batch_encoder<code_length,fec_length> encoder_t;
+typedef schifra::reed_solomon::segment_encoder<code_length,fec_length> segment_encoder_t;
+typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length> decoder_t;
+typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length> syndrome_t;
+typedef schifra::reed_solomon::segment_decoder<code_length,fec_length> segment_decoder_t;
+typedef schifra::reed_solomon::segment_verifier<code_length,fec_length> segment_verifier_t;
+typedef schifra::reed_solomon::interleaved_segment_encoder<code_length,fec_length> interleaved_encoder_t;
+typedef schifra::reed_solomon::interleaved_segment_decoder<code_length,fec_length> interleaved_decoder_t;
+typedef schifra::reed_solomon::interleaved_segment_verifier<code_length,fec_length> interleaved_verifier_t;
+typedef schifra::reed_solomon::crc_index<code_length,fec_length> crc_index_t;
+typedef schifra::reed_solomon::codeword_range<data_length> codeword_range_t;
+typedef schifra::reed_solomon::ecc_header tHeader;
+typedef schifra::reed_solomon::sector_reader tSectorReader;
+typedef schifra::reed_solomon::unreadable_erasures<code_length,fec_length> unreadable_erasures_t;
+
+typedef schifra::reed_solomon::segment_chunk tChunk;
+typedef schifra::reed_solomon::segment_pipeline tPipeline;
+typedef schifra::reed_solomon::work_stealing_pool tPool;
+
+// Default memory budget for all the chunks of the pipeline (can be changed with --memory)
+const std::uint64_t default_memory_budget = 256 * 1024 * 1024;
+// Upper bound of a chunk, to keep enough ranges in flight for all the workers
+const std::size_t max_chunk_block_count = 64 * 1024;
+// Chunks of the pipeline: read ahead + 2 being processed + write behind
+const std::size_t pipeline_chunk_count = 4;
+// Codewords handed out to a worker at once
+const std::size_t range_block_count = 4 * 1024;
+// Codewords of a group of the interleaved layout (a chunk and a range are whole groups)
+const std::size_t interleave_group_block_count = interleaved_encoder_t::group_block_count;
+static_assert( range_block_count % interleave_group_block_count == 0, "a range must hold whole interleaved groups" );
 
 //---
 
@@ -54,153 +127,1857 @@ get_current_time()
     int minutes = local->tm_min;         // get minutes passed after the hour (0-59)
     int seconds = local->tm_sec;         // get seconds passed after minute (0-59)
 
-    char buffer[100];
-    sprintf( buffer, "[%02d:%02d:%02d]", hours, minutes, seconds );
+    char buffer[100];
+    sprintf( buffer, "[%02d:%02d:%02d]", hours, minutes, seconds );
+
+    return buffer;
+}
+
+enum LogLevel: uint8_t
+{
+    DEBUG,  // -v -v -v
+    TRACE,  // -v -v
+    INFO,   // -v
+    WARNING,// no -v
+    ERROR,
+    NONE,
+};
+
+static LogLevel sgCurrentLogLevel = WARNING;
+static std::mutex sgLogMutex; // The pipelines of a batch log from several threads
+static std::ostream* sgLogStream = &std::cout; // The standard error when the decoded data goes to the standard output
+
+void
+SetLogLevel( int iVerbose )
+{
+    switch( iVerbose )
+    {
+        case -1: sgCurrentLogLevel = NONE; break;
+        case 0: sgCurrentLogLevel = WARNING; break;
+        case 1: sgCurrentLogLevel = INFO; break;
+        case 2: sgCurrentLogLevel = TRACE; break;
+        case 3: sgCurrentLogLevel = DEBUG; break;
+        default: sgCurrentLogLevel = DEBUG; break;
+    }
+}
+
+void
+Log( LogLevel iLogLevel, const std::string& iString )
+{
+    if( iLogLevel < sgCurrentLogLevel )
+        return;
+
+    std::lock_guard<std::mutex> lock( sgLogMutex );
+    *sgLogStream << get_current_time() << " " << iString << std::endl;
+}
+
+//---
+
+bool
+WriteExactly( std::ofstream& iStream, const char* iBuffer, std::size_t iSize )
+{
+    iStream.write( iBuffer, static_cast<std::streamsize>( iSize ) );
+    return !iStream.fail();
+}
+
+bool
+WriteExactly( std::ofstream& iStream, const std::vector<char>& iBuffer )
+{
+    return WriteExactly( iStream, iBuffer.data(), iBuffer.size() );
+}
+
+// The decoded data on the standard output ('-o -')
+const std::string standard_output_name = "-";
+
+// Write to the standard output, unbuffered: each chunk reaches the reader (gpg -d) as soon as it's decoded
+bool
+WriteToStandardOutput( const char* iBuffer, std::size_t iSize )
+{
+    const char* data = iBuffer;
+    std::size_t remaining = iSize;
+    while( remaining )
+    {
+        const ssize_t written = write( STDOUT_FILENO, data, remaining );
+        if( written < 0 && errno == EINTR )
+            continue;
+        if( written <= 0 )
+            return false;
+
+        data += written;
+        remaining -= std::size_t( written );
+    }
+
+    return true;
+}
+
+/*
+    A pipe as big as the system allows (up to a chunk): the writer hands a whole chunk
+    in a few calls while the reader consumes the previous one. A reader which exits early
+    (gpg failing) gives a write error instead of killing the process with SIGPIPE.
+*/
+void
+SetupStandardOutput( std::size_t iChunkSize )
+{
+    std::signal( SIGPIPE, SIG_IGN );
+
+    struct stat status;
+    if( fstat( STDOUT_FILENO, &status ) != 0 || !S_ISFIFO( status.st_mode ) )
+        return;
+
+    int pipe_size = int( std::min<std::size_t>( iChunkSize, 1 << 30 ) );
+    std::ifstream max_size_stream( "/proc/sys/fs/pipe-max-size" );
+    int max_size = 0;
+    if( max_size_stream >> max_size && max_size > 0 )
+        pipe_size = std::min( pipe_size, max_size );
+
+    fcntl( STDOUT_FILENO, F_SETPIPE_SZ, pipe_size );
+}
+
+// Posix file closed at the end of the scope (the in place writes of repair)
+struct scoped_file
+{
+    explicit scoped_file( int iFile )
+    : mFile( iFile )
+    {
+    }
+
+    ~scoped_file()
+    {
+        if( mFile >= 0 )
+            close( mFile );
+    }
+
+    scoped_file( const scoped_file& ) = delete;
+    scoped_file& operator=( const scoped_file& ) = delete;
+
+    const int mFile;
+};
+
+// Number of codewords per chunk, so that all the chunks of the pool fit inside the memory budget (at least a group with an interleaved file)
+std::size_t
+ComputeChunkBlockCount( std::uint64_t iMemoryBudget, std::size_t iChunkCount, std::size_t iBytesPerBlock, bool iInterleaved = false )
+{
+    std::uint64_t block_count = iMemoryBudget / ( std::uint64_t( iChunkCount ) * iBytesPerBlock );
+    block_count = std::clamp<std::uint64_t>( block_count, 1, max_chunk_block_count );
+
+    if( iInterleaved )
+        block_count = ( block_count + interleave_group_block_count - 1 ) / interleave_group_block_count * interleave_group_block_count;
+
+    return std::size_t( block_count );
+}
+
+// One worker per range of codewords, up to the number of cores (a small file doesn't need all of them)
+std::size_t
+ComputeThreadCount( std::uint64_t iBlockCount )
+{
+    const std::uint64_t range_count = ( iBlockCount + range_block_count - 1 ) / range_block_count;
+
+    return std::size_t( std::clamp<std::uint64_t>( range_count, 1, std::max( 1u, std::thread::hardware_concurrency() ) ) );
+}
+
+void
+LogPoolUsage( const tPool& iPool )
+{
+    for( std::size_t i = 0; i < iPool.thread_count(); i++ )
+    {
+        char busy_time[32];
+        std::snprintf( busy_time, sizeof( busy_time ), "%.3f", iPool.busy_time( i ) );
+        Log( TRACE, "Worker " + std::to_string( i ) + ": busy " + busy_time + "s, " + std::to_string( iPool.task_count( i ) ) + " range(s)" );
+    }
+}
+
+// Size of the parity records of a data file (without the header of the ecc file)
+std::uint64_t
+EccRecordsSize( std::uint64_t iDataSize, bool iCrcIndex )
+{
+    const std::uint64_t block_count = ( iDataSize + data_length - 1 ) / data_length;
+
+    return block_count * ( iCrcIndex ? crc_index_t::record_length : fec_length );
+}
+
+// Layout of a headerless ecc file from the sizes: parity only, or parity + crc index (false: the sizes don't match)
+bool
+FindEccLayout( std::uint64_t iDataSize, std::uint64_t iEccSize, bool& oCrcIndex )
+{
+    oCrcIndex = iDataSize && iEccSize == EccRecordsSize( iDataSize, true );
+
+    return oCrcIndex || iEccSize == EccRecordsSize( iDataSize, false );
+}
+
+// Read the parity of the codewords of a chunk, and their crc when the ecc file has a crc index (the unreadable sectors are zero filled)
+bool
+ReadEcc( tSectorReader& iReader, bool iCrcIndex, tChunk& ioChunk, std::vector<char>& ioRecords, std::vector<schifra::reed_solomon::unreadable_range>& ioUnreadable )
+{
+    ioChunk.mCrcs.resize( iCrcIndex ? ioChunk.mBlockCount : 0 );
+    if( !iCrcIndex )
+        return iReader.read( ioChunk.mEcc.data(), ioChunk.mEcc.size(), ioUnreadable );
+
+    ioRecords.resize( ioChunk.mBlockCount * crc_index_t::record_length );
+    if( !iReader.read( ioRecords.data(), ioRecords.size(), ioUnreadable ) )
+        return false;
+
+    crc_index_t::split( ioRecords.data(), ioChunk.mBlockCount, ioChunk.mEcc.data(), ioChunk.mCrcs.data() );
+    return true;
+}
+
+// Write the parity of the codewords of a chunk, merged with their crc when the ecc file has a crc index
+bool
+WriteEcc( std::ofstream& iStream, const tChunk& iChunk, std::vector<char>& ioRecords )
+{
+    if( iChunk.mCrcs.empty() )
+        return WriteExactly( iStream, iChunk.mEcc );
+
+    ioRecords.resize( iChunk.mBlockCount * crc_index_t::record_length );
+    crc_index_t::merge( iChunk.mEcc.data(), iChunk.mCrcs.data(), iChunk.mBlockCount, ioRecords.data() );
+    return WriteExactly( iStream, ioRecords );
+}
+
+//---
+
+// A file of the batch (a single file action is a batch of one)
+struct file_job
+{
+    std::string   mDataFile;              // Input data file
+    std::string   mEccFile;               // Output of encode, input of decode + verify
+    bool          mCrcIndex = false;      // The ecc file stores the crc of every codeword after its parity
+    bool          mInterleaved = false;   // The codewords are spread over the sectors (see sector_interleaver)
+    bool          mEccLayoutFound = false;// Decode + verify: the header (or the size) of the ecc file matches the data file
+    std::uint64_t mEccOffset = 0;         // Size of the header of the ecc file (0: a headerless ecc file)
+    tHeader       mEccHeader;             // Decode + verify: the header read from the ecc file
+    bool          mEccHeaderDamaged = false;
+    std::string   mOutputFile;            // Output of decode
+    bool          mRange = false;         // Decode: only the bytes [mRangeOffset, mRangeOffset + mRangeLength) (clamped to the data file)
+    std::uint64_t mRangeOffset = 0;
+    std::uint64_t mRangeLength = 0;
+    std::uint64_t mDataSize = 0;
+    bool          mError = false;         // The file could not be processed
+    std::uint64_t mFailedBlocks = 0;      // Decode: codewords which could not be corrected
+    std::uint64_t mCorruptedBlocks = 0;   // Verify
+    std::uint64_t mUncorrectableBlocks = 0;
+    std::string   mHashFile;              // sha512sum file: output of encode, input of verify (empty: not hashed)
+    std::string   mExpectedHash;          // Verify: digest read from the hash file (or the header of the ecc file)
+    std::string   mHash;                  // Digest computed while reading the data file
+};
+
+/*
+    Read the data of a chunk, and its ecc records for decode, verify and repair.
+
+    A bad sector doesn't stop the read: its bytes are zero filled (see sector_reader) and become
+    the erasures of their codewords, which are then corrected up to fec_length unreadable symbols
+    instead of fec_length / 2 unknown ones. Without the records (encode), an unreadable sector
+    fails the read: its parity would be computed from zeros.
+*/
+bool
+ReadChunk( tSectorReader& ioDataReader, tSectorReader* ioEccReader, const file_job& iJob, tChunk& ioChunk, std::vector<char>& ioRecords, const std::string& iFunction )
+{
+    std::vector<schifra::reed_solomon::unreadable_range> unreadable_data;
+    std::vector<schifra::reed_solomon::unreadable_range> unreadable_ecc;
+    ioChunk.mErasures.clear();
+
+    if( !ioDataReader.read( ioChunk.mData.data(), ioChunk.mData.size(), unreadable_data ) || ( ioEccReader && !ReadEcc( *ioEccReader, iJob.mCrcIndex, ioChunk, ioRecords, unreadable_ecc ) ) )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: short read on input files: " + iJob.mDataFile + ( ioEccReader ? " + " + iJob.mEccFile : "" ) );
+        return false;
+    }
+
+    auto log = [&]( const std::vector<schifra::reed_solomon::unreadable_range>& iRanges, const std::string& iFile )
+    {
+        for( const auto& range : iRanges )
+            Log( ioEccReader ? WARNING : ERROR, "Unreadable bytes " + std::to_string( range.mOffset ) + "-" + std::to_string( range.mOffset + range.mSize - 1 ) + ( ioEccReader ? " (zero filled, erased): " : ": " ) + iFile );
+    };
+    log( unreadable_data, iJob.mDataFile );
+    log( unreadable_ecc, iJob.mEccFile );
+
+    if( !ioEccReader )
+        return unreadable_data.empty();
+
+    const std::uint64_t group_block_count = iJob.mInterleaved ? interleave_group_block_count : 1;
+    for( const auto& range : unreadable_data )
+        unreadable_erasures_t::data( range, iJob.mDataSize, group_block_count, ioChunk.mErasures );
+    for( const auto& range : unreadable_ecc )
+        unreadable_erasures_t::records( range, iJob.mEccOffset, iJob.mDataSize, group_block_count, iJob.mCrcIndex ? crc_index_t::record_length : fec_length, ioChunk.mErasures );
+    unreadable_erasures_t::sort( ioChunk.mErasures );
+
+    return true;
+}
+
+/*
+    Sequential reader of the files of a batch, for one pipeline.
+
+    The files are cut into chunks one after the other (a chunk never spans two files),
+    so the next file is already being read while the workers process the end of the
+    previous one. An empty file still gets one empty chunk, to create its output.
+    A file which can't be opened (or whose ecc file doesn't match) is skipped, the records of
+    an ecc file are read after its header.
+*/
+class batch_reader
+{
+public:
+
+    batch_reader( std::vector<file_job>& ioJobs, const std::vector<std::size_t>& iFiles, std::size_t iChunkBlockCount, bool iReadEcc, bool iOutput, const std::string& iFunction )
+    : mJobs( ioJobs ),
+      mFiles( iFiles ),
+      mChunkBlockCount( iChunkBlockCount ),
+      mReadEcc( iReadEcc ),
+      mOutput( iOutput ),
+      mFunction( iFunction )
+    {
+    }
+
+    tPipeline::eReadStatus operator()( tChunk& ioChunk )
+    {
+        while( !mFileStarted || ( !mRemainingSize && !mFirstChunk ) )
+        {
+            if( mNextFile == mFiles.size() )
+                return tPipeline::eReadStatus::kEnd;
+
+            mFileStarted = OpenFile( mFiles[mNextFile++] );
+        }
+
+        file_job& job = mJobs[mCurrentFile];
+
+        const std::size_t size = std::size_t( std::min<std::uint64_t>( mRemainingSize, mChunkBlockCount * data_length ) );
+        const std::size_t block_count = ( size + data_length - 1 ) / data_length;
+
+        ioChunk.mFile = mCurrentFile;
+        ioChunk.mFirstBlock = mNextBlock;
+        ioChunk.mBlockCount = block_count;
+        ioChunk.mData.resize( size );
+        ioChunk.mEcc.resize( block_count * fec_length );
+        ioChunk.mOutput.resize( mOutput ? size : 0 );
+        ioChunk.mCrcs.resize( job.mCrcIndex ? block_count : 0 );
+        if( !ReadChunk( mDataReader, mReadEcc ? &mEccReader : nullptr, job, ioChunk, mRecords, mFunction ) )
+        {
+            job.mError = true;
+            return tPipeline::eReadStatus::kError;
+        }
+
+        mFirstChunk = false;
+        mRemainingSize -= size;
+        mNextBlock += mChunkBlockCount;
+
+        return tPipeline::eReadStatus::kChunk;
+    }
+
+private:
+
+    bool OpenFile( std::size_t iFile )
+    {
+        file_job& job = mJobs[iFile];
+
+        if( !mDataReader.open( job.mDataFile ) )
+        {
+            Log( ERROR, "reed_solomon::" + mFunction + "() - Error: input file could not be opened: " + job.mDataFile );
+            job.mError = true;
+            return false;
+        }
+
+        job.mDataSize = schifra::fileio::file_size( job.mDataFile );
+
+        // A range is decoded from the codewords covering it: their data and their records only
+        const codeword_range_t range( job.mRange ? job.mRangeOffset : 0, job.mRange ? job.mRangeLength : job.mDataSize, job.mDataSize, job.mInterleaved ? interleave_group_block_count : 1 );
+        mDataReader.seek( range.data_offset );
+
+        if( mReadEcc )
+        {
+            // The layout was read before the pipeline started (an error is already reported)
+            if( !job.mEccLayoutFound )
+            {
+                job.mError = true;
+                return false;
+            }
+
+            const std::uint64_t record_length = job.mCrcIndex ? crc_index_t::record_length : fec_length;
+            if( !mEccReader.open( job.mEccFile ) )
+            {
+                Log( ERROR, "reed_solomon::" + mFunction + "() - Error: input file could not be opened: " + job.mEccFile );
+                job.mError = true;
+                return false;
+            }
+            mEccReader.seek( job.mEccOffset + range.first_block * record_length );
+        }
+
+        mCurrentFile = iFile;
+        mRemainingSize = range.data_size;
+        mNextBlock = range.first_block;
+        mFirstChunk = true;
+
+        return true;
+    }
+
+    std::vector<file_job>&          mJobs;
+    const std::vector<std::size_t>& mFiles;
+    const std::size_t               mChunkBlockCount;
+    const bool                      mReadEcc;
+    const bool                      mOutput;
+    const std::string               mFunction;
+
+    std::size_t                     mNextFile = 0;      // In mFiles
+    std::size_t                     mCurrentFile = 0;   // In mJobs
+    bool                            mFileStarted = false;
+    bool                            mFirstChunk = false;
+    tSectorReader                   mDataReader;
+    tSectorReader                   mEccReader;
+    std::vector<char>               mRecords;           // Ecc records of a chunk, with a crc index
+    std::uint64_t                   mRemainingSize = 0;
+    std::uint64_t                   mNextBlock = 0;
+};
+
+// Encode: a hash file to write, verify: a digest to check (from the hash file or the header of the ecc file)
+bool
+IsHashed( const file_job& iJob )
+{
+    return iJob.mHashFile.length() || iJob.mExpectedHash.length();
+}
+
+/*
+    SHA-512 of the files of a batch, fed by the hasher stage of the pipeline (in file order).
+
+    The digest of a file is complete when the first chunk of the next file arrives, the one
+    of the last file when the pipeline succeeded (after a failure, the hasher stops being
+    called and the pending digest is dropped).
+*/
+class batch_hasher
+{
+public:
+
+    explicit batch_hasher( std::vector<file_job>& ioJobs )
+    : mJobs( ioJobs )
+    {
+    }
+
+    void operator()( const tChunk& iChunk )
+    {
+        file_job* job = &mJobs[iChunk.mFile];
+        if( job != mCurrent )
+        {
+            finish();
+            mCurrent = IsHashed( *job ) ? job : nullptr;
+        }
+
+        if( mCurrent )
+            mHash.update( iChunk.mData.data(), iChunk.mData.size() );
+    }
+
+    void finish()
+    {
+        if( mCurrent )
+            mCurrent->mHash = mHash.hex_digest();
+        mCurrent = nullptr;
+    }
+
+    // There is nothing to hash when no file of the pipeline has a hash file (no hasher thread then)
+    static bool needed( const std::vector<file_job>& iJobs, const std::vector<std::size_t>& iFiles )
+    {
+        for( const auto file : iFiles )
+        {
+            if( IsHashed( iJobs[file] ) )
+                return true;
+        }
+
+        return false;
+    }
+
+private:
+
+    std::vector<file_job>& mJobs;
+    file_job*              mCurrent = nullptr;
+    schifra::sha512        mHash;
+};
+
+// Same layout as hash-create.sh: 'sha512/<input>.sha512'
+std::string
+HashFilePath( const std::string& iDataFile )
+{
+    return ( std::filesystem::path( "sha512" ) / ( iDataFile + ".sha512" ) ).string();
+}
+
+// Same line as sha512sum (a name with a backslash or a newline is escaped, and the line starts with a backslash)
+bool
+WriteHashFile( const file_job& iJob )
+{
+    std::string name;
+    for( const char c : iJob.mDataFile )
+        name += c == '\\' ? "\\\\" : c == '\n' ? "\\n" : std::string( 1, c );
+    const bool escaped = name.length() != iJob.mDataFile.length();
+
+    std::error_code error;
+    std::filesystem::create_directories( std::filesystem::path( iJob.mHashFile ).parent_path(), error );
+
+    std::ofstream hash_stream( iJob.mHashFile.c_str(), std::ios::trunc );
+    hash_stream << ( escaped ? "\\" : "" ) << iJob.mHash << "  " << name << "\n";
+    hash_stream.close();
+    if( hash_stream.fail() )
+    {
+        Log( ERROR, "reed_solomon::EncodeFile() - Error: hash file could not be written: " + iJob.mHashFile );
+        return false;
+    }
+
+    Log( INFO, "Hashed: " + iJob.mDataFile + " -> " + iJob.mHashFile );
+    return true;
+}
+
+// The digest of the first line of a sha512sum file
+bool
+ReadHashFile( const std::string& iHashFile, std::string& oHash )
+{
+    std::ifstream hash_stream( iHashFile.c_str() );
+    std::string line;
+    if( !hash_stream || !std::getline( hash_stream, line ) )
+        return false;
+
+    const std::size_t start = line.length() && line[0] == '\\' ? 1 : 0;
+    oHash = line.substr( start, 2 * schifra::sha512::digest_size );
+
+    return oHash.length() == 2 * schifra::sha512::digest_size && oHash.find_first_not_of( "0123456789abcdef" ) == std::string::npos;
+}
+
+//---
+
+// The header of the ecc file of a job: the code of this executable, the size + mtime (+ hash) of the data file
+tHeader
+MakeEccHeader( const file_job& iJob )
+{
+    tHeader header;
+    header.mLayout = iJob.mCrcIndex ? tHeader::e_layout_crc_index : iJob.mInterleaved ? tHeader::e_layout_interleaved : tHeader::e_layout_parity;
+    header.mFieldDescriptor = field_descriptor;
+    header.mPrimitivePolynomial = primitive_polynomial;
+    header.mGenPolyIndex = gen_poly_index;
+    header.mCodeLength = code_length;
+    header.mFecLength = fec_length;
+    header.mSourceSize = iJob.mDataSize;
+
+    struct stat status;
+    if( stat( iJob.mDataFile.c_str(), &status ) == 0 )
+    {
+        header.mSourceMtime = status.st_mtim.tv_sec;
+        header.mSourceMtimeNsec = std::uint32_t( status.st_mtim.tv_nsec );
+    }
+
+    if( iJob.mHash.length() )
+        header.set_hex_hash( iJob.mHash );
+
+    return header;
+}
+
+bool
+WriteEccHeader( std::ostream& iStream, const tHeader& iHeader )
+{
+    std::vector<char> bytes( tHeader::header_size );
+    iHeader.write( bytes.data() );
+
+    iStream.write( bytes.data(), static_cast<std::streamsize>( bytes.size() ) );
+    return !iStream.fail();
+}
+
+// The header of an ecc file (false: a headerless ecc file, or all the copies of its header destroyed)
+bool
+ReadEccHeader( const std::string& iEccFile, tHeader& oHeader, std::size_t& oDamagedCopies )
+{
+    std::vector<char> bytes( tHeader::header_size );
+    std::ifstream ecc_stream( iEccFile.c_str(), std::ios::binary );
+    ecc_stream.read( bytes.data(), static_cast<std::streamsize>( bytes.size() ) );
+
+    return oHeader.read( bytes.data(), std::size_t( ecc_stream.gcount() ), oDamagedCopies );
+}
+
+// The data file is still the one its ecc file was created for (same size and mtime)
+bool
+IsSameSource( const tHeader& iHeader, const std::string& iDataFile )
+{
+    struct stat status;
+    return stat( iDataFile.c_str(), &status ) == 0
+        && std::uint64_t( status.st_size ) == iHeader.mSourceSize
+        && status.st_mtim.tv_sec == iHeader.mSourceMtime
+        && std::uint32_t( status.st_mtim.tv_nsec ) == iHeader.mSourceMtimeNsec;
+}
+
+/*
+    Layout of the ecc file of a job, from its header: the code must be the one of this executable
+    and the data file must have the recorded size (a different mtime is only reported).
+    A headerless ecc file, or one whose header copies are all destroyed, gets it from its size
+    (refused when the size fits both).
+*/
+bool
+ReadEccLayout( file_job& ioJob, const std::string& iFunction )
+{
+    std::error_code error;
+    ioJob.mDataSize = std::filesystem::file_size( ioJob.mDataFile, error );
+    const std::uint64_t ecc_size = error ? 0 : std::filesystem::file_size( ioJob.mEccFile, error );
+    if( error )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: input files could not be opened: " + ioJob.mDataFile + " + " + ioJob.mEccFile );
+        return false;
+    }
+
+    std::size_t damaged_copies = 0;
+    if( !ReadEccHeader( ioJob.mEccFile, ioJob.mEccHeader, damaged_copies ) )
+    {
+        ioJob.mEccHeader = tHeader();
+
+        bool crc_index = false;
+        bool crc_index_after_header = false;
+        const bool headerless = FindEccLayout( ioJob.mDataSize, ecc_size, crc_index );
+        // The records after a destroyed header are still good
+        const bool after_header = ecc_size >= tHeader::header_size && FindEccLayout( ioJob.mDataSize, ecc_size - tHeader::header_size, crc_index_after_header );
+
+        // 1024 codewords: the crc index of a headerless ecc file is as big as a header + the parities (36 * 1024 = 4096 + 32 * 1024)
+        if( headerless && after_header )
+        {
+            Log( ERROR, "reed_solomon::" + iFunction + "() - Error: ecc file size " + std::to_string( ecc_size ) + " is ambiguous (headerless with a crc index, or a destroyed header), its layout can't be found: " + ioJob.mEccFile );
+            return false;
+        }
+
+        if( headerless )
+        {
+            ioJob.mCrcIndex = crc_index;
+            ioJob.mEccOffset = 0;
+            return ioJob.mEccLayoutFound = true;
+        }
+
+        if( after_header )
+        {
+            ioJob.mCrcIndex = crc_index_after_header;
+            Log( WARNING, "Header of the ecc file could not be read, its layout is found from its size: " + ioJob.mEccFile );
+            ioJob.mEccOffset = tHeader::header_size;
+            ioJob.mEccHeaderDamaged = true;
+            return ioJob.mEccLayoutFound = true;
+        }
+
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: ecc file size " + std::to_string( ecc_size ) + " doesn't match data file size " + std::to_string( ioJob.mDataSize ) + ": " + ioJob.mDataFile );
+        return false;
+    }
+
+    const tHeader& header = ioJob.mEccHeader;
+    if( header.mVersion > tHeader::current_version || header.mLayout > tHeader::e_layout_interleaved )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: ecc file version " + std::to_string( header.mVersion ) + " (layout " + std::to_string( header.mLayout ) + ") not supported: " + ioJob.mEccFile );
+        return false;
+    }
+
+    if( header.mFieldDescriptor != field_descriptor || header.mPrimitivePolynomial != primitive_polynomial || header.mGenPolyIndex != gen_poly_index || header.mCodeLength != code_length || header.mFecLength != fec_length )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: ecc file created with another code (" + std::to_string( header.mCodeLength ) + "-" + std::to_string( header.mFecLength ) + "-" + std::to_string( header.mFieldDescriptor ) + "): " + ioJob.mEccFile );
+        return false;
+    }
+
+    if( header.mSourceSize != ioJob.mDataSize )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: data file size " + std::to_string( ioJob.mDataSize ) + " doesn't match the size in the ecc header " + std::to_string( header.mSourceSize ) + ": " + ioJob.mDataFile );
+        return false;
+    }
+
+    ioJob.mCrcIndex = header.mLayout == tHeader::e_layout_crc_index;
+    ioJob.mInterleaved = header.mLayout == tHeader::e_layout_interleaved;
+    ioJob.mEccOffset = header.mHeaderSize;
+    if( ecc_size != ioJob.mEccOffset + EccRecordsSize( ioJob.mDataSize, ioJob.mCrcIndex ) )
+    {
+        Log( ERROR, "reed_solomon::" + iFunction + "() - Error: ecc file size " + std::to_string( ecc_size ) + " doesn't match its header (truncated?): " + ioJob.mEccFile );
+        return false;
+    }
+
+    if( damaged_copies )
+    {
+        Log( WARNING, "Header of the ecc file - " + std::to_string( damaged_copies ) + " damaged copie(s) of " + std::to_string( tHeader::copy_count ) + ": " + ioJob.mEccFile );
+        ioJob.mEccHeaderDamaged = true;
+    }
+
+    if( !IsSameSource( header, ioJob.mDataFile ) )
+        Log( INFO, "Data file modified since its ecc file was created (mtime): " + ioJob.mDataFile );
+
+    return ioJob.mEccLayoutFound = true;
+}
+
+//---
+
+// Total number of codewords of the files of the batch (to size the pool)
+std::uint64_t
+ComputeBatchBlockCount( const std::vector<file_job>& iJobs )
+{
+    std::uint64_t block_count = 0;
+    for( const auto& job : iJobs )
+    {
+        std::error_code error;
+        const std::uint64_t size = std::filesystem::file_size( job.mDataFile, error );
+        if( !error )
+            block_count += job.mRange ? codeword_range_t( job.mRangeOffset, job.mRangeLength, size, job.mInterleaved ? interleave_group_block_count : 1 ).block_count : ( size + data_length - 1 ) / data_length;
+    }
+
+    return block_count;
+}
+
+// One interleaved file is enough to cut all the chunks of a pipeline on group boundaries
+bool
+HasInterleavedFile( const std::vector<file_job>& iJobs, const std::vector<std::size_t>& iFiles )
+{
+    return std::any_of( iFiles.begin(), iFiles.end(), [&]( std::size_t iFile ) { return iJobs[iFile].mInterleaved; } );
+}
+
+/*
+    One pipeline per physical device, each one with its own sequential reader, all of them
+    sharing the pool (reading two files of the same disk concurrently would only make it seek).
+    The memory budget is split between the pipelines.
+*/
+void
+RunPerDevice( const std::vector<file_job>& iJobs, std::uint64_t iMemoryBudget, const std::function<void( const std::vector<std::size_t>&, std::uint64_t )>& iRun )
+{
+    std::map<dev_t, std::vector<std::size_t>> devices;
+    for( std::size_t i = 0; i < iJobs.size(); i++ )
+    {
+        struct stat status;
+        const dev_t device = stat( iJobs[i].mDataFile.c_str(), &status ) == 0 ? status.st_dev : 0;
+        devices[device].push_back( i );
+    }
+
+    if( devices.size() <= 1 )
+    {
+        iRun( devices.size() ? devices.begin()->second : std::vector<std::size_t>(), iMemoryBudget );
+        return;
+    }
+
+    Log( TRACE, "Batch - " + std::to_string( devices.size() ) + " devices read concurrently" );
+
+    const std::uint64_t memory_budget = std::max<std::uint64_t>( iMemoryBudget / devices.size(), 1 );
+
+    std::vector<std::thread> threads;
+    for( const auto& device : devices )
+        threads.push_back( std::thread( [&iRun, &device, memory_budget]{ iRun( device.second, memory_budget ); } ) );
+
+    for( auto& thread : threads )
+        thread.join();
+}
+
+//---
+
+int
+EncodeFiles( const encoder_t& iEncoder, std::vector<file_job>& ioJobs, std::uint64_t iMemoryBudget )
+{
+    tPool pool( ComputeThreadCount( ComputeBatchBlockCount( ioJobs ) ) );
+    std::atomic<bool> pipeline_error { false };
+
+    RunPerDevice( ioJobs, iMemoryBudget, [&]( const std::vector<std::size_t>& iFiles, std::uint64_t iDeviceMemoryBudget )
+    {
+        const std::size_t chunk_count = pipeline_chunk_count;
+        const std::size_t chunk_block_count = ComputeChunkBlockCount( iDeviceMemoryBudget, chunk_count, data_length + fec_length, HasInterleavedFile( ioJobs, iFiles ) );
+
+        Log( TRACE, "Start encoding: " + std::to_string( iFiles.size() ) + " file(s) (" + std::to_string( chunk_count ) + " chunks of " + std::to_string( chunk_block_count * data_length ) + " bytes, " + std::to_string( pool.thread_count() ) + " worker(s))" );
+
+        batch_reader reader( ioJobs, iFiles, chunk_block_count, false, false, "EncodeFile" );
+
+        auto processor = [&]( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+        {
+            const std::size_t start = iFirstBlock * data_length;
+            const std::size_t size = std::min( iBlockCount * data_length, ioChunk.mData.size() - start );
+            if( ioJobs[ioChunk.mFile].mInterleaved )
+                interleaved_encoder_t( iEncoder, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length );
+            else
+                segment_encoder_t( iEncoder, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mCrcs.empty() ? nullptr : ioChunk.mCrcs.data() + iFirstBlock );
+        };
+
+        // The ecc file of a file is created with its first chunk (header first), and closed with the first chunk of the next one
+        std::ofstream ecc_stream;
+        file_job* current = nullptr;
+        std::vector<char> records; // Parity + crc of the codewords of a chunk, with a crc index
+
+        auto close_current = [&]()
+        {
+            if( !current )
+                return true;
+
+            // The digest is known once the whole file is read: the header is written again with it
+            if( current->mHash.length() && ecc_stream.seekp( 0 ) )
+                WriteEccHeader( ecc_stream, MakeEccHeader( *current ) );
+
+            ecc_stream.close();
+            if( ecc_stream.fail() )
+            {
+                Log( ERROR, "reed_solomon::EncodeFile() - Error: write failed on output file: " + current->mEccFile );
+                current->mError = true;
+                return false;
+            }
+
+            Log( INFO, "Encoded: " + current->mDataFile + " -> " + current->mEccFile );
+            return true;
+        };
+
+        auto writer = [&]( const tChunk& iChunk )
+        {
+            if( current != &ioJobs[iChunk.mFile] )
+            {
+                if( !close_current() )
+                    return false;
+
+                current = &ioJobs[iChunk.mFile];
+                ecc_stream.open( current->mEccFile.c_str(), std::ios::binary | std::ios::trunc );
+                if( !ecc_stream || !WriteEccHeader( ecc_stream, MakeEccHeader( *current ) ) )
+                {
+                    Log( ERROR, "reed_solomon::EncodeFile() - Error: output file could not be created: " + current->mEccFile );
+                    current->mError = true;
+                    return false;
+                }
+            }
+
+            if( WriteEcc( ecc_stream, iChunk, records ) )
+                return true;
+
+            Log( ERROR, "reed_solomon::EncodeFile() - Error: write failed on output file: " + current->mEccFile );
+            current->mError = true;
+            return false;
+        };
+
+        // The data is hashed in the same read, the hash files are written once their ecc file is complete
+        batch_hasher hasher( ioJobs );
+
+        tPipeline pipeline( chunk_count, pool, range_block_count );
+        const bool success = pipeline.run( std::ref( reader ), processor, writer, batch_hasher::needed( ioJobs, iFiles ) ? tPipeline::hasher_t( std::ref( hasher ) ) : tPipeline::hasher_t() );
+        if( success )
+            hasher.finish();
+        if( !success || !close_current() )
+        {
+            pipeline_error = true;
+            return;
+        }
+
+        for( const auto file : iFiles )
+        {
+            file_job& job = ioJobs[file];
+            if( !job.mError && job.mHash.length() && !WriteHashFile( job ) )
+                job.mError = true;
+        }
+    } );
+
+    LogPoolUsage( pool );
+
+    if( pipeline_error )
+        return 1;
+
+    for( const auto& job : ioJobs )
+    {
+        if( job.mError )
+            return 1;
+    }
+
+    return 0;
+}
+
+// Read up to iSize bytes of the standard input (less only at its end)
+bool
+ReadStandardInput( char* oBuffer, std::size_t iSize, std::size_t& oRead )
+{
+    oRead = 0;
+    while( oRead < iSize )
+    {
+        const ssize_t count = read( STDIN_FILENO, oBuffer + oRead, iSize - oRead );
+        if( count < 0 && errno == EINTR )
+            continue;
+        if( count < 0 )
+            return false;
+        if( count == 0 )
+            break;
+
+        oRead += std::size_t( count );
+    }
+
+    return true;
+}
+
+/*
+    Encode the data of the standard input while writing it to the data file (encode --tee),
+    so the ecc costs no second read of the data: stdin -> chunk -> (data file + ecc file).
+
+    The pipeline only has chunk_count chunks: when the sinks (disk) are slower than the source,
+    the reader waits for a free chunk and stops reading stdin, which blocks the writer of the
+    stream. The size and mtime of the header are only known once the data file is closed: the
+    header is written again at the end.
+*/
+int
+TeeEncodeFile( const encoder_t& iEncoder, file_job& ioJob, std::uint64_t iMemoryBudget )
+{
+    std::ofstream data_stream( ioJob.mDataFile.c_str(), std::ios::binary | std::ios::trunc );
+    if( !data_stream )
+    {
+        Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: output file could not be created: " + ioJob.mDataFile );
+        return 1;
+    }
+
+    std::ofstream ecc_stream( ioJob.mEccFile.c_str(), std::ios::binary | std::ios::trunc );
+    if( !ecc_stream || !WriteEccHeader( ecc_stream, MakeEccHeader( ioJob ) ) )
+    {
+        Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: output file could not be created: " + ioJob.mEccFile );
+        return 1;
+    }
+
+    const std::size_t chunk_count = pipeline_chunk_count;
+    const std::size_t chunk_block_count = ComputeChunkBlockCount( iMemoryBudget, chunk_count, data_length + fec_length, ioJob.mInterleaved );
+    const std::size_t chunk_data_size = chunk_block_count * data_length;
+
+    // The size of the stream is unknown: all the cores
+    tPool pool( std::max( 1u, std::thread::hardware_concurrency() ) );
+
+    Log( TRACE, "Start encoding: standard input -> " + ioJob.mDataFile + " + " + ioJob.mEccFile + " (" + std::to_string( chunk_count ) + " chunks of " + std::to_string( chunk_data_size ) + " bytes, " + std::to_string( pool.thread_count() ) + " worker(s))" );
+
+    std::uint64_t next_block = 0;
+    bool first_chunk = true; // An empty stream still gets one empty chunk (hashed as such)
+    std::vector<char> records;
+
+    auto reader = [&]( tChunk& ioChunk )
+    {
+        ioChunk.mData.resize( chunk_data_size );
+        std::size_t size = 0;
+        if( !ReadStandardInput( ioChunk.mData.data(), chunk_data_size, size ) )
+        {
+            Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: read failed on the standard input" );
+            return tPipeline::eReadStatus::kError;
+        }
+        if( !size && !first_chunk )
+            return tPipeline::eReadStatus::kEnd;
+
+        const std::size_t block_count = ( size + data_length - 1 ) / data_length;
+
+        ioChunk.mFile = 0;
+        ioChunk.mFirstBlock = next_block;
+        ioChunk.mBlockCount = block_count;
+        ioChunk.mData.resize( size );
+        ioChunk.mEcc.resize( block_count * fec_length );
+        ioChunk.mOutput.clear();
+        ioChunk.mCrcs.resize( ioJob.mCrcIndex ? block_count : 0 );
+
+        first_chunk = false;
+        next_block += chunk_block_count;
+        ioJob.mDataSize += size;
+
+        return tPipeline::eReadStatus::kChunk;
+    };
+
+    auto processor = [&]( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+    {
+        const std::size_t start = iFirstBlock * data_length;
+        const std::size_t size = std::min( iBlockCount * data_length, ioChunk.mData.size() - start );
+        if( ioJob.mInterleaved )
+            interleaved_encoder_t( iEncoder, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length );
+        else
+            segment_encoder_t( iEncoder, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mCrcs.empty() ? nullptr : ioChunk.mCrcs.data() + iFirstBlock );
+    };
+
+    // The data is written through, then its parity
+    auto writer = [&]( const tChunk& iChunk )
+    {
+        if( !WriteExactly( data_stream, iChunk.mData ) )
+        {
+            Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: write failed on output file: " + ioJob.mDataFile );
+            return false;
+        }
+
+        if( !WriteEcc( ecc_stream, iChunk, records ) )
+        {
+            Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: write failed on output file: " + ioJob.mEccFile );
+            return false;
+        }
+
+        return true;
+    };
+
+    std::vector<file_job> jobs( 1, ioJob );
+    batch_hasher hasher( jobs );
+
+    tPipeline pipeline( chunk_count, pool, range_block_count );
+    const bool success = pipeline.run( reader, processor, writer, IsHashed( ioJob ) ? tPipeline::hasher_t( std::ref( hasher ) ) : tPipeline::hasher_t() );
+    LogPoolUsage( pool );
+    if( !success )
+        return 1;
+
+    hasher.finish();
+    ioJob.mHash = jobs[0].mHash;
+
+    data_stream.close();
+    if( data_stream.fail() )
+    {
+        Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: write failed on output file: " + ioJob.mDataFile );
+        return 1;
+    }
+
+    ecc_stream.seekp( 0 );
+    WriteEccHeader( ecc_stream, MakeEccHeader( ioJob ) );
+    ecc_stream.close();
+    if( ecc_stream.fail() )
+    {
+        Log( ERROR, "reed_solomon::TeeEncodeFile() - Error: write failed on output file: " + ioJob.mEccFile );
+        return 1;
+    }
+
+    Log( INFO, "Encoded: standard input -> " + ioJob.mDataFile + " + " + ioJob.mEccFile + " (" + std::to_string( ioJob.mDataSize ) + " bytes)" );
+
+    if( ioJob.mHash.length() && !WriteHashFile( ioJob ) )
+        return 1;
+
+    return 0;
+}
+
+int
+DecodeFiles( const decoder_t& iDecoder, const syndrome_t& iSyndrome, std::vector<file_job>& ioJobs, std::uint64_t iMemoryBudget )
+{
+    tPool pool( ComputeThreadCount( ComputeBatchBlockCount( ioJobs ) ) );
+    std::atomic<bool> pipeline_error { false };
+
+    RunPerDevice( ioJobs, iMemoryBudget, [&]( const std::vector<std::size_t>& iFiles, std::uint64_t iDeviceMemoryBudget )
+    {
+        const std::size_t chunk_count = pipeline_chunk_count;
+        const std::size_t chunk_block_count = ComputeChunkBlockCount( iDeviceMemoryBudget, chunk_count, data_length + fec_length + data_length, HasInterleavedFile( ioJobs, iFiles ) );
+
+        Log( TRACE, "Start decoding: " + std::to_string( iFiles.size() ) + " file(s) (" + std::to_string( chunk_count ) + " chunks of " + std::to_string( chunk_block_count * data_length ) + " bytes, " + std::to_string( pool.thread_count() ) + " worker(s))" );
+
+        batch_reader reader( ioJobs, iFiles, chunk_block_count, true, true, "DecodeFile" );
+
+        auto processor = [&]( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+        {
+            const std::size_t start = iFirstBlock * data_length;
+            const std::size_t size = std::min( iBlockCount * data_length, ioChunk.mData.size() - start );
+            if( ioJobs[ioChunk.mFile].mInterleaved )
+                ioChunk.mFailedBlocks += interleaved_decoder_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mOutput.data() + start, ioChunk.mFirstBlock + iFirstBlock, &ioChunk.mErasures ).failed_blocks();
+            else
+                ioChunk.mFailedBlocks += segment_decoder_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mOutput.data() + start, ioChunk.mFirstBlock + iFirstBlock, ioChunk.mCrcs.empty() ? nullptr : ioChunk.mCrcs.data() + iFirstBlock, &ioChunk.mErasures ).failed_blocks();
+        };
+
+        std::ofstream output_stream;
+        file_job* current = nullptr;
+
+        auto close_current = [&]()
+        {
+            if( !current )
+                return true;
+
+            output_stream.close();
+            if( current->mOutputFile != standard_output_name && output_stream.fail() )
+            {
+                Log( ERROR, "reed_solomon::DecodeFile() - Error: write failed on output file: " + current->mOutputFile );
+                current->mError = true;
+                return false;
+            }
+
+            if( current->mFailedBlocks )
+                Log( ERROR, "Error - " + std::to_string( current->mFailedBlocks ) + " block(s) could not be corrected: " + current->mDataFile );
+            else
+                Log( INFO, "Decoded: " + current->mDataFile + " -> " + current->mOutputFile );
+
+            return true;
+        };
+
+        auto writer = [&]( const tChunk& iChunk )
+        {
+            if( current != &ioJobs[iChunk.mFile] )
+            {
+                if( !close_current() )
+                    return false;
+
+                current = &ioJobs[iChunk.mFile];
+                if( current->mOutputFile == standard_output_name )
+                    SetupStandardOutput( chunk_block_count * data_length );
+                else
+                    output_stream.open( current->mOutputFile.c_str(), std::ios::binary | std::ios::trunc );
+                if( current->mOutputFile != standard_output_name && !output_stream )
+                {
+                    Log( ERROR, "reed_solomon::DecodeFile() - Error: output file could not be created: " + current->mOutputFile );
+                    current->mError = true;
+                    return false;
+                }
+            }
+
+            current->mFailedBlocks += iChunk.mFailedBlocks;
+
+            // A range keeps only its bytes of the codewords covering it
+            std::size_t begin = 0;
+            std::size_t end = iChunk.mOutput.size();
+            if( current->mRange )
+                codeword_range_t( current->mRangeOffset, current->mRangeLength, current->mDataSize ).segment_part( iChunk.mFirstBlock * data_length, iChunk.mOutput.size(), begin, end );
+
+            const char* output = iChunk.mOutput.data() + begin;
+            if( current->mOutputFile == standard_output_name ? WriteToStandardOutput( output, end - begin ) : WriteExactly( output_stream, output, end - begin ) )
+                return true;
+
+            Log( ERROR, "reed_solomon::DecodeFile() - Error: write failed on output file: " + current->mOutputFile );
+            current->mError = true;
+            return false;
+        };
+
+        tPipeline pipeline( chunk_count, pool, range_block_count );
+        if( !pipeline.run( std::ref( reader ), processor, writer ) || !close_current() )
+            pipeline_error = true;
+    } );
+
+    LogPoolUsage( pool );
+
+    if( pipeline_error )
+        return 1;
+
+    for( const auto& job : ioJobs )
+    {
+        if( job.mError || job.mFailedBlocks )
+            return 1;
+    }
+
+    return 0;
+}
+
+// Exit status of the verify action
+enum eVerifyStatus
+{
+    kVerifyClean = 0,           // No corrupted codeword
+    kVerifyError = 1,           // Bad arguments, I/O error, ...
+    kVerifyCorrectable = 2,     // Some codewords are corrupted, all of them can be corrected
+    kVerifyUncorrectable = 3,   // At least one codeword can't be corrected (or the data doesn't match its hash while no codeword is corrupted)
+};
+
+/*
+    For a batch: the worst status of its files (a file not correctable first, then a file not verified).
+    A damaged header copy of an ecc file is correctable (repair rewrites it).
+
+    With --sha512, the data is hashed in the same read. A mismatch with corrupted codewords is
+    expected (the decode restores the data), without any, the ecc can't restore the original data.
+*/
+int
+VerifyFiles( const decoder_t& iDecoder, const syndrome_t& iSyndrome, std::vector<file_job>& ioJobs, std::uint64_t iMemoryBudget )
+{
+    tPool pool( ComputeThreadCount( ComputeBatchBlockCount( ioJobs ) ) );
+    std::atomic<bool> pipeline_error { false };
+
+    RunPerDevice( ioJobs, iMemoryBudget, [&]( const std::vector<std::size_t>& iFiles, std::uint64_t iDeviceMemoryBudget )
+    {
+        const std::size_t chunk_count = pipeline_chunk_count;
+        const std::size_t chunk_block_count = ComputeChunkBlockCount( iDeviceMemoryBudget, chunk_count, data_length + fec_length, HasInterleavedFile( ioJobs, iFiles ) );
+
+        Log( TRACE, "Start verifying: " + std::to_string( iFiles.size() ) + " file(s) (" + std::to_string( chunk_count ) + " chunks of " + std::to_string( chunk_block_count * data_length ) + " bytes, " + std::to_string( pool.thread_count() ) + " worker(s))" );
+
+        batch_reader reader( ioJobs, iFiles, chunk_block_count, true, false, "VerifyFile" );
+
+        auto processor = [&]( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+        {
+            const std::size_t start = iFirstBlock * data_length;
+            const std::size_t size = std::min( iBlockCount * data_length, ioChunk.mData.size() - start );
+
+            std::vector<schifra::reed_solomon::corrupted_block> corrupted;
+            if( ioJobs[ioChunk.mFile].mInterleaved )
+                interleaved_verifier_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, corrupted, ioChunk.mFirstBlock + iFirstBlock, &ioChunk.mErasures );
+            else
+                segment_verifier_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, corrupted, ioChunk.mFirstBlock + iFirstBlock, ioChunk.mCrcs.empty() ? nullptr : ioChunk.mCrcs.data() + iFirstBlock, &ioChunk.mErasures );
+            if( corrupted.empty() )
+                return;
+
+            std::lock_guard<std::mutex> lock( ioChunk.mCorruptedMutex );
+            ioChunk.mCorruptedBlocks.insert( ioChunk.mCorruptedBlocks.end(), corrupted.begin(), corrupted.end() );
+        };
+
+        file_job* current = nullptr;
+
+        auto close_current = [&]()
+        {
+            if( !current )
+                return;
+
+            if( !current->mCorruptedBlocks )
+                Log( INFO, "Verify - no corrupted block: " + current->mDataFile );
+            else
+                Log( WARNING, "Verify - " + std::to_string( current->mCorruptedBlocks ) + " corrupted block(s), " + std::to_string( current->mUncorrectableBlocks ) + " not correctable: " + current->mDataFile );
+        };
+
+        // Nothing is written, the corrupted codewords are reported in file order
+        auto writer = [&]( const tChunk& iChunk )
+        {
+            if( current != &ioJobs[iChunk.mFile] )
+            {
+                close_current();
+                current = &ioJobs[iChunk.mFile];
+            }
+
+            std::vector<schifra::reed_solomon::corrupted_block> corrupted( iChunk.mCorruptedBlocks );
+            std::sort( corrupted.begin(), corrupted.end(), []( const auto& iA, const auto& iB ) { return iA.mIndex < iB.mIndex; } );
+
+            for( const auto& block : corrupted )
+            {
+                std::string bytes;
+                if( current->mInterleaved )
+                {
+                    // A column of its group: one byte every 'group codewords'
+                    const std::uint64_t group_start = block.mIndex / interleave_group_block_count * interleave_group_block_count;
+                    const std::uint64_t group_blocks = std::min<std::uint64_t>( interleave_group_block_count, ( current->mDataSize + data_length - 1 ) / data_length - group_start );
+                    bytes = std::to_string( group_start * data_length + block.mIndex - group_start ) + " + k*" + std::to_string( group_blocks );
+                }
+                else
+                {
+                    const std::uint64_t start = block.mIndex * data_length;
+                    const std::uint64_t end = std::min<std::uint64_t>( start + data_length, current->mDataSize );
+                    bytes = std::to_string( start ) + "-" + std::to_string( end - 1 );
+                }
+                Log( WARNING, "Corrupted block " + std::to_string( block.mIndex ) + " (bytes " + bytes + "): " + ( block.mCorrectable ? "correctable" : "NOT correctable" ) + ( ioJobs.size() > 1 ? ": " + current->mDataFile : "" ) );
+
+                current->mCorruptedBlocks++;
+                if( !block.mCorrectable )
+                    current->mUncorrectableBlocks++;
+            }
+
+            return true;
+        };
+
+        batch_hasher hasher( ioJobs );
+
+        tPipeline pipeline( chunk_count, pool, range_block_count );
+        if( !pipeline.run( std::ref( reader ), processor, writer, batch_hasher::needed( ioJobs, iFiles ) ? tPipeline::hasher_t( std::ref( hasher ) ) : tPipeline::hasher_t() ) )
+            pipeline_error = true;
+        else
+            hasher.finish();
+        close_current();
+
+        for( const auto file : iFiles )
+        {
+            const file_job& job = ioJobs[file];
+            if( !job.mHash.length() )
+                continue;
+
+            if( job.mHash == job.mExpectedHash )
+                Log( INFO, "Verify - sha512 matches: " + job.mDataFile );
+            else
+                Log( WARNING, "Verify - sha512 doesn't match" + std::string( job.mCorruptedBlocks ? "" : " (and no corrupted block)" ) + ": " + job.mDataFile );
+        }
+    } );
+
+    LogPoolUsage( pool );
+
+    bool error = pipeline_error;
+    bool corrupted = false;
+    bool uncorrectable = false;
+    for( const auto& job : ioJobs )
+    {
+        error = error || job.mError;
+        corrupted = corrupted || job.mCorruptedBlocks || job.mEccHeaderDamaged;
+        uncorrectable = uncorrectable || job.mUncorrectableBlocks || ( job.mHash.length() && job.mHash != job.mExpectedHash && !job.mCorruptedBlocks );
+    }
+
+    if( uncorrectable )
+        return kVerifyUncorrectable;
+    if( error )
+        return kVerifyError;
+
+    return corrupted ? kVerifyCorrectable : kVerifyClean;
+}
+
+//---
+
+// Journal of an in place repair, next to the data file
+std::string
+RepairJournalPath( const std::string& iDataFile )
+{
+    return iDataFile + ".repair-journal";
+}
+
+// Rewrite only the corrected codewords of the data file, in place
+int
+RepairFile( const decoder_t& iDecoder, const syndrome_t& iSyndrome, const std::string& iInputDataFile, const std::string& iInputEccFile, std::uint64_t iMemoryBudget )
+{
+    const scoped_file data_file( open( iInputDataFile.c_str(), O_RDWR ) );
+    if( data_file.mFile < 0 )
+    {
+        Log( ERROR, "reed_solomon::RepairFile() - Error: input file could not be opened for writing: " + iInputDataFile );
+        return 1;
+    }
+
+    // The mtime before any write (of this repair or of the replayed journal)
+    struct stat data_status;
+    if( fstat( data_file.mFile, &data_status ) != 0 )
+    {
+        Log( ERROR, "reed_solomon::RepairFile() - Error: input file could not be read: " + iInputDataFile );
+        return 1;
+    }
+
+    // The journal is only created by the first corrected chunk: a repair which fails before leaves none
+    schifra::reed_solomon::repair_journal journal( RepairJournalPath( iInputDataFile ) );
+
+    // Finish the writes of a previous repair before reading the data file
+    std::uint64_t replayed_bytes = 0;
+    if( schifra::reed_solomon::repair_journal::exists( journal.path() ) )
+    {
+        Log( WARNING, "Repair - journal of an interrupted repair found: " + journal.path() );
+
+        if( !journal.open() )
+        {
+            Log( ERROR, "reed_solomon::RepairFile() - Error: journal could not be opened: " + journal.path() );
+            return 1;
+        }
+
+        if( journal.load() && !journal.apply( data_file.mFile, replayed_bytes ) )
+        {
+            Log( ERROR, "reed_solomon::RepairFile() - Error: journal replay failed on file: " + iInputDataFile );
+            return 1;
+        }
+        if( !journal.remove() )
+        {
+            Log( ERROR, "reed_solomon::RepairFile() - Error: journal could not be removed: " + journal.path() );
+            return 1;
+        }
+
+        Log( WARNING, "Repair - " + std::to_string( replayed_bytes ) + " byte(s) replayed from the journal: " + iInputDataFile );
+    }
+
+    tSectorReader data_reader;
+    if( !data_reader.open( iInputDataFile ) )
+    {
+        Log( ERROR, "reed_solomon::RepairFile() - Error: input file could not be opened: " + iInputDataFile );
+        return 1;
+    }
+
+    file_job job;
+    job.mDataFile = iInputDataFile;
+    job.mEccFile = iInputEccFile;
+    if( !ReadEccLayout( job, "RepairFile" ) )
+        return 1;
+
+    tSectorReader ecc_reader;
+    if( !ecc_reader.open( iInputEccFile ) )
+    {
+        Log( ERROR, "reed_solomon::RepairFile() - Error: input file could not be opened: " + iInputEccFile );
+        return 1;
+    }
+    ecc_reader.seek( job.mEccOffset );
+
+    const std::uint64_t data_full_size = job.mDataSize;
+    const std::uint64_t block_count = ( data_full_size + data_length - 1 ) / data_length;
+
+    const std::size_t chunk_count = pipeline_chunk_count;
+    const std::size_t chunk_block_count = ComputeChunkBlockCount( iMemoryBudget, chunk_count, data_length + fec_length + data_length, job.mInterleaved );
+    const std::size_t chunk_data_size = chunk_block_count * data_length;
+
+    std::uint64_t remaining_size = data_full_size;
+    std::uint64_t next_block = 0;
+    std::uint64_t failed_blocks = 0;
+    std::uint64_t corrected_blocks = 0;
+    std::uint64_t rewritten_bytes = 0;
+    bool journal_pending = false;
+    std::vector<char> records;
+
+    tPool pool( ComputeThreadCount( block_count ) );
+
+    Log( TRACE, "Start repairing: " + iInputDataFile + " + " + iInputEccFile + " (" + std::to_string( chunk_count ) + " chunks of " + std::to_string( chunk_data_size ) + " bytes, " + std::to_string( pool.thread_count() ) + " worker(s))" );
+
+    auto reader = [&]( tChunk& ioChunk )
+    {
+        if( !remaining_size )
+            return tPipeline::eReadStatus::kEnd;
+
+        const std::size_t size = std::size_t( std::min<std::uint64_t>( remaining_size, chunk_data_size ) );
+        const std::size_t ecc_size = ( ( size + data_length - 1 ) / data_length ) * fec_length;
+
+        ioChunk.mFirstBlock = next_block;
+        ioChunk.mBlockCount = ecc_size / fec_length;
+        ioChunk.mData.resize( size );
+        ioChunk.mEcc.resize( ecc_size );
+        ioChunk.mOutput.resize( size );
+        if( !ReadChunk( data_reader, &ecc_reader, job, ioChunk, records, "RepairFile" ) )
+            return tPipeline::eReadStatus::kError;
+
+        remaining_size -= size;
+        next_block += chunk_block_count;
+
+        return tPipeline::eReadStatus::kChunk;
+    };
+
+    // Decode the range, then keep the codewords whose data bytes changed (a corrected parity needs no write)
+    auto processor = [&]( tChunk& ioChunk, std::size_t iFirstBlock, std::size_t iBlockCount )
+    {
+        const std::size_t start = iFirstBlock * data_length;
+        const std::size_t size = std::min( iBlockCount * data_length, ioChunk.mData.size() - start );
+        if( job.mInterleaved )
+            ioChunk.mFailedBlocks += interleaved_decoder_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mOutput.data() + start, ioChunk.mFirstBlock + iFirstBlock, &ioChunk.mErasures ).failed_blocks();
+        else
+            ioChunk.mFailedBlocks += segment_decoder_t( iDecoder, iSyndrome, ioChunk.mData.data() + start, size, ioChunk.mEcc.data() + iFirstBlock * fec_length, ioChunk.mOutput.data() + start, ioChunk.mFirstBlock + iFirstBlock, ioChunk.mCrcs.empty() ? nullptr : ioChunk.mCrcs.data() + iFirstBlock, &ioChunk.mErasures ).failed_blocks();
+
+        // With the interleaved layout, the spans of data_length bytes are not codewords, but the merged ranges are the same
+        std::vector<schifra::reed_solomon::corrupted_block> corrected;
+        for( std::size_t i = 0; i < iBlockCount; i++ )
+        {
+            const std::size_t block_start = start + i * data_length;
+            const std::size_t block_size = std::min( data_length, ioChunk.mData.size() - block_start );
+            if( std::memcmp( ioChunk.mData.data() + block_start, ioChunk.mOutput.data() + block_start, block_size ) )
+                corrected.push_back( { ioChunk.mFirstBlock + iFirstBlock + i, true } );
+        }
+        if( corrected.empty() )
+            return;
+
+        std::lock_guard<std::mutex> lock( ioChunk.mCorruptedMutex );
+        ioChunk.mCorruptedBlocks.insert( ioChunk.mCorruptedBlocks.end(), corrected.begin(), corrected.end() );
+    };
+
+    // Contiguous corrected codewords are merged into one range: journal, data file, then clear the journal
+    auto writer = [&]( const tChunk& iChunk )
+    {
+        failed_blocks += iChunk.mFailedBlocks;
+        if( iChunk.mCorruptedBlocks.empty() )
+            return true;
+
+        std::vector<schifra::reed_solomon::corrupted_block> corrected( iChunk.mCorruptedBlocks );
+        std::sort( corrected.begin(), corrected.end(), []( const auto& iA, const auto& iB ) { return iA.mIndex < iB.mIndex; } );
+
+        journal.begin();
+        for( std::size_t i = 0; i < corrected.size(); )
+        {
+            std::size_t end = i + 1;
+            while( end < corrected.size() && corrected[end].mIndex == corrected[end - 1].mIndex + 1 )
+                end++;
+
+            const std::uint64_t start = corrected[i].mIndex * data_length;
+            const std::uint64_t stop = std::min<std::uint64_t>( ( corrected[end - 1].mIndex + 1 ) * data_length, data_full_size );
+            const std::size_t chunk_start = std::size_t( start - iChunk.mFirstBlock * data_length );
+            journal.add( start, iChunk.mOutput.data() + chunk_start, stop - start );
+
+            Log( INFO, "Repair - bytes " + std::to_string( start ) + "-" + std::to_string( stop - 1 ) + " (" + std::to_string( end - i ) + " block(s))" );
+            i = end;
+        }
+
+        std::uint64_t written_bytes = 0;
+        if( !journal.commit() || !journal.apply( data_file.mFile, written_bytes ) || !journal.clear() )
+        {
+            Log( ERROR, "reed_solomon::RepairFile() - Error: write failed on file: " + iInputDataFile + " (the journal will be replayed by the next repair)" );
+            journal_pending = true;
+            return false;
+        }
+
+        corrected_blocks += corrected.size();
+        rewritten_bytes += written_bytes;
+        return true;
+    };
+
+    tPipeline pipeline( chunk_count, pool, range_block_count );
+    const bool success = pipeline.run( reader, processor, writer );
+    LogPoolUsage( pool );
+
+    // Only a transaction which may not be in the data file is kept for the next repair
+    if( !journal_pending )
+        journal.remove();
+    if( !success )
+        return 1;
+
+    if( rewritten_bytes )
+        Log( WARNING, "Repair - " + std::to_string( corrected_blocks ) + " block(s) corrected, " + std::to_string( rewritten_bytes ) + " byte(s) rewritten: " + iInputDataFile );
+    else
+        Log( INFO, "Repair - nothing to rewrite: " + iInputDataFile );
+
+    // The damaged copies of the header are rewritten from an intact one (a destroyed header can't be)
+    if( job.mEccHeaderDamaged && job.mEccHeader.mCodeLength )
+    {
+        std::fstream header_stream( iInputEccFile.c_str(), std::ios::binary | std::ios::in | std::ios::out );
+        if( !header_stream || !WriteEccHeader( header_stream, job.mEccHeader ) || !header_stream.flush() )
+        {
+            Log( ERROR, "reed_solomon::RepairFile() - Error: header could not be rewritten: " + iInputEccFile );
+            return 1;
+        }
+
+        Log( WARNING, "Repair - header rewritten: " + iInputEccFile );
+    }
+
+    if( failed_blocks )
+    {
+        Log( ERROR, "Error - " + std::to_string( failed_blocks ) + " block(s) could not be corrected: " + iInputDataFile );
+        return 1;
+    }
+
+    // The data file is back to the content of its ecc file: its mtime too (the one of the header, else the one before
+    // the repair), or every later encode would report the data file as changed since its ecc file
+    if( rewritten_bytes || replayed_bytes )
+    {
+        struct timespec times[2] = { { 0, UTIME_OMIT }, data_status.st_mtim };
+        if( job.mEccHeader.mCodeLength )
+        {
+            times[1].tv_sec = time_t( job.mEccHeader.mSourceMtime );
+            times[1].tv_nsec = long( job.mEccHeader.mSourceMtimeNsec );
+        }
+
+        if( futimens( data_file.mFile, times ) != 0 )
+            Log( WARNING, "Repair - mtime could not be restored: " + iInputDataFile );
+    }
 
-    return buffer;
+    return 0;
 }
 
-enum LogLevel: uint8_t
+//---
+
+enum class eAction
 {
-    DEBUG,  // -v -v -v
-    TRACE,  // -v -v
-    INFO,   // -v
-    WARNING,// no -v
-    ERROR,
-    NONE,
+    kNone,
+    kEncode,
+    kDecode,
+    kVerify,
+    kRepair,
+    kWatch,
 };
 
-static LogLevel sgCurrentLogLevel = WARNING;
+enum class eArgument
+{
+    kAction,
+    kInputDataFiles,
+    kManifestFile,
+    kBatch,
+    kSha512,
+    kCrcIndex,
+    kInterleave,
+    kTee,
+    kOutputEccFile,
+    kInputEccFile,
+    kOutputDataDecodedFile,
+    kRange,
+    kRangeOffset,
+    kRangeLength,
+    kMemory,
+    kEngine,
+};
 
-void
-SetLogLevel( int iVerbose )
+// Same layout as ecc.py: 'ecc-schifra-255-32-8/<input>.ecc-schifra-255-32-8' and 'ecc-regenerated/<input>.regenerated'
+std::string
+EccDirectoryName()
 {
-    switch( iVerbose )
-    {
-        case -1: sgCurrentLogLevel = NONE; break;
-        case 0: sgCurrentLogLevel = WARNING; break;
-        case 1: sgCurrentLogLevel = INFO; break;
-        case 2: sgCurrentLogLevel = TRACE; break;
-        case 3: sgCurrentLogLevel = DEBUG; break;
-        default: sgCurrentLogLevel = DEBUG; break;
-    }
+    return "ecc-schifra-" + std::to_string( code_length ) + "-" + std::to_string( fec_length ) + "-" + std::to_string( field_descriptor );
 }
 
-void
-Log( LogLevel iLogLevel, const std::string& iString )
+// Same rule as ecc.py (cEccSchifra.IsValidInput): only the encrypted files
+bool
+IsValidBatchInput( const std::filesystem::path& iPath )
 {
-    if( iLogLevel >= sgCurrentLogLevel )
-        std::cout << get_current_time() << " " << iString << std::endl;
+    std::error_code error;
+    return std::filesystem::is_regular_file( iPath, error ) && iPath.extension() == ".gpg";
 }
 
-//---
+/*
+    --sha512: encode writes the hash file of the data file, unless there is already one
+    (as hash-create.sh without -f), verify checks the data file against its hash file.
+*/
+void
+SetupHashFile( eAction iAction, file_job& ioJob )
+{
+    const std::string hash_file = HashFilePath( ioJob.mDataFile );
 
-int
-AllocateEmptyBigChunks( int iBigChunkCount, std::vector<tBigChunk>& oBigChunks )
+    std::error_code error;
+    if( iAction == eAction::kEncode )
+    {
+        if( std::filesystem::file_size( hash_file, error ) > 0 && !error )
+        {
+            Log( INFO, "Skip: hash file already exists: " + hash_file );
+            return;
+        }
+
+        ioJob.mHashFile = hash_file;
+    }
+    else if( iAction == eAction::kVerify )
+    {
+        if( !ReadHashFile( hash_file, ioJob.mExpectedHash ) )
+        {
+            Log( ERROR, "reed_solomon::VerifyFile() - Error: hash file could not be read: " + hash_file );
+            ioJob.mError = true;
+            return;
+        }
+
+        ioJob.mHashFile = hash_file;
+    }
+}
+
+/*
+    The job of a file of a batch: the ecc/output paths follow ecc.py, and so do the skip rules: encode skips
+    the files which already have an ecc file, decode + verify skip the ones which don't have one.
+*/
+bool
+MakeBatchJob( eAction iAction, const std::filesystem::path& iFile, file_job& oJob )
 {
-    for( int i = 0; i < iBigChunkCount; i++ )
+    oJob.mDataFile = iFile.string();
+    oJob.mEccFile = ( std::filesystem::path( EccDirectoryName() ) / ( oJob.mDataFile + "." + EccDirectoryName() ) ).string();
+    oJob.mOutputFile = ( std::filesystem::path( "ecc-regenerated" ) / ( oJob.mDataFile + ".regenerated" ) ).string();
+
+    std::error_code error;
+    const bool ecc_exists = std::filesystem::is_regular_file( oJob.mEccFile, error );
+    if( iAction == eAction::kEncode && ecc_exists )
+    {
+        // Never overwritten, but an ecc file made for another content of the data file is reported
+        tHeader header;
+        std::size_t damaged_copies = 0;
+        if( ReadEccHeader( oJob.mEccFile, header, damaged_copies ) && !IsSameSource( header, oJob.mDataFile ) )
+            Log( WARNING, "Skip: ecc file already exists, but the data file changed since (size or mtime): " + oJob.mEccFile );
+        else
+            Log( INFO, "Skip: ecc file already exists: " + oJob.mEccFile );
+        return false;
+    }
+    if( iAction != eAction::kEncode && !ecc_exists )
     {
-        oBigChunks.push_back( tBigChunk() );
+        Log( INFO, "Skip: ecc file doesn't exists: " + oJob.mEccFile );
+        return false;
     }
 
-    return 0;
+    const std::string& output_file = iAction == eAction::kEncode ? oJob.mEccFile : oJob.mOutputFile;
+    if( iAction != eAction::kVerify )
+        std::filesystem::create_directories( std::filesystem::path( output_file ).parent_path(), error );
+
+    return true;
 }
 
+/*
+    Files of a batch, from directories (walked recursively), files and a manifest (one path per line).
+*/
 int
-AllocateBigChunks( std::size_t iFullSize, std::size_t iBigChunkSize, std::vector<tBigChunk>& oBigChunks )
+CollectBatchFiles( eAction iAction, const std::vector<std::string>& iInputs, const std::string& iManifestFile, std::vector<file_job>& oJobs )
 {
-    // Get size for each data big chunk
-    std::vector<std::size_t> big_chunk_sizes;
-    std::size_t remaining_size = iFullSize;
-    while( remaining_size >= iBigChunkSize )
+    std::vector<std::string> inputs( iInputs );
+    if( iManifestFile.length() )
+    {
+        std::ifstream manifest_stream( iManifestFile.c_str() );
+        if( !manifest_stream )
+        {
+            Log( ERROR, "Error - Manifest file could not be opened: " + iManifestFile );
+            return 1;
+        }
+
+        std::string line;
+        while( std::getline( manifest_stream, line ) )
+        {
+            if( line.length() )
+                inputs.push_back( line );
+        }
+    }
+
+    std::vector<std::filesystem::path> files;
+    bool not_existing_input = false;
+    for( const auto& input : inputs )
     {
-        big_chunk_sizes.push_back( iBigChunkSize );
-        remaining_size -= iBigChunkSize;
+        std::error_code error;
+        if( std::filesystem::is_directory( input, error ) )
+        {
+            std::vector<std::filesystem::path> entries;
+            for( const auto& entry : std::filesystem::recursive_directory_iterator( input, error ) )
+                entries.push_back( entry.path() );
+            std::sort( entries.begin(), entries.end() );
+
+            for( const auto& entry : entries )
+            {
+                if( IsValidBatchInput( entry ) )
+                    files.push_back( entry.lexically_normal() );
+            }
+        }
+        else if( std::filesystem::is_regular_file( input, error ) )
+        {
+            if( IsValidBatchInput( input ) )
+                files.push_back( std::filesystem::path( input ).lexically_normal() );
+        }
+        else
+        {
+            Log( ERROR, "Error - Input doesn't exist: " + input );
+            not_existing_input = true;
+        }
     }
-    if( remaining_size )
-        big_chunk_sizes.push_back( remaining_size );
 
-    assert( remaining_size < iBigChunkSize );
+    if( not_existing_input )
+        return 1;
 
-    // Alocate each big chunk
-    for( auto big_chunk_size : big_chunk_sizes )
+    for( const auto& file : files )
     {
-        oBigChunks.push_back( tBigChunk( big_chunk_size ) );
+        file_job job;
+        if( MakeBatchJob( iAction, file, job ) )
+            oJobs.push_back( job );
     }
 
+    Log( INFO, "Batch - " + std::to_string( oJobs.size() ) + " file(s) to process (" + std::to_string( files.size() - oJobs.size() ) + " skipped)" );
+
     return 0;
 }
 
-int
-ReadFileToChunks( std::string iPathFile, std::vector<tBigChunk>& oBigChunks )
+// Same as ecc.py and hash-create.sh, the created files are left writable by everybody
+void
+SetBatchOutputPermissions( const std::vector<file_job>& iJobs, eAction iAction )
 {
-    std::ifstream in_stream( iPathFile.c_str(), std::ios::binary );
-    if( !in_stream )
+    for( const auto& job : iJobs )
     {
-        Log( ERROR, "reed_solomon::ReadFileToChunks() - Error: input file could not be opened: " + iPathFile );
-        return 1;
+        std::error_code error;
+        std::filesystem::permissions( iAction == eAction::kEncode ? job.mEccFile : job.mOutputFile, std::filesystem::perms::all, error );
+        if( iAction == eAction::kEncode && job.mHashFile.length() )
+            std::filesystem::permissions( job.mHashFile, std::filesystem::perms::all, error );
+    }
+}
+
+//---
+
+// Set by SIGINT/SIGTERM: the watcher encodes the files already closed, then stops
+volatile std::sig_atomic_t sgWatchStop = 0;
+
+void
+StopWatch( int )
+{
+    sgWatchStop = 1;
+}
+
+/*
+    The watcher runs beside duplicity + gpg: the lowest cpu priority and the idle io class.
+    Set before any thread is created, the workers of the pools inherit them.
+*/
+void
+SetBackgroundPriority()
+{
+    if( setpriority( PRIO_PROCESS, 0, 19 ) != 0 )
+        Log( WARNING, "Watch - cpu priority could not be lowered: " + std::string( std::strerror( errno ) ) );
+
+    // No glibc wrapper for ioprio_set(): IOPRIO_WHO_PROCESS + IOPRIO_PRIO_VALUE( IOPRIO_CLASS_IDLE, 0 )
+    const int ioprio_who_process = 1;
+    const int ioprio_class_idle = 3;
+    const int ioprio_class_shift = 13;
+    if( syscall( SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift ) != 0 )
+        Log( WARNING, "Watch - io priority could not be lowered: " + std::string( std::strerror( errno ) ) );
+}
+
+// Watch a directory and its sub directories (the ones created later are added from their event)
+void
+AddWatches( int iNotify, const std::filesystem::path& iDirectory, std::map<int, std::filesystem::path>& ioDirectories )
+{
+    const int watch = inotify_add_watch( iNotify, iDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR | IN_DONT_FOLLOW );
+    if( watch < 0 )
+    {
+        Log( WARNING, "Watch - directory could not be watched: " + iDirectory.string() + " (" + std::strerror( errno ) + ")" );
+        return;
     }
 
-    // Read all big chunks from data input file
-    for( auto& big_chunk : oBigChunks )
+    ioDirectories[watch] = iDirectory;
+
+    std::error_code error;
+    for( const auto& entry : std::filesystem::directory_iterator( iDirectory, error ) )
     {
-        in_stream.read( big_chunk.data(), static_cast<std::streamsize>( big_chunk.size() ) );
+        if( entry.is_directory( error ) && !entry.is_symlink( error ) )
+            AddWatches( iNotify, entry.path().lexically_normal(), ioDirectories );
     }
+}
 
-    in_stream.close();
+/*
+    Read all the pending events: every .gpg file closed after a write (or moved in) becomes a job,
+    with the skip rules of a batch encode (an existing ecc file is never overwritten).
+*/
+void
+ReadWatchEvents( int iNotify, bool iSha512, bool iCrcIndex, bool iInterleaved, std::map<int, std::filesystem::path>& ioDirectories, std::vector<file_job>& oJobs )
+{
+    alignas( inotify_event ) char events[64 * 1024];
 
-    return 0;
+    ssize_t size = 0;
+    while( ( size = read( iNotify, events, sizeof( events ) ) ) > 0 )
+    {
+        for( ssize_t offset = 0; offset < size; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>( events + offset );
+            offset += sizeof( inotify_event ) + event->len;
+
+            if( event->mask & IN_Q_OVERFLOW )
+                Log( WARNING, "Watch - events lost (queue overflow): run a batch encode after the backup" );
+            if( event->mask & IN_IGNORED )
+                ioDirectories.erase( event->wd );
+
+            const auto directory = ioDirectories.find( event->wd );
+            if( directory == ioDirectories.end() || !event->len )
+                continue;
+
+            const std::filesystem::path path = ( directory->second / event->name ).lexically_normal();
+            if( event->mask & IN_ISDIR )
+            {
+                if( event->mask & ( IN_CREATE | IN_MOVED_TO ) )
+                    AddWatches( iNotify, path, ioDirectories );
+                continue;
+            }
+
+            if( !( event->mask & ( IN_CLOSE_WRITE | IN_MOVED_TO ) ) || !IsValidBatchInput( path ) )
+                continue;
+            if( std::any_of( oJobs.begin(), oJobs.end(), [&]( const file_job& iJob ) { return iJob.mDataFile == path.string(); } ) )
+                continue;
+
+            file_job job;
+            if( !MakeBatchJob( eAction::kEncode, path, job ) )
+                continue;
+
+            if( iSha512 )
+                SetupHashFile( eAction::kEncode, job );
+            job.mCrcIndex = iCrcIndex;
+            job.mInterleaved = iInterleaved;
+
+            Log( INFO, "Watch - closed: " + job.mDataFile );
+            oJobs.push_back( job );
+        }
+    }
 }
 
+/*
+    Watch mode: the ecc (and hash) file of each .gpg volume is created as soon as it's closed, while
+    duplicity writes the next ones, and while the volume is still in the page cache.
+    It must be started before the backup: the files already there are not encoded (they may be
+    incomplete), a batch encode takes them afterwards. SIGINT/SIGTERM stops it, once the volumes
+    already closed are encoded.
+*/
 int
-WriteChunksToFile( const std::vector<tBigChunk>& iBigChunks, std::string iPathFile )
+WatchFiles( const encoder_t& iEncoder, const std::vector<std::string>& iDirectories, bool iSha512, bool iCrcIndex, bool iInterleaved, std::uint64_t iMemoryBudget )
 {
-    std::ofstream out_stream( iPathFile.c_str(), std::ios::binary );
-    if( !out_stream )
+    SetBackgroundPriority();
+
+    const int notify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if( notify < 0 )
     {
-        Log( ERROR, "reed_solomon::WriteChunksToFile() - Error: output file could not be created: " + iPathFile );
+        Log( ERROR, "reed_solomon::WatchFiles() - Error: inotify could not be initialized: " + std::string( std::strerror( errno ) ) );
         return 1;
     }
 
-    // Write ecc to the output file
-    for( const auto& big_chunk : iBigChunks )
+    std::map<int, std::filesystem::path> directories;
+    for( const auto& directory : iDirectories )
+        AddWatches( notify, std::filesystem::path( directory ).lexically_normal(), directories );
+
+    // Without SA_RESTART: poll() is interrupted by the signal
+    struct sigaction stop_action = {};
+    stop_action.sa_handler = StopWatch;
+    sigaction( SIGINT, &stop_action, nullptr );
+    sigaction( SIGTERM, &stop_action, nullptr );
+
+    Log( INFO, "Watch - " + std::to_string( directories.size() ) + " directory(ies) watched" );
+
+    bool error = false;
+    bool stop = false;
+    while( !stop )
     {
-        out_stream.write( big_chunk.data(), big_chunk.size() );
+        // Once stopped, the pending events are read a last time: the files closed before the signal are encoded
+        stop = sgWatchStop;
+
+        pollfd poll_notify = { notify, POLLIN, 0 };
+        if( !stop && poll( &poll_notify, 1, 1000 ) <= 0 )
+            continue;
+
+        std::vector<file_job> jobs;
+        ReadWatchEvents( notify, iSha512, iCrcIndex, iInterleaved, directories, jobs );
+        if( jobs.empty() )
+            continue;
+
+        if( EncodeFiles( iEncoder, jobs, iMemoryBudget ) )
+            error = true;
+        SetBatchOutputPermissions( jobs, eAction::kEncode );
     }
 
-    out_stream.close();
-    
-    return 0;
+    close( notify );
+
+    return error ? 1 : 0;
 }
 
 //---
 
-enum class eAction
-{
-    kNone,
-    kEncode,
-    kDecode,
-};
-
-enum class eArgument
-{
-    kAction,
-    kInputDataFile,
-    kOutputEccFile,
-    kInputEccFile,
-    kOutputDataDecodedFile,
-};
-
 int
 ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs )
 {
     //--- Optional arguments
 
     int verbose = 0;
-    std::string input_data_file_name;   // encode + decode
+    std::vector<std::string> input_data_file_names; // encode + decode + verify + repair (batch: several files/directories) + watch (directories)
+    std::string manifest_file_name;     // batch
+    bool sha512 = false;                // encode + verify + watch
+    bool crc_index = false;             // encode + watch
+    bool interleave = false;            // encode + watch: the sector interleaved layout
+    bool tee = false;                   // encode: the data comes from the standard input, and is written to the input data file
     std::string output_ecc_file_name;   // encode
-    std::string input_ecc_file_name;    // decode
-    std::string output_data_file_name;  // decode
+    std::string input_ecc_file_name;    // decode + verify + repair
+    std::string output_data_file_name;  // decode ("-": the standard output)
+    bool range = false;                 // decode: only a byte range of the data file
+    std::uint64_t range_offset = 0;
+    std::uint64_t range_length = UINT64_MAX; // To the end of the data file
+    std::uint64_t memory = default_memory_budget;
+    schifra::galois::simd_level engine = schifra::galois::detect_simd_level();
+    bool bad_value = false;
 
     std::deque<std::string> args_positional;
     while( ioArgs.size() )
@@ -208,13 +1985,42 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
         std::string arg = ioArgs[0];
         ioArgs.pop_front();
 
+        // The options followed by a value: a missing value is a bad argument (the usage is printed)
+        const bool needs_value = arg == "-i" || arg == "-e" || arg == "-o" || arg == "--memory" || arg == "--engine" || arg == "--offset" || arg == "--length" || arg == "--manifest";
+        if( needs_value && ioArgs.empty() )
+        {
+            bad_value = true;
+            break;
+        }
+
         if( arg == "-v" )
         {
             verbose++;
         }
         else if( arg == "-i" )
         {
-            input_data_file_name = ioArgs[0];
+            input_data_file_names.push_back( ioArgs[0] );
+            ioArgs.pop_front();
+        }
+        else if( arg == "--sha512" )
+        {
+            sha512 = true;
+        }
+        else if( arg == "--crc-index" )
+        {
+            crc_index = true;
+        }
+        else if( arg == "--interleave" )
+        {
+            interleave = true;
+        }
+        else if( arg == "--tee" )
+        {
+            tee = true;
+        }
+        else if( arg == "--manifest" )
+        {
+            manifest_file_name = ioArgs[0];
             ioArgs.pop_front();
         }
         else if( arg == "-e" )
@@ -228,6 +2034,45 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
             output_data_file_name = ioArgs[0];
             ioArgs.pop_front();
         }
+        else if( arg == "--memory" )
+        {
+            // In MB (the budget in bytes must fit)
+            try
+            {
+                std::size_t end = 0;
+                const std::uint64_t megabytes = std::stoull( ioArgs[0], &end );
+                bad_value = bad_value || end != ioArgs[0].length() || ioArgs[0][0] == '-' || megabytes > std::numeric_limits<std::uint64_t>::max() / ( 1024 * 1024 );
+                memory = megabytes * 1024 * 1024;
+            }
+            catch( ... )
+            {
+                bad_value = true;
+            }
+            ioArgs.pop_front();
+        }
+        else if( arg == "--offset" || arg == "--length" )
+        {
+            // In bytes
+            try
+            {
+                std::size_t end = 0;
+                ( arg == "--offset" ? range_offset : range_length ) = std::stoull( ioArgs[0], &end );
+                bad_value = bad_value || end != ioArgs[0].length() || ioArgs[0][0] == '-';
+            }
+            catch( ... )
+            {
+                bad_value = true;
+            }
+            range = true;
+            ioArgs.pop_front();
+        }
+        else if( arg == "--engine" )
+        {
+            // Galois field kernels: scalar, ssse3, avx2, avx512bw, gfni
+            if( !schifra::galois::simd_level_from_name( ioArgs[0], engine ) )
+                bad_value = true;
+            ioArgs.pop_front();
+        }
         else
         {
             args_positional.push_back( arg );
@@ -236,6 +2081,10 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
 
     SetLogLevel( verbose );
 
+    // The decoded data may go to the standard output: the log never does
+    if( output_data_file_name == standard_output_name )
+        sgLogStream = &std::cerr;
+
     //--- Positional arguments
 
     eAction action = eAction::kNone;
@@ -249,19 +2098,63 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
             action = eAction::kEncode;
         if( arg == "d" || arg == "decode" )
             action = eAction::kDecode;
+        if( arg == "v" || arg == "verify" )
+            action = eAction::kVerify;
+        if( arg == "r" || arg == "repair" )
+            action = eAction::kRepair;
+        if( arg == "w" || arg == "watch" )
+            action = eAction::kWatch;
+    }
+
+    //--- Batch: a manifest, several inputs, a directory or a file without its ecc/output file (the ecc/output paths are the ones of ecc.py)
+
+    const bool batch_action = action == eAction::kEncode || action == eAction::kDecode || action == eAction::kVerify;
+    bool batch = manifest_file_name.length() || input_data_file_names.size() > 1
+                 || ( batch_action && input_data_file_names.size() == 1 && !input_ecc_file_name.length() && !output_ecc_file_name.length() );
+    bool directories_only = input_data_file_names.size() > 0; // watch
+    for( const auto& input : input_data_file_names )
+    {
+        const bool directory = std::filesystem::is_directory( input );
+        batch = batch || directory;
+        directories_only = directories_only && directory;
     }
 
+    const bool single_input = input_data_file_names.size() == 1; // single file actions
+
     //--- Error checking
 
     if( args_positional.size() // remaining arguments
+        || bad_value
+        || !memory
         || action == eAction::kNone 
-        || ( action == eAction::kEncode && ( !input_data_file_name.length() || !output_ecc_file_name.length() ) )
-        || ( action == eAction::kDecode && ( !input_data_file_name.length() || !input_ecc_file_name.length() || !output_data_file_name.length() ) ) )
+        || ( sha512 && action != eAction::kEncode && action != eAction::kVerify && action != eAction::kWatch )
+        || ( crc_index && action != eAction::kEncode && action != eAction::kWatch )
+        || ( interleave && ( crc_index || ( action != eAction::kEncode && action != eAction::kWatch ) ) )
+        || ( tee && ( action != eAction::kEncode || batch ) )
+        || ( output_data_file_name == standard_output_name && action != eAction::kDecode )
+        || ( range && ( action != eAction::kDecode || batch ) )
+        || ( batch && ( action == eAction::kRepair || output_ecc_file_name.length() || input_ecc_file_name.length() ) )
+        || ( !batch && action == eAction::kEncode && ( !single_input || !output_ecc_file_name.length() ) )
+        || ( !batch && action == eAction::kDecode && ( !single_input || !input_ecc_file_name.length() || !output_data_file_name.length() ) )
+        || ( !batch && action == eAction::kVerify && ( !single_input || !input_ecc_file_name.length() ) )
+        || ( action == eAction::kRepair && ( !single_input || !input_ecc_file_name.length() ) )
+        || ( action == eAction::kWatch && ( !directories_only || manifest_file_name.length() ) ) )
     {
         Log( ERROR, "Error - Bad arguments." );
         Log( ERROR, "Usage:" );
-        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] {e, encode} -i input-data-file -o output-ecc-file" );
-        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] {d, decode} -i input-data-file -e input-ecc-file -o output-datafile" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {e, encode} [--sha512] [--crc-index | --interleave] [--tee] -i input-data-file -o output-ecc-file" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {d, decode} [--offset bytes] [--length bytes] -i input-data-file -e input-ecc-file -o {output-datafile | -}" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {v, verify} [--sha512] -i input-data-file -e input-ecc-file" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {e, encode | d, decode | v, verify} [--sha512] [--crc-index | --interleave] -i input-directory-or-file [-i ...] [--manifest file-of-inputs]" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {r, repair} -i input-data-file -e input-ecc-file" );
+        Log( ERROR, "./ecc-schifra-255-32-8 [-v [-v [-v]]] [--memory MB] [--engine NAME] {w, watch} [--sha512] [--crc-index | --interleave] -i input-directory [-i ...]" );
+
+        return 1;
+    }
+
+    if( !schifra::galois::simd_level_supported( engine ) )
+    {
+        Log( ERROR, std::string( "Error - Engine not supported by this cpu: " ) + schifra::galois::simd_level_name( engine ) );
 
         return 1;
     }
@@ -269,10 +2162,21 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
     //--- Build argument parameters
 
     oArgs[eArgument::kAction] = action;
-    oArgs[eArgument::kInputDataFile] = input_data_file_name;
+    oArgs[eArgument::kInputDataFiles] = input_data_file_names;
+    oArgs[eArgument::kManifestFile] = manifest_file_name;
+    oArgs[eArgument::kBatch] = batch;
+    oArgs[eArgument::kSha512] = sha512;
+    oArgs[eArgument::kCrcIndex] = crc_index;
+    oArgs[eArgument::kInterleave] = interleave;
+    oArgs[eArgument::kTee] = tee;
     oArgs[eArgument::kOutputEccFile] = output_ecc_file_name;
     oArgs[eArgument::kInputEccFile] = input_ecc_file_name;
     oArgs[eArgument::kOutputDataDecodedFile] = output_data_file_name;
+    oArgs[eArgument::kRange] = range;
+    oArgs[eArgument::kRangeOffset] = range_offset;
+    oArgs[eArgument::kRangeLength] = range_length;
+    oArgs[eArgument::kMemory] = memory;
+    oArgs[eArgument::kEngine] = engine;
 
     return 0;
 }
@@ -282,13 +2186,6 @@ ParseArgs( std::deque<std::string>& ioArgs, std::map<eArgument, std::any>& oArgs
 int
 main( int argc, char *argv[] )
 {
-    const std::size_t field_descriptor    =   8;
-    const std::size_t gen_poly_index      = 120;
-    const std::size_t gen_poly_root_count =  32;
-    const std::size_t code_length         = 255;
-    const std::size_t fec_length          =  32;
-    const std::size_t data_length         = code_length - fec_length;
-
     int error = 0;
 
     std::deque<std::string> string_args( argv, argv + argc );
@@ -300,10 +2197,21 @@ main( int argc, char *argv[] )
         return 1;
 
     eAction action = std::any_cast<eAction>( args[eArgument::kAction] );
-    std::string input_data_file_name = std::any_cast<std::string>( args[eArgument::kInputDataFile] );
+    std::vector<std::string> input_data_file_names = std::any_cast<std::vector<std::string>>( args[eArgument::kInputDataFiles] );
+    std::string manifest_file_name = std::any_cast<std::string>( args[eArgument::kManifestFile] );
+    bool batch = std::any_cast<bool>( args[eArgument::kBatch] );
+    bool sha512 = std::any_cast<bool>( args[eArgument::kSha512] );
+    bool crc_index = std::any_cast<bool>( args[eArgument::kCrcIndex] );
+    bool interleave = std::any_cast<bool>( args[eArgument::kInterleave] );
+    bool tee = std::any_cast<bool>( args[eArgument::kTee] );
     std::string output_ecc_file_name = std::any_cast<std::string>( args[eArgument::kOutputEccFile] );
     std::string input_ecc_file_name = std::any_cast<std::string>( args[eArgument::kInputEccFile] );
     std::string output_data_file_name = std::any_cast<std::string>( args[eArgument::kOutputDataDecodedFile] );
+    bool range = std::any_cast<bool>( args[eArgument::kRange] );
+    std::uint64_t range_offset = std::any_cast<std::uint64_t>( args[eArgument::kRangeOffset] );
+    std::uint64_t range_length = std::any_cast<std::uint64_t>( args[eArgument::kRangeLength] );
+    std::uint64_t memory = std::any_cast<std::uint64_t>( args[eArgument::kMemory] );
+    schifra::galois::simd_level engine = std::any_cast<schifra::galois::simd_level>( args[eArgument::kEngine] );
 
     //---
 
@@ -311,162 +2219,109 @@ main( int argc, char *argv[] )
 //      const unsigned int primitive_polynomial_size05b = 9;
 //      const schifra::galois::field field( field_descriptor, primitive_polynomial_size05b, primitive_polynomial05b );
 
-    const schifra::galois::field field( field_descriptor, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
-
-    Log( INFO, "Start processing: " + input_data_file_name );
-
-    //---
-
-    const auto processor_count = std::thread::hardware_concurrency();
+    // The codecs build the lookup tables of the field they use: none for encode, mul + div at the first codeword to decode
+    const schifra::galois::field field( field_descriptor, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06, schifra::galois::field::e_no_tables );
 
-    std::size_t data_full_size = schifra::fileio::file_size( input_data_file_name );
-    // Number of big chunk
-    double big_chunk_sizef = data_full_size / double( processor_count );
-    // Number of data chunk (223o) per big chunk
-    double nbf_data_chunk_per_big_chunk = big_chunk_sizef / data_length;
-    // Number of data chunk (223o) per big chunk by rounding to upper value
-    int nb_data_chunk_per_big_chunk = int( ceil( nbf_data_chunk_per_big_chunk ) );
-    // Size of a big chunk containing a multiple of data_length chunk (except for the last one)
-    std::size_t data_big_chunk_size = nb_data_chunk_per_big_chunk * data_length;
+    Log( INFO, "Start processing: " + ( batch ? std::string( "batch" ) : input_data_file_names[0] ) );
+    Log( INFO, std::string( "Galois field engine: " ) + schifra::galois::simd_level_name( engine ) + ( engine == schifra::galois::detect_simd_level() ? " (best available)" : " (forced)" ) );
 
     //---
 
-    std::vector<tBigChunk> data_big_chunks;
-    error = AllocateBigChunks( data_full_size, data_big_chunk_size, data_big_chunks );
-    if( error )
-        return 1;
-
-    assert( data_big_chunks.size() <= processor_count );
-
-    Log( TRACE, "Read input file [data]: " + input_data_file_name );
-
-    error = ReadFileToChunks( input_data_file_name, data_big_chunks );
-    if( error )
-        return 1;
+    // The field, the codec and the pool are shared by all the files of a batch
+    std::vector<file_job> jobs;
+    if( action == eAction::kWatch )
+    {
+        // The jobs come from the events of the watched directories
+    }
+    else if( batch )
+    {
+        error = CollectBatchFiles( action, input_data_file_names, manifest_file_name, jobs );
+        if( error )
+            return 1;
+    }
+    else
+    {
+        file_job job;
+        job.mDataFile = input_data_file_names[0];
+        job.mEccFile = action == eAction::kEncode ? output_ecc_file_name : input_ecc_file_name;
+        job.mOutputFile = output_data_file_name;
+        job.mRange = range;
+        job.mRangeOffset = range_offset;
+        job.mRangeLength = range_length;
+        jobs.push_back( job );
+    }
 
-    //---
+    // The sha512sum files of hash-create.sh are written/checked in the same read as the ecc
+    if( sha512 )
+    {
+        for( auto& job : jobs )
+            SetupHashFile( action, job );
+    }
 
+    // The layout of the existing ecc files is read from their header (or found from their size, without one)
     if( action == eAction::kEncode )
     {
-        schifra::galois::field_polynomial generator_polynomial( field );
-
-        if( !schifra::make_sequential_root_generator_polynomial( field, gen_poly_index, gen_poly_root_count, generator_polynomial ) )
+        for( auto& job : jobs )
         {
-            Log( ERROR, "Error - Failed to create sequential root generator!" );
-            return 1;
+            job.mCrcIndex = crc_index;
+            job.mInterleaved = interleave;
         }
-
-        //---
-
-        std::vector<tBigChunk> ecc_big_chunks;
-        error = AllocateEmptyBigChunks( data_big_chunks.size(), ecc_big_chunks );
-        if( error )
-            return 1;
-
-        //---
-
-        typedef schifra::reed_solomon::encoder<code_length,fec_length> encoder_t;
-        typedef schifra::reed_solomon::segment_encoder<code_length,fec_length> segment_encoder_t;
-
-        // Create the encoder
-        const encoder_t rs_encoder( field, generator_polynomial );
-
-        //---
-
-        Log( TRACE, "Start encoding: " + input_data_file_name + " -> " + output_ecc_file_name );
-
-        // Callback for the thread
-        auto encode = [&]( const tBigChunk& iData, tBigChunk& oEcc )
+    }
+    else if( action == eAction::kDecode || action == eAction::kVerify )
+    {
+        for( auto& job : jobs )
         {
-            segment_encoder_t( rs_encoder, iData, oEcc );
-        };
+            if( !ReadEccLayout( job, action == eAction::kDecode ? "DecodeFile" : "VerifyFile" ) )
+                job.mError = true;
 
-        // Create the threads
-        std::vector<std::thread> threads;
-        for( std::vector<tBigChunk>::size_type i = 0; i < data_big_chunks.size(); i++ )
-        {
-            threads.push_back( std::thread( encode, std::ref( data_big_chunks[i] ), std::ref( ecc_big_chunks[i] ) ) );
+            // Without --sha512, verify checks the digest stored in the header
+            if( action == eAction::kVerify && !job.mHashFile.length() )
+                job.mExpectedHash = job.mEccHeader.hex_hash();
         }
+    }
 
-        // Wait all threads
-        for( auto& thread : threads )
-        {
-            if( thread.joinable() )
-                thread.join();
-        }
+    //---
 
-        //---
+    if( action == eAction::kEncode || action == eAction::kWatch )
+    {
+        // Create the encoder
+        const schifra::galois::field_polynomial generator_polynomial = static_generator_t::polynomial( field );
+        const encoder_t rs_encoder( field, generator_polynomial, engine );
 
-        Log( TRACE, "Write output file [ecc]: " + output_ecc_file_name );
+        if( action == eAction::kWatch )
+            return WatchFiles( rs_encoder, input_data_file_names, sha512, crc_index, interleave, memory );
 
-        error = WriteChunksToFile( ecc_big_chunks, output_ecc_file_name );
+        error = tee ? TeeEncodeFile( rs_encoder, jobs[0], memory ) : EncodeFiles( rs_encoder, jobs, memory );
+        if( batch )
+            SetBatchOutputPermissions( jobs, action );
         if( error )
             return 1;
     }
     else if( action == eAction::kDecode )
     {
-        std::size_t ecc_full_size = schifra::fileio::file_size( input_ecc_file_name );
-        assert( !( ecc_full_size % fec_length ) );
-        
-        std::size_t ecc_big_chunk_size = nb_data_chunk_per_big_chunk * fec_length; // Must use the same nb_data_chunk_per_big_chunk as the data big_chunk, to have the same number of chunk in both side
-
-        //---
-
-        std::vector<tBigChunk> ecc_big_chunks;
-        error = AllocateBigChunks( ecc_full_size, ecc_big_chunk_size, ecc_big_chunks );
-        if( error )
-            return 1;
-
-        assert( ecc_big_chunks.size() <= processor_count );
+        // Create the decoder
+        const decoder_t rs_decoder( field, gen_poly_index, engine );
+        const syndrome_t rs_syndrome( field, gen_poly_index, engine );
 
-        Log( TRACE, "Read input file [ecc]: " + input_ecc_file_name );
-
-        error = ReadFileToChunks( input_ecc_file_name, ecc_big_chunks );
-        if( error )
-            return 1;
-
-        std::vector<tBigChunk> data_decoded_big_chunks;
-        error = AllocateEmptyBigChunks( data_big_chunks.size(), data_decoded_big_chunks );
+        error = DecodeFiles( rs_decoder, rs_syndrome, jobs, memory );
+        if( batch )
+            SetBatchOutputPermissions( jobs, action );
         if( error )
             return 1;
+    }
+    else if( action == eAction::kVerify )
+    {
+        const decoder_t rs_decoder( field, gen_poly_index, engine );
+        const syndrome_t rs_syndrome( field, gen_poly_index, engine );
 
-        //---
-
-        typedef schifra::reed_solomon::decoder<code_length,fec_length> decoder_t;
-        typedef schifra::reed_solomon::segment_decoder<code_length,fec_length> segment_decoder_t;
-
-        // Create the encoder
-        const decoder_t rs_decoder( field, gen_poly_index );
-
-        //---
-
-        Log( TRACE, "Start decoding: " + input_data_file_name + " + " + input_ecc_file_name + " -> " + output_data_file_name );
-
-        // Callback for the thread
-        auto decode = [&]( const tBigChunk& iData, const tBigChunk& iEcc, tBigChunk& oDataDecoded )
-        {
-            segment_decoder_t( rs_decoder, iData, iEcc, oDataDecoded );
-        };
-
-        // Create the threads
-        std::vector<std::thread> threads;
-        for( std::vector<tBigChunk>::size_type i = 0; i < data_big_chunks.size(); i++ )
-        {
-            threads.push_back( std::thread( decode, std::ref( data_big_chunks[i] ), std::ref( ecc_big_chunks[i] ), std::ref( data_decoded_big_chunks[i] ) ) );
-        }
-
-        // Wait all threads
-        for( auto& thread : threads )
-        {
-            if( thread.joinable() )
-                thread.join();
-        }
-
-        //---
-
-        Log( TRACE, "Write output file [regenerated]: " + output_data_file_name );
+        return VerifyFiles( rs_decoder, rs_syndrome, jobs, memory );
+    }
+    else if( action == eAction::kRepair )
+    {
+        const decoder_t rs_decoder( field, gen_poly_index, engine );
+        const syndrome_t rs_syndrome( field, gen_poly_index, engine );
 
-        error = WriteChunksToFile( data_decoded_big_chunks, output_data_file_name );
+        error = RepairFile( rs_decoder, rs_syndrome, input_data_file_names[0], input_ecc_file_name, memory );
         if( error )
             return 1;
     }
@@ -0,0 +1,455 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The reader of files with unreadable sectors (simulated with a
+                pread failing with EIO), the erasures of the unreadable bytes
+                in each layout, and the decoding of codewords with more dead
+                symbols than the errors-only decoder can correct.
+*/
+
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "schifra_fileio.hpp"
+#include "ecc-crc-index.hpp"
+#include "ecc-decoder.hpp"
+#include "ecc-encoder.hpp"
+#include "ecc-interleave.hpp"
+#include "ecc-sector-reader.hpp"
+
+
+const std::size_t code_length = 255;
+const std::size_t fec_length  =  32;
+const std::size_t data_length = code_length - fec_length;
+
+typedef schifra::reed_solomon::batch_encoder<code_length,fec_length>                encoder_t;
+typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length>                decoder_t;
+typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length>               syndrome_t;
+typedef schifra::reed_solomon::segment_encoder<code_length,fec_length>              segment_encoder_t;
+typedef schifra::reed_solomon::segment_decoder<code_length,fec_length>              segment_decoder_t;
+typedef schifra::reed_solomon::interleaved_segment_encoder<code_length,fec_length>  interleaved_encoder_t;
+typedef schifra::reed_solomon::interleaved_segment_decoder<code_length,fec_length>  interleaved_decoder_t;
+typedef schifra::reed_solomon::interleaved_segment_verifier<code_length,fec_length> interleaved_verifier_t;
+typedef schifra::reed_solomon::unreadable_erasures<code_length,fec_length>          erasures_t;
+typedef schifra::reed_solomon::crc_index<code_length,fec_length>                    crc_index_t;
+
+using schifra::reed_solomon::codeword_erasure;
+using schifra::reed_solomon::sector_reader;
+using schifra::reed_solomon::unreadable_range;
+
+const std::size_t sector_size = sector_reader::sector_size;
+const std::size_t group_block_count = interleaved_encoder_t::group_block_count;
+
+// The simulated disk: sectors always failing, failing a few times, or failing with another error
+std::set<std::uint64_t> gBadSectors;
+std::map<std::uint64_t, int> gFlakySectors;
+std::uint64_t gOtherErrorSector = ~std::uint64_t( 0 );
+std::vector<std::pair<std::uint64_t, std::size_t>> gReads;
+
+ssize_t failing_pread( int iFile, void* oBuffer, std::size_t iSize, off_t iOffset )
+{
+   gReads.push_back( { std::uint64_t( iOffset ), iSize } );
+
+   const std::uint64_t first = std::uint64_t( iOffset ) / sector_size;
+   const std::uint64_t last = ( std::uint64_t( iOffset ) + iSize - 1 ) / sector_size;
+   for( std::uint64_t sector = first; iSize && sector <= last; ++sector )
+   {
+      int error = 0;
+      if( gBadSectors.count( sector ) )
+         error = EIO;
+      else if( gFlakySectors.count( sector ) && gFlakySectors[sector] > 0 )
+         error = EIO, --gFlakySectors[sector];
+      else if( sector == gOtherErrorSector )
+         error = EACCES;
+
+      if( error )
+      {
+         errno = error;
+         return -1;
+      }
+   }
+
+   return ::pread( iFile, oBuffer, iSize, iOffset );
+}
+
+void reset_disk()
+{
+   gBadSectors.clear();
+   gFlakySectors.clear();
+   gOtherErrorSector = ~std::uint64_t( 0 );
+   gReads.clear();
+}
+
+bool same_ranges( const std::vector<unreadable_range>& iRanges, const std::vector<unreadable_range>& iExpected )
+{
+   if( iRanges.size() != iExpected.size() )
+      return false;
+
+   for( std::size_t i = 0; i < iRanges.size(); ++i )
+   {
+      if( iRanges[i].mOffset != iExpected[i].mOffset || iRanges[i].mSize != iExpected[i].mSize )
+         return false;
+   }
+
+   return true;
+}
+
+bool reader_validation_test()
+{
+   const std::string file_name = "ecc_sector_reader_validation.dat";
+
+   std::string content( 12 * sector_size + 100, 0 );
+   for( auto& byte : content )
+      byte = static_cast<char>( 1 + ::rand() % 255 );
+   schifra::fileio::write_file( file_name, content );
+
+   bool result = true;
+
+   // Dead sectors 2-3 and 7, sector 5 only fails twice: one read of the whole file
+   {
+      reset_disk();
+      gBadSectors = { 2, 3, 7 };
+      gFlakySectors[5] = sector_reader::read_attempts - 1;
+
+      sector_reader reader( failing_pread );
+      std::vector<char> buffer( content.size() );
+      std::vector<unreadable_range> unreadable;
+      if( !reader.open( file_name ) || !reader.read( buffer.data(), buffer.size(), unreadable ) )
+      {
+         std::cout << "Error - Read of a file with unreadable sectors failed" << std::endl;
+         result = false;
+      }
+      else if( !same_ranges( unreadable, { { 2 * sector_size, 2 * sector_size }, { 7 * sector_size, sector_size } } ) )
+      {
+         std::cout << "Error - Unreadable ranges of the whole file" << std::endl;
+         result = false;
+      }
+      else
+      {
+         for( std::size_t i = 0; result && i < content.size(); ++i )
+         {
+            const bool dead = gBadSectors.count( i / sector_size );
+            if( buffer[i] != ( dead ? 0 : content[i] ) )
+            {
+               std::cout << "Error - Byte " << i << " of the whole file" << std::endl;
+               result = false;
+            }
+         }
+
+         // Past the bad patch (sector 8 is good), the rest is read at once
+         bool resumed = false;
+         for( const auto& read : gReads )
+            resumed = resumed || ( read.first == 9 * sector_size && read.second == content.size() - 9 * sector_size );
+         if( result && !resumed )
+         {
+            std::cout << "Error - Bulk reads not resumed after the bad patch" << std::endl;
+            result = false;
+         }
+      }
+   }
+
+   // Unaligned buffers: the dead sectors are split between buffers, and merged back
+   if( result )
+   {
+      reset_disk();
+      gBadSectors = { 2, 3, 7 };
+
+      sector_reader reader( failing_pread );
+      std::vector<char> buffer( 5000 );
+      std::vector<unreadable_range> unreadable;
+      reader.open( file_name );
+      reader.seek( 1000 );
+      for( std::size_t offset = 1000; result && offset < content.size(); offset += buffer.size() )
+      {
+         const std::size_t size = std::min( buffer.size(), content.size() - offset );
+         if( !reader.read( buffer.data(), size, unreadable ) )
+         {
+            std::cout << "Error - Read of " << size << " bytes at " << offset << std::endl;
+            result = false;
+         }
+      }
+
+      if( result && !same_ranges( unreadable, { { 2 * sector_size, 2 * sector_size }, { 7 * sector_size, sector_size } } ) )
+      {
+         std::cout << "Error - Unreadable ranges of unaligned buffers" << std::endl;
+         result = false;
+      }
+   }
+
+   // Beyond the end of the file, or another error: the read fails
+   if( result )
+   {
+      reset_disk();
+      gBadSectors = { 11 };
+
+      sector_reader reader( failing_pread );
+      std::vector<char> buffer( content.size() + 1 );
+      std::vector<unreadable_range> unreadable;
+      reader.open( file_name );
+      if( reader.read( buffer.data(), buffer.size(), unreadable ) )
+      {
+         std::cout << "Error - Read beyond the end of the file succeeded" << std::endl;
+         result = false;
+      }
+
+      reset_disk();
+      gBadSectors = { 1 };
+      gOtherErrorSector = 4;
+      reader.seek( 0 );
+      if( result && reader.read( buffer.data(), content.size(), unreadable ) )
+      {
+         std::cout << "Error - Read with a non EIO error succeeded" << std::endl;
+         result = false;
+      }
+   }
+
+   reset_disk();
+   std::remove( file_name.c_str() );
+
+   return result;
+}
+
+bool same_erasures( const std::vector<codeword_erasure>& iErasures, const std::vector<codeword_erasure>& iExpected )
+{
+   if( iErasures.size() != iExpected.size() )
+      return false;
+
+   for( std::size_t i = 0; i < iErasures.size(); ++i )
+   {
+      if( iErasures[i].mBlock != iExpected[i].mBlock || iErasures[i].mPosition != iExpected[i].mPosition )
+         return false;
+   }
+
+   return true;
+}
+
+bool erasures_validation_test()
+{
+   const std::uint64_t data_size = 100 * data_length + 10;
+   std::vector<codeword_erasure> erasures;
+
+   // Contiguous data: a range across two codewords, and the partial last codeword
+   erasures_t::data( { 2 * data_length - 2, 4 }, data_size, 1, erasures );
+   erasures_t::data( { 100 * data_length + 9, 1 }, data_size, 1, erasures );
+   erasures_t::sort( erasures );
+   if( !same_erasures( erasures, { { 1, data_length - 2 }, { 1, data_length - 1 }, { 2, 0 }, { 2, 1 }, { 100, 9 } } ) )
+   {
+      std::cout << "Error - Erasures of contiguous data" << std::endl;
+      return false;
+   }
+
+   // Crc index records after a header: the crc bytes aren't symbols, the header isn't a record
+   erasures.clear();
+   const std::uint64_t header_size = 64;
+   erasures_t::records( { header_size - 8, 8 + 2 }, header_size, data_size, 1, crc_index_t::record_length, erasures );
+   erasures_t::records( { header_size + crc_index_t::record_length + fec_length - 2, 4 }, header_size, data_size, 1, crc_index_t::record_length, erasures );
+   erasures_t::sort( erasures );
+   if( !same_erasures( erasures, { { 0, data_length }, { 0, data_length + 1 }, { 1, code_length - 2 }, { 1, code_length - 1 } } ) )
+   {
+      std::cout << "Error - Erasures of crc index records" << std::endl;
+      return false;
+   }
+
+   // Interleaved: a sector is a symbol of every codeword of its group, the last group is narrower
+   erasures.clear();
+   const std::uint64_t interleaved_size = group_block_count * data_length + 5 * data_length;
+   erasures_t::data( { 3 * sector_size, sector_size }, interleaved_size, group_block_count, erasures );
+   erasures_t::data( { group_block_count * data_length + 12, 1 }, interleaved_size, group_block_count, erasures );
+   erasures_t::records( { 31 * sector_size, sector_size + 5 }, 0, interleaved_size, group_block_count, fec_length, erasures );
+   erasures_t::sort( erasures );
+
+   std::vector<codeword_erasure> expected;
+   for( std::uint64_t block = 0; block < group_block_count; ++block )
+   {
+      expected.push_back( { block, 3 } );
+      expected.push_back( { block, code_length - 1 } );
+   }
+   expected.push_back( { group_block_count, data_length } );
+   expected.push_back( { group_block_count + 2, 2 } );
+   expected.push_back( { group_block_count + 1, data_length } );
+   expected.push_back( { group_block_count + 2, data_length } );
+   expected.push_back( { group_block_count + 3, data_length } );
+   expected.push_back( { group_block_count + 4, data_length } );
+   erasures_t::sort( expected );
+
+   if( !same_erasures( erasures, expected ) )
+   {
+      std::cout << "Error - Erasures of the interleaved layout" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+// Zero fill whole sectors of a buffer, as the reader does, and append their erasures
+void kill_sectors( std::vector<char>& ioBuffer, const std::vector<std::size_t>& iSectors, std::vector<unreadable_range>& oRanges )
+{
+   for( const std::size_t sector : iSectors )
+   {
+      const std::size_t end = std::min( ( sector + 1 ) * sector_size, ioBuffer.size() );
+      std::fill( ioBuffer.begin() + sector * sector_size, ioBuffer.begin() + end, 0 );
+      oRanges.push_back( { sector * sector_size, end - sector * sector_size } );
+   }
+}
+
+bool decode_validation_test()
+{
+   const schifra::galois::field field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
+
+   schifra::galois::field_polynomial generator( field );
+   if( !schifra::make_sequential_root_generator_polynomial( field, 120, fec_length, generator ) )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t encoder( field, generator );
+   const decoder_t decoder( field, 120 );
+   const syndrome_t syndrome( field, 120 );
+
+   // Contiguous: fec_length erased symbols of a codeword (data and parity), the segment starting at codeword 100 of the file
+   {
+      const std::size_t size = 20 * data_length - 7;
+      std::vector<char> data( size );
+      for( auto& byte : data )
+         byte = static_cast<char>( ::rand() );
+
+      std::vector<char> ecc( 20 * fec_length );
+      segment_encoder_t( encoder, data.data(), data.size(), ecc.data() );
+
+      std::vector<char> damaged( data );
+      std::vector<codeword_erasure> erasures;
+      for( std::size_t i = 0; i < fec_length - 4; ++i )
+      {
+         damaged[3 * data_length + i * 7] ^= 0x3C;
+         erasures.push_back( { 103, i * 7 } );
+      }
+      for( std::size_t i = 0; i < 4; ++i )
+      {
+         ecc[3 * fec_length + i] ^= 0x3C;
+         erasures.push_back( { 103, data_length + i } );
+      }
+      erasures_t::sort( erasures );
+
+      std::vector<char> output( size );
+      segment_decoder_t errors_only( decoder, syndrome, damaged.data(), damaged.size(), ecc.data(), output.data(), 100 );
+      if( !errors_only.failed_blocks() )
+      {
+         std::cout << "Error - Errors only decode of " << fec_length << " symbols succeeded" << std::endl;
+         return false;
+      }
+
+      segment_decoder_t with_erasures( decoder, syndrome, damaged.data(), damaged.size(), ecc.data(), output.data(), 100, 0, &erasures );
+      if( with_erasures.failed_blocks() || output != data )
+      {
+         std::cout << "Error - Decode of " << fec_length << " erasures: " << with_erasures.failed_blocks() << " failed block(s)" << std::endl;
+         return false;
+      }
+   }
+
+   // Interleaved: fec_length dead sectors in a group (data and parity), and the last one of the partial last group
+   {
+      const std::size_t size = group_block_count * data_length + 40000;
+      std::vector<char> data( size );
+      for( auto& byte : data )
+         byte = static_cast<char>( ::rand() );
+
+      const std::size_t block_count = ( size + data_length - 1 ) / data_length;
+      std::vector<char> ecc( block_count * fec_length );
+      interleaved_encoder_t( encoder, data.data(), data.size(), ecc.data() );
+
+      std::vector<char> damaged( data );
+      std::vector<unreadable_range> data_ranges;
+      std::vector<unreadable_range> ecc_ranges;
+      std::vector<std::size_t> sectors;
+      for( std::size_t i = 0; i < fec_length - 2; ++i )
+         sectors.push_back( ( i * 37 + 3 ) % data_length );
+      sectors.push_back( ( size - 1 ) / sector_size );
+      kill_sectors( damaged, sectors, data_ranges );
+      kill_sectors( ecc, { 0, 17 }, ecc_ranges );
+
+      std::vector<codeword_erasure> erasures;
+      for( const auto& range : data_ranges )
+         erasures_t::data( range, size, group_block_count, erasures );
+      for( const auto& range : ecc_ranges )
+         erasures_t::records( range, 0, size, group_block_count, fec_length, erasures );
+      erasures_t::sort( erasures );
+
+      std::vector<char> output( size );
+      interleaved_decoder_t with_erasures( decoder, syndrome, damaged.data(), damaged.size(), ecc.data(), output.data(), 0, &erasures );
+      if( with_erasures.failed_blocks() || output != data )
+      {
+         std::cout << "Error - Interleaved decode of " << fec_length << " dead sectors: " << with_erasures.failed_blocks() << " failed block(s)" << std::endl;
+         return false;
+      }
+
+      std::vector<schifra::reed_solomon::corrupted_block> corrupted;
+      interleaved_verifier_t( decoder, syndrome, damaged.data(), damaged.size(), ecc.data(), corrupted, 0, &erasures );
+      for( const auto& block : corrupted )
+      {
+         if( !block.mCorrectable )
+         {
+            std::cout << "Error - Interleaved verify of " << fec_length << " dead sectors: block " << block.mIndex << std::endl;
+            return false;
+         }
+      }
+      if( corrupted.empty() )
+      {
+         std::cout << "Error - Interleaved verify of " << fec_length << " dead sectors: no corrupted block" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand( 0x5EC702 );
+
+   if( reader_validation_test() && erasures_validation_test() && decode_validation_test() )
+   {
+      std::cout << "ECC Sector Reader Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Sector Reader Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,246 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_ECC_SECTOR_READER_HPP
+#define INCLUDE_ECC_SECTOR_READER_HPP
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ecc-pipeline.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      // Bytes of a file which could not be read (zero filled in the buffer)
+      struct unreadable_range
+      {
+         std::uint64_t mOffset;
+         std::uint64_t mSize;
+      };
+
+      /*
+         Sequential reader of a file which survives its bad sectors.
+
+         The buffer is read with large preads. When one fails with EIO, the rest of the buffer
+         is read sector by sector (sectors aligned in the file), each one tried read_attempts
+         times: a sector which still fails is zero filled and reported as unreadable. Once past
+         the bad patch (a good sector after a bad one), the large reads resume.
+
+         Any other error, or the end of the file before the end of the buffer, fails the read.
+      */
+      class sector_reader
+      {
+      public:
+
+         typedef ssize_t ( *read_function )( int, void*, std::size_t, off_t );
+
+         static const std::size_t sector_size = 4096;
+         static const int read_attempts = 3;
+
+         // iRead: the pread of the system (a test can simulate unreadable sectors)
+         explicit sector_reader( read_function iRead = ::pread )
+         : mRead( iRead )
+         {
+         }
+
+         ~sector_reader()
+         {
+            close();
+         }
+
+         sector_reader( const sector_reader& ) = delete;
+         sector_reader& operator=( const sector_reader& ) = delete;
+
+         bool open( const std::string& iPath )
+         {
+            close();
+            mFile = ::open( iPath.c_str(), O_RDONLY );
+            mOffset = 0;
+            return mFile >= 0;
+         }
+
+         void close()
+         {
+            if( mFile >= 0 )
+               ::close( mFile );
+            mFile = -1;
+         }
+
+         void seek( std::uint64_t iOffset )
+         {
+            mOffset = iOffset;
+         }
+
+         // Read iSize bytes at the current offset, the unreadable sectors are appended to ioUnreadable (in file offsets)
+         bool read( char* oBuffer, std::size_t iSize, std::vector<unreadable_range>& ioUnreadable )
+         {
+            std::size_t done = 0;
+            while( done < iSize )
+            {
+               int error = 0;
+               done += ReadAt( oBuffer + done, iSize - done, mOffset + done, error );
+               if( done == iSize )
+                  break;
+               if( error != EIO )
+                  return false;
+
+               bool bad_patch = false;
+               while( done < iSize )
+               {
+                  const std::uint64_t offset = mOffset + done;
+                  const std::size_t size = std::size_t( std::min<std::uint64_t>( iSize - done, sector_size - offset % sector_size ) );
+
+                  std::size_t count = 0;
+                  for( int attempt = 0; attempt < read_attempts && count < size; ++attempt )
+                  {
+                     count += ReadAt( oBuffer + done + count, size - count, offset + count, error );
+                     if( count < size && error != EIO )
+                        return false;
+                  }
+
+                  if( count < size )
+                  {
+                     std::fill( oBuffer + done, oBuffer + done + size, 0 );
+                     if( !ioUnreadable.empty() && ioUnreadable.back().mOffset + ioUnreadable.back().mSize == offset )
+                        ioUnreadable.back().mSize += size;
+                     else
+                        ioUnreadable.push_back( { offset, size } );
+
+                     bad_patch = true;
+                  }
+
+                  done += size;
+                  if( count == size && bad_patch )
+                     break;
+               }
+            }
+
+            mOffset += iSize;
+            return true;
+         }
+
+      private:
+
+         // Read up to iSize bytes, return the bytes read before an error (oError: its errno, 0 at the end of the file)
+         std::size_t ReadAt( char* oBytes, std::size_t iSize, std::uint64_t iOffset, int& oError ) const
+         {
+            std::size_t done = 0;
+            while( done < iSize )
+            {
+               const ssize_t count = mRead( mFile, oBytes + done, iSize - done, off_t( iOffset + done ) );
+               if( count < 0 && errno == EINTR )
+                  continue;
+               if( count <= 0 )
+               {
+                  oError = count < 0 ? errno : 0;
+                  break;
+               }
+
+               done += std::size_t( count );
+            }
+
+            return done;
+         }
+
+         read_function mRead;
+         int           mFile = -1;
+         std::uint64_t mOffset = 0;
+      };
+
+      /*
+         Erasures of the unreadable bytes of a file: the codeword and the symbol each byte belongs to.
+         Both layouts are groups of iGroupBlockCount codewords (1: the contiguous layout), a group
+         being a symbol_count x n matrix of bytes (n: its codewords, less in the last group of a file),
+         codeword j is its column j. The data is data_length symbols per codeword from offset 0, the
+         records of the ecc file iRecordLength bytes per codeword from the end of its header: the
+         fec_length parity symbols, then the crc of the codeword (not a symbol).
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class unreadable_erasures
+      {
+      public:
+
+         static void data( const unreadable_range& iRange, std::uint64_t iDataSize, std::uint64_t iGroupBlockCount, std::vector<codeword_erasure>& ioErasures )
+         {
+            Add( iRange.mOffset, iRange.mSize, iDataSize, iGroupBlockCount, data_length, data_length, 0, ioErasures );
+         }
+
+         // iRange is in offsets of the ecc file, iRecordsOffset is the size of its header
+         static void records( const unreadable_range& iRange, std::uint64_t iRecordsOffset, std::uint64_t iDataSize, std::uint64_t iGroupBlockCount, std::size_t iRecordLength, std::vector<codeword_erasure>& ioErasures )
+         {
+            const std::uint64_t begin = std::max( iRange.mOffset, iRecordsOffset );
+            const std::uint64_t end = std::max( iRange.mOffset + iRange.mSize, iRecordsOffset );
+
+            Add( begin - iRecordsOffset, end - begin, iDataSize, iGroupBlockCount, iRecordLength, fec_length, data_length, ioErasures );
+         }
+
+         // Sorted by codeword then symbol, without duplicates (the order the decoders search)
+         static void sort( std::vector<codeword_erasure>& ioErasures )
+         {
+            auto less = []( const codeword_erasure& iA, const codeword_erasure& iB ) { return iA.mBlock < iB.mBlock || ( iA.mBlock == iB.mBlock && iA.mPosition < iB.mPosition ); };
+            auto equal = []( const codeword_erasure& iA, const codeword_erasure& iB ) { return iA.mBlock == iB.mBlock && iA.mPosition == iB.mPosition; };
+
+            std::sort( ioErasures.begin(), ioErasures.end(), less );
+            ioErasures.erase( std::unique( ioErasures.begin(), ioErasures.end(), equal ), ioErasures.end() );
+         }
+
+      private:
+
+         // Bytes [iOffset, iOffset + iSize) of a file of iRowLength bytes per codeword, the first iSymbolCount of them are symbols from iFirstSymbol
+         static void Add( std::uint64_t iOffset, std::uint64_t iSize, std::uint64_t iDataSize, std::uint64_t iGroupBlockCount, std::size_t iRowLength, std::size_t iSymbolCount, std::size_t iFirstSymbol, std::vector<codeword_erasure>& ioErasures )
+         {
+            const std::uint64_t block_count = ( iDataSize + data_length - 1 ) / data_length;
+            const std::uint64_t group_size = iGroupBlockCount * iRowLength;
+
+            for( std::uint64_t offset = iOffset; offset < iOffset + iSize; ++offset )
+            {
+               const std::uint64_t group = offset / group_size;
+               const std::uint64_t first_block = group * iGroupBlockCount;
+               if( first_block >= block_count )
+                  break;
+
+               const std::uint64_t group_blocks = std::min( iGroupBlockCount, block_count - first_block );
+               const std::uint64_t position = offset - group * group_size;
+               const std::uint64_t symbol = position / group_blocks;
+               if( symbol < iSymbolCount )
+                  ioErasures.push_back( { first_block + position % group_blocks, std::size_t( iFirstSymbol + symbol ) } );
+            }
+         }
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,86 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+/*
+   Description: The SHA-512 of the ingest: the FIPS 180-4 test vectors, the
+                same digest whatever the size of the updates, and a padding
+                which spans one or two blocks.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "ecc-sha512.hpp"
+
+
+bool sha512_validation_test( const std::string& iMessage, std::size_t iRepeat, const std::string& iExpected )
+{
+   // The updates are cut at every size from 1 to 200 bytes, across the 128 bytes blocks
+   for( std::size_t update_size = 1; update_size <= 200; update_size += ( update_size < 130 ? 1 : 35 ) )
+   {
+      std::string message;
+      for( std::size_t i = 0; i < iRepeat; i++ )
+         message += iMessage;
+
+      schifra::sha512 hash;
+      for( std::size_t start = 0; start < message.size(); start += update_size )
+         hash.update( message.data() + start, std::min( update_size, message.size() - start ) );
+
+      const std::string digest = hash.hex_digest();
+      if( digest != iExpected )
+      {
+         std::cout << "Error - SHA-512 of \"" << iMessage.substr( 0, 16 ) << "\" x " << iRepeat << " (updates of " << update_size << " bytes): " << digest << std::endl;
+         return false;
+      }
+
+      if( message.size() > 100000 )
+         break;
+   }
+
+   return true;
+}
+
+int main()
+{
+   bool sha512_validation_result = sha512_validation_test( "", 1, "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e" ) &&
+                                   sha512_validation_test( "abc", 1, "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" ) &&
+                                   sha512_validation_test( "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1, "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909" ) &&
+                                   sha512_validation_test( "a", 1000000, "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" ) &&
+                                   sha512_validation_test( "y", 111, "0462e03e558b3e8322d1f91455f36402ec31358ce5a0b8a90aca93fb6ba55b5f87a246f200cb3b6bb8d43c87ab51c1dbf31c7e5da41364f8ca999a862f1ba9fb" ) &&
+                                   sha512_validation_test( "x", 112, "a3722b515ef40c910f2419f6e0da8ca51d410114ce6272faae64045f9e9f630e7fa8dd5a3243c9860b899d148c3da4bc0f9e07454542604d030bb55531fe0d5b" ) ;
+
+   if( sha512_validation_result )
+   {
+      std::cout << "ECC SHA-512 Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC SHA-512 Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,215 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+
+
+#ifndef INCLUDE_ECC_SHA512_HPP
+#define INCLUDE_ECC_SHA512_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+namespace schifra
+{
+
+   /*
+      SHA-512 (FIPS 180-4), to write the digest of a file while its ecc is computed.
+
+      The digest is the one of sha512sum: update() is fed the bytes in file order
+      (by chunks of any size), hex_digest() finalizes it.
+   */
+   class sha512
+   {
+   public:
+
+      static const std::size_t digest_size = 64;
+
+      sha512()
+      {
+         reset();
+      }
+
+      void reset()
+      {
+         static const std::uint64_t initial_state[8] =
+         {
+            0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL, 0xA54FF53A5F1D36F1ULL,
+            0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL, 0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL
+         };
+
+         std::memcpy( mState, initial_state, sizeof( mState ) );
+         mBufferSize = 0;
+         mTotalSize = 0;
+      }
+
+      void update( const char* iData, std::size_t iSize )
+      {
+         const unsigned char* data = reinterpret_cast<const unsigned char*>( iData );
+         mTotalSize += iSize;
+
+         if( mBufferSize )
+         {
+            const std::size_t size = std::min( iSize, block_size - mBufferSize );
+            std::memcpy( mBuffer + mBufferSize, data, size );
+            mBufferSize += size;
+            data += size;
+            iSize -= size;
+
+            if( mBufferSize < block_size )
+               return;
+
+            Compress( mBuffer );
+            mBufferSize = 0;
+         }
+
+         for( ; iSize >= block_size; data += block_size, iSize -= block_size )
+            Compress( data );
+
+         std::memcpy( mBuffer, data, iSize );
+         mBufferSize = iSize;
+      }
+
+      void digest( unsigned char oDigest[digest_size] )
+      {
+         // Padding: 0x80, zeros, then the size in bits on 128 bits (big endian)
+         const std::uint64_t bit_size = mTotalSize * 8;
+
+         mBuffer[mBufferSize++] = 0x80;
+         if( mBufferSize > block_size - 16 )
+         {
+            std::memset( mBuffer + mBufferSize, 0, block_size - mBufferSize );
+            Compress( mBuffer );
+            mBufferSize = 0;
+         }
+
+         std::memset( mBuffer + mBufferSize, 0, block_size - 8 - mBufferSize );
+         StoreBigEndian( bit_size, mBuffer + block_size - 8 );
+         Compress( mBuffer );
+
+         for( std::size_t i = 0; i < 8; i++ )
+            StoreBigEndian( mState[i], oDigest + i * 8 );
+
+         reset();
+      }
+
+      std::string hex_digest()
+      {
+         unsigned char bytes[digest_size];
+         digest( bytes );
+
+         static const char hex[] = "0123456789abcdef";
+         std::string result( 2 * digest_size, '0' );
+         for( std::size_t i = 0; i < digest_size; i++ )
+         {
+            result[2 * i]     = hex[bytes[i] >> 4];
+            result[2 * i + 1] = hex[bytes[i] & 0x0F];
+         }
+
+         return result;
+      }
+
+   private:
+
+      static const std::size_t block_size = 128;
+
+      static inline std::uint64_t Rotate( std::uint64_t iValue, unsigned int iBits )
+      {
+         return ( iValue >> iBits ) | ( iValue << ( 64 - iBits ) );
+      }
+
+      static inline void StoreBigEndian( std::uint64_t iValue, unsigned char* oBytes )
+      {
+         for( std::size_t i = 0; i < 8; i++ )
+            oBytes[i] = static_cast<unsigned char>( iValue >> ( 56 - 8 * i ) );
+      }
+
+      void Compress( const unsigned char* iBlock )
+      {
+         static const std::uint64_t k[80] =
+         {
+            0x428A2F98D728AE22ULL, 0x7137449123EF65CDULL, 0xB5C0FBCFEC4D3B2FULL, 0xE9B5DBA58189DBBCULL,
+            0x3956C25BF348B538ULL, 0x59F111F1B605D019ULL, 0x923F82A4AF194F9BULL, 0xAB1C5ED5DA6D8118ULL,
+            0xD807AA98A3030242ULL, 0x12835B0145706FBEULL, 0x243185BE4EE4B28CULL, 0x550C7DC3D5FFB4E2ULL,
+            0x72BE5D74F27B896FULL, 0x80DEB1FE3B1696B1ULL, 0x9BDC06A725C71235ULL, 0xC19BF174CF692694ULL,
+            0xE49B69C19EF14AD2ULL, 0xEFBE4786384F25E3ULL, 0x0FC19DC68B8CD5B5ULL, 0x240CA1CC77AC9C65ULL,
+            0x2DE92C6F592B0275ULL, 0x4A7484AA6EA6E483ULL, 0x5CB0A9DCBD41FBD4ULL, 0x76F988DA831153B5ULL,
+            0x983E5152EE66DFABULL, 0xA831C66D2DB43210ULL, 0xB00327C898FB213FULL, 0xBF597FC7BEEF0EE4ULL,
+            0xC6E00BF33DA88FC2ULL, 0xD5A79147930AA725ULL, 0x06CA6351E003826FULL, 0x142929670A0E6E70ULL,
+            0x27B70A8546D22FFCULL, 0x2E1B21385C26C926ULL, 0x4D2C6DFC5AC42AEDULL, 0x53380D139D95B3DFULL,
+            0x650A73548BAF63DEULL, 0x766A0ABB3C77B2A8ULL, 0x81C2C92E47EDAEE6ULL, 0x92722C851482353BULL,
+            0xA2BFE8A14CF10364ULL, 0xA81A664BBC423001ULL, 0xC24B8B70D0F89791ULL, 0xC76C51A30654BE30ULL,
+            0xD192E819D6EF5218ULL, 0xD69906245565A910ULL, 0xF40E35855771202AULL, 0x106AA07032BBD1B8ULL,
+            0x19A4C116B8D2D0C8ULL, 0x1E376C085141AB53ULL, 0x2748774CDF8EEB99ULL, 0x34B0BCB5E19B48A8ULL,
+            0x391C0CB3C5C95A63ULL, 0x4ED8AA4AE3418ACBULL, 0x5B9CCA4F7763E373ULL, 0x682E6FF3D6B2B8A3ULL,
+            0x748F82EE5DEFB2FCULL, 0x78A5636F43172F60ULL, 0x84C87814A1F0AB72ULL, 0x8CC702081A6439ECULL,
+            0x90BEFFFA23631E28ULL, 0xA4506CEBDE82BDE9ULL, 0xBEF9A3F7B2C67915ULL, 0xC67178F2E372532BULL,
+            0xCA273ECEEA26619CULL, 0xD186B8C721C0C207ULL, 0xEADA7DD6CDE0EB1EULL, 0xF57D4F7FEE6ED178ULL,
+            0x06F067AA72176FBAULL, 0x0A637DC5A2C898A6ULL, 0x113F9804BEF90DAEULL, 0x1B710B35131C471BULL,
+            0x28DB77F523047D84ULL, 0x32CAAB7B40C72493ULL, 0x3C9EBE0A15C9BEBCULL, 0x431D67C49C100D4CULL,
+            0x4CC5D4BECB3E42B6ULL, 0x597F299CFC657E2AULL, 0x5FCB6FAB3AD6FAECULL, 0x6C44198C4A475817ULL
+         };
+
+         std::uint64_t w[80];
+         for( std::size_t i = 0; i < 16; i++ )
+         {
+            w[i] = 0;
+            for( std::size_t j = 0; j < 8; j++ )
+               w[i] = ( w[i] << 8 ) | iBlock[i * 8 + j];
+         }
+
+         for( std::size_t i = 16; i < 80; i++ )
+         {
+            const std::uint64_t s0 = Rotate( w[i - 15], 1 ) ^ Rotate( w[i - 15], 8 ) ^ ( w[i - 15] >> 7 );
+            const std::uint64_t s1 = Rotate( w[i - 2], 19 ) ^ Rotate( w[i - 2], 61 ) ^ ( w[i - 2] >> 6 );
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+         }
+
+         std::uint64_t a = mState[0], b = mState[1], c = mState[2], d = mState[3];
+         std::uint64_t e = mState[4], f = mState[5], g = mState[6], h = mState[7];
+
+         for( std::size_t i = 0; i < 80; i++ )
+         {
+            const std::uint64_t t1 = h + ( Rotate( e, 14 ) ^ Rotate( e, 18 ) ^ Rotate( e, 41 ) ) + ( ( e & f ) ^ ( ~e & g ) ) + k[i] + w[i];
+            const std::uint64_t t2 = ( Rotate( a, 28 ) ^ Rotate( a, 34 ) ^ Rotate( a, 39 ) ) + ( ( a & b ) ^ ( a & c ) ^ ( b & c ) );
+
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+         }
+
+         mState[0] += a; mState[1] += b; mState[2] += c; mState[3] += d;
+         mState[4] += e; mState[5] += f; mState[6] += g; mState[7] += h;
+      }
+
+      std::uint64_t mState[8];
+      unsigned char mBuffer[block_size];
+      std::size_t   mBufferSize;
+      std::uint64_t mTotalSize;
+   };
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,293 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The compile-time fields and generator polynomials against
+                the runtime field and make_sequential_root_generator_polynomial,
+                and the codecs, field elements and polynomials on a field
+                building its tables lazily against a field with all its tables.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_decoder.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+#include "ecc-static-field.hpp"
+
+
+using schifra::galois::primitive_polynomial_bits;
+
+typedef schifra::galois::static_field<8,primitive_polynomial_bits( schifra::galois::primitive_polynomial06, schifra::galois::primitive_polynomial_size06 )> field06_t;
+typedef schifra::galois::static_field<8,primitive_polynomial_bits( schifra::galois::primitive_polynomial05, schifra::galois::primitive_polynomial_size05 )> field05_t;
+typedef schifra::galois::static_field<4,primitive_polynomial_bits( schifra::galois::primitive_polynomial01, schifra::galois::primitive_polynomial_size01 )> field01_t;
+
+// Evaluated by the compiler
+static_assert( field06_t::alpha( 0 ) == 1 && field06_t::alpha( 1 ) == 2 && field06_t::alpha( 255 ) == 1, "alpha^0, alpha^1 and alpha^255" );
+static_assert( field06_t::mul( 0x53, field06_t::div( 1, 0x53 ) ) == 1, "inverse" );
+static_assert( schifra::galois::static_generator<field06_t,120,32>::coefficient( 32 ) == 1, "monic generator" );
+
+template <typename static_field_type>
+bool field_validation_test( const unsigned int iFieldDescriptor, const std::size_t iPolynomialSize, const unsigned int iPolynomial[] )
+{
+   const schifra::galois::field field( iFieldDescriptor, iPolynomialSize, iPolynomial );
+   const unsigned int size = static_field_type::size;
+
+   for( unsigned int i = 0; i < 2 * size; ++i )
+   {
+      if( static_field_type::alpha( i ) != field.alpha( i % size ) || ( i && i < size && static_field_type::index( std::uint8_t( i ) ) != std::size_t( field.index( i ) ) ) )
+      {
+         std::cout << "Error - Static field of " << iFieldDescriptor << " bits: alpha/index of " << i << std::endl;
+         return false;
+      }
+   }
+
+   for( unsigned int a = 0; a <= size; ++a )
+   {
+      for( unsigned int b = 0; b <= size; ++b )
+      {
+         if( static_field_type::mul( std::uint8_t( a ), std::uint8_t( b ) ) != field.mul( a, b ) ||
+             static_field_type::div( std::uint8_t( a ), std::uint8_t( b ) ) != field.div( a, b ) ||
+             static_field_type::exp( std::uint8_t( a ), b ) != field.exp( a, b ) )
+         {
+            std::cout << "Error - Static field of " << iFieldDescriptor << " bits: " << a << " and " << b << std::endl;
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+template <typename static_field_type, std::size_t gen_poly_index, std::size_t fec_length>
+bool generator_validation_test( const unsigned int iFieldDescriptor, const std::size_t iPolynomialSize, const unsigned int iPolynomial[] )
+{
+   typedef schifra::galois::static_generator<static_field_type,gen_poly_index,fec_length> generator_t;
+
+   const schifra::galois::field field( iFieldDescriptor, iPolynomialSize, iPolynomial );
+
+   schifra::galois::field_polynomial expected( field );
+   if( !schifra::make_sequential_root_generator_polynomial( field, gen_poly_index, fec_length, expected ) )
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const schifra::galois::field_polynomial generator = generator_t::polynomial( field );
+   if( generator != expected || expected.deg() != static_cast<int>( fec_length ) )
+   {
+      std::cout << "Error - Static generator of RS(" << static_field_type::size << "," << static_field_type::size - fec_length << "), index " << gen_poly_index << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+// The codecs of the tool on a field without tables: same parity, same decoding, and only the tables they use
+bool lazy_field_validation_test()
+{
+   const std::size_t code_length = 255;
+   const std::size_t fec_length  =  32;
+   const std::size_t data_length = code_length - fec_length;
+
+   typedef schifra::reed_solomon::batch_encoder<code_length,fec_length>  encoder_t;
+   typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length>  decoder_t;
+   typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length> syndrome_t;
+   typedef schifra::galois::static_generator<field06_t,120,fec_length>   generator_t;
+
+   const schifra::galois::field field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
+   const schifra::galois::field lazy_field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06, schifra::galois::field::e_no_tables );
+
+   schifra::galois::field_polynomial generator( field );
+   schifra::make_sequential_root_generator_polynomial( field, 120, fec_length, generator );
+
+   const encoder_t encoder( field, generator );
+   const encoder_t lazy_encoder( lazy_field, generator_t::polynomial( lazy_field ) );
+   const syndrome_t lazy_syndrome( lazy_field, 120 );
+
+   const std::size_t block_count = 50;
+   std::vector<unsigned char> data( block_count * data_length );
+   for( auto& byte : data )
+      byte = static_cast<unsigned char>( ::rand() );
+
+   std::vector<unsigned char> parity( block_count * fec_length );
+   std::vector<unsigned char> lazy_parity( parity.size() );
+   encoder.encode_batch( data.data(), block_count, parity.data() );
+   lazy_encoder.encode_batch( data.data(), block_count, lazy_parity.data() );
+   if( parity != lazy_parity )
+   {
+      std::cout << "Error - Encoder on a field without tables" << std::endl;
+      return false;
+   }
+
+   // The decoder builds the tables it uses at its first decoding
+   const decoder_t lazy_decoder( lazy_field, 120 );
+   decoder_t::workspace* ws = new decoder_t::workspace;
+
+   bool result = true;
+   for( std::size_t block = 0; result && block < block_count; ++block )
+   {
+      std::vector<unsigned char> codeword( data.begin() + block * data_length, data.begin() + ( block + 1 ) * data_length );
+      codeword.insert( codeword.end(), parity.begin() + block * fec_length, parity.begin() + ( block + 1 ) * fec_length );
+      const std::vector<unsigned char> original( codeword );
+
+      // Errors, then errors and erasures
+      std::vector<std::size_t> erasures;
+      for( std::size_t i = 0; i < fec_length / 2; ++i )
+      {
+         const std::size_t position = ( block + i * 13 ) % code_length;
+         codeword[position] ^= static_cast<unsigned char>( 1 + i );
+         if( block % 2 )
+            erasures.push_back( position );
+      }
+      if( block % 2 )
+      {
+         for( std::size_t i = 0; i < fec_length / 2; ++i )
+         {
+            const std::size_t position = ( block + 7 + i * 13 ) % code_length;
+            codeword[position] ^= 0x5A;
+            erasures.push_back( position );
+         }
+      }
+
+      unsigned char flag = 0;
+      if( !lazy_syndrome.check_batch( codeword.data(), codeword.data() + data_length, 1, &flag ) ||
+          !lazy_decoder.decode( codeword.data(), codeword.data() + data_length, erasures.data(), erasures.size(), *ws ) ||
+          codeword != original )
+      {
+         std::cout << "Error - Decoder on a field without tables, block " << block << std::endl;
+         result = false;
+      }
+   }
+
+   delete ws;
+
+   return result;
+}
+
+// The arithmetic of field_element, field_polynomial and the generic codecs on fields without tables: each prepares what it uses
+bool lazy_arithmetic_validation_test()
+{
+   const std::size_t code_length = 255;
+   const std::size_t fec_length  =  32;
+
+   typedef schifra::reed_solomon::encoder<code_length,fec_length> encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length> decoder_t;
+
+   const schifra::galois::field field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06 );
+
+   for( unsigned int a = 0; a <= field.size(); a += 7 )
+   {
+      for( unsigned int b = 1; b <= field.size(); b += 11 )
+      {
+         const schifra::galois::field lazy_field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06, schifra::galois::field::e_no_tables );
+
+         schifra::galois::field_element product( lazy_field, a );
+         schifra::galois::field_element quotient( lazy_field, a );
+         schifra::galois::field_element power( lazy_field, a );
+         product *= b;
+         quotient /= b;
+         power ^= b;
+
+         if( product.poly() != field.mul( a, b ) || quotient.poly() != field.div( a, b ) || power.poly() != field.exp( a, b ) || schifra::galois::field_element( lazy_field, b ).inverse() != field.inverse( b ) )
+         {
+            std::cout << "Error - Field element on a field without tables: " << a << " and " << b << std::endl;
+            return false;
+         }
+      }
+   }
+
+   const schifra::galois::field lazy_field( 8, schifra::galois::primitive_polynomial_size06, schifra::galois::primitive_polynomial06, schifra::galois::field::e_no_tables );
+   const schifra::galois::field_polynomial generator = schifra::galois::static_generator<field06_t,120,fec_length>::polynomial( lazy_field );
+   for( unsigned int i = 0; i < fec_length; ++i )
+   {
+      if( generator( lazy_field.alpha( 120 + i ) ).poly() != 0 )
+      {
+         std::cout << "Error - Field polynomial on a field without tables: alpha^" << 120 + i << " isn't a root" << std::endl;
+         return false;
+      }
+   }
+
+   const encoder_t encoder( lazy_field, generator );
+   const decoder_t decoder( lazy_field, 120 );
+
+   std::string message( code_length - fec_length, '\0' );
+   for( auto& byte : message )
+      byte = static_cast<char>( ::rand() );
+
+   schifra::reed_solomon::block<code_length,fec_length> block;
+   if( !encoder.encode( message, block ) )
+   {
+      std::cout << "Error - Encoder on a field without tables" << std::endl;
+      return false;
+   }
+
+   const schifra::reed_solomon::block<code_length,fec_length> original( block );
+   for( std::size_t i = 0; i < fec_length / 2; ++i )
+      block[i * 15] ^= 0x33;
+
+   if( !decoder.decode( block ) || !std::equal( &block[0], &block[0] + code_length, &original[0] ) )
+   {
+      std::cout << "Error - Decoder on a field without tables" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand( 0x6F1E1D );
+
+   using namespace schifra::galois;
+
+   if( field_validation_test<field06_t>( 8, primitive_polynomial_size06, primitive_polynomial06 ) &&
+       field_validation_test<field05_t>( 8, primitive_polynomial_size05, primitive_polynomial05 ) &&
+       field_validation_test<field01_t>( 4, primitive_polynomial_size01, primitive_polynomial01 ) &&
+       generator_validation_test<field06_t,120,32>( 8, primitive_polynomial_size06, primitive_polynomial06 ) &&
+       generator_validation_test<field05_t,  1,16>( 8, primitive_polynomial_size05, primitive_polynomial05 ) &&
+       generator_validation_test<field01_t,  0, 6>( 4, primitive_polynomial_size01, primitive_polynomial01 ) &&
+       lazy_field_validation_test() &&
+       lazy_arithmetic_validation_test() )
+   {
+      std::cout << "ECC Static Field Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "ECC Static Field Validation Failure!" << std::endl;
+      return 1;
+   }
+}
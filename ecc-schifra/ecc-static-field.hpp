@@ -0,0 +1,198 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_ECC_STATIC_FIELD_HPP
+#define INCLUDE_ECC_STATIC_FIELD_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_element.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      // Bit i: coefficient of x^i of a primitive polynomial (iPolynomial: the coefficients, as the primitive_polynomialXX arrays)
+      constexpr std::uint32_t primitive_polynomial_bits( const unsigned int* iPolynomial, std::size_t iSize )
+      {
+         std::uint32_t bits = 0;
+         for( std::size_t i = 0; i < iSize; ++i )
+            bits |= std::uint32_t( iPolynomial[i] ? 1 : 0 ) << i;
+
+         return bits;
+      }
+
+      namespace details
+      {
+
+         template <unsigned int size>
+         struct static_field_tables
+         {
+            std::uint8_t mAlphaTo[2 * size] = {}; // Twice the period: the sum of two logs needs no modulo
+            std::uint8_t mIndexOf[size + 1] = {};
+            bool         mPrimitive = true;
+         };
+
+         template <unsigned int field_descriptor, std::uint32_t primitive_polynomial, unsigned int size = ( 1u << field_descriptor ) - 1>
+         constexpr static_field_tables<size> generate_static_field()
+         {
+            static_field_tables<size> result;
+
+            unsigned int symbol = 1;
+            for( unsigned int i = 0; i < size; ++i )
+            {
+               // alpha^i coming back to 1 before the end: alpha isn't a generator of the field
+               if( i && symbol == 1 )
+                  result.mPrimitive = false;
+
+               result.mAlphaTo[i] = result.mAlphaTo[i + size] = std::uint8_t( symbol );
+               result.mIndexOf[symbol] = std::uint8_t( i );
+
+               symbol <<= 1;
+               if( symbol >> field_descriptor )
+                  symbol ^= primitive_polynomial;
+            }
+
+            return result;
+         }
+
+         template <std::size_t fec_length>
+         struct static_generator_terms
+         {
+            std::uint8_t mTerm[fec_length + 1] = {};
+         };
+
+         // Multiplied by ( x + root ) for each root: term j becomes term j - 1 + root * term j
+         template <typename field_type, std::size_t gen_poly_index, std::size_t fec_length>
+         constexpr static_generator_terms<fec_length> generate_static_generator()
+         {
+            static_generator_terms<fec_length> result;
+            result.mTerm[0] = 1;
+
+            for( std::size_t k = 0; k < fec_length; ++k )
+            {
+               const std::uint8_t root = field_type::alpha( gen_poly_index + k );
+               for( std::size_t j = k + 1; j > 0; --j )
+                  result.mTerm[j] = std::uint8_t( result.mTerm[j - 1] ^ field_type::mul( result.mTerm[j], root ) );
+               result.mTerm[0] = field_type::mul( result.mTerm[0], root );
+            }
+
+            return result;
+         }
+
+      } // namespace details
+
+      /*
+         GF(2^m), m <= 8, computed at compile time: the antilog and log tables are bytes of
+         read-only data (768 bytes for GF(2^8)), the products are two lookups in them.
+         The same field as galois::field( m, ..., primitive polynomial ), without building it.
+      */
+      template <unsigned int field_descriptor, std::uint32_t primitive_polynomial>
+      class static_field
+      {
+      public:
+
+         static_assert( field_descriptor >= 2 && field_descriptor <= 8, "static_field: symbols of 2 to 8 bits" );
+         static_assert( primitive_polynomial >> field_descriptor == 1, "static_field: the primitive polynomial must be of degree field_descriptor" );
+
+         static constexpr unsigned int size = ( 1u << field_descriptor ) - 1;
+
+         // alpha^i, i < 2 * size
+         static constexpr std::uint8_t alpha( std::size_t iPower )
+         {
+            return mTables.mAlphaTo[iPower];
+         }
+
+         // log of a non-zero symbol
+         static constexpr std::size_t index( std::uint8_t iSymbol )
+         {
+            return mTables.mIndexOf[iSymbol];
+         }
+
+         static constexpr std::uint8_t mul( std::uint8_t iA, std::uint8_t iB )
+         {
+            return iA && iB ? alpha( index( iA ) + index( iB ) ) : 0;
+         }
+
+         static constexpr std::uint8_t div( std::uint8_t iA, std::uint8_t iB )
+         {
+            return iA && iB ? alpha( index( iA ) + size - index( iB ) ) : 0;
+         }
+
+         // 0 for 0^n, n >= 0, as galois::field
+         static constexpr std::uint8_t exp( std::uint8_t iA, std::size_t iPower )
+         {
+            return iA ? alpha( ( index( iA ) * iPower ) % size ) : 0;
+         }
+
+      private:
+
+         static constexpr details::static_field_tables<size> mTables = details::generate_static_field<field_descriptor,primitive_polynomial>();
+
+         static_assert( mTables.mPrimitive, "static_field: the polynomial isn't primitive" );
+      };
+
+      /*
+         The generator polynomial of a Reed-Solomon code over a static_field, computed at compile time:
+         the product of ( x + alpha^i ) for i in [gen_poly_index, gen_poly_index + fec_length),
+         as make_sequential_root_generator_polynomial.
+      */
+      template <typename field_type, std::size_t gen_poly_index, std::size_t fec_length>
+      class static_generator
+      {
+      public:
+
+         static_assert( gen_poly_index < field_type::size && gen_poly_index + fec_length <= field_type::size, "static_generator: the roots must be distinct powers of alpha" );
+
+         // Coefficient of x^i, i <= fec_length (the generator is monic)
+         static constexpr std::uint8_t coefficient( std::size_t iTerm )
+         {
+            return mCoefficients.mTerm[iTerm];
+         }
+
+         // The generator as a polynomial of iField, the same field as field_type
+         static field_polynomial polynomial( const field& iField )
+         {
+            field_polynomial result( iField, fec_length );
+            for( std::size_t i = 0; i <= fec_length; ++i )
+               result[i] = field_element( iField, coefficient( i ) );
+
+            return result;
+         }
+
+      private:
+
+         static constexpr details::static_generator_terms<fec_length> mCoefficients = details::generate_static_generator<field_type,gen_poly_index,fec_length>();
+      };
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,192 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_ECC_THREAD_POOL_HPP
+#define INCLUDE_ECC_THREAD_POOL_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Persistent pool of worker threads, each one with its own task queue.
+
+         - tasks are spread round robin over the queues
+         - a worker takes its tasks from the front of its queue, and when it is empty,
+           steals from the back of the other queues (so that a worker stuck on an expensive
+           task, like a region full of corrected codewords, doesn't hold back the others)
+         - the time spent running tasks is accumulated per worker
+      */
+      class work_stealing_pool
+      {
+      public:
+
+         typedef std::function<void()> task_t;
+
+         explicit work_stealing_pool( std::size_t iThreadCount )
+         : mQueues( iThreadCount ? iThreadCount : 1 ),
+           mBusyNanoseconds( mQueues.size() ),
+           mTaskCounts( mQueues.size() )
+         {
+            for( std::size_t i = 0; i < mQueues.size(); i++ )
+               mThreads.push_back( std::thread( [this, i]{ WorkerLoop( i ); } ) );
+         }
+
+         ~work_stealing_pool()
+         {
+            {
+               std::lock_guard<std::mutex> lock( mMutex );
+               mStop = true;
+            }
+            mCondition.notify_all();
+
+            for( auto& thread : mThreads )
+               thread.join();
+         }
+
+         std::size_t thread_count() const
+         {
+            return mThreads.size();
+         }
+
+         void submit( const task_t& iTask )
+         {
+            const std::size_t queue_index = mNextQueue++ % mQueues.size();
+            {
+               std::lock_guard<std::mutex> lock( mQueues[queue_index].mMutex );
+               mQueues[queue_index].mTasks.push_back( iTask );
+            }
+
+            {
+               std::lock_guard<std::mutex> lock( mMutex );
+               mQueuedTasks++;
+            }
+            mCondition.notify_one();
+         }
+
+         // Time spent by the worker running tasks, in seconds
+         double busy_time( std::size_t iWorker ) const
+         {
+            return double( mBusyNanoseconds[iWorker] ) / 1e9;
+         }
+
+         std::uint64_t task_count( std::size_t iWorker ) const
+         {
+            return mTaskCounts[iWorker];
+         }
+
+      private:
+
+         struct worker_queue
+         {
+            std::mutex          mMutex;
+            std::deque<task_t>  mTasks;
+         };
+
+         // The caller has reserved a task (mQueuedTasks), so there is one in some queue
+         task_t TakeTask( std::size_t iWorker )
+         {
+            for( ;; )
+            {
+               for( std::size_t i = 0; i < mQueues.size(); i++ )
+               {
+                  worker_queue& queue = mQueues[( iWorker + i ) % mQueues.size()];
+                  std::lock_guard<std::mutex> lock( queue.mMutex );
+                  if( queue.mTasks.empty() )
+                     continue;
+
+                  task_t task;
+                  if( i == 0 )
+                  {
+                     task = std::move( queue.mTasks.front() );
+                     queue.mTasks.pop_front();
+                  }
+                  else
+                  {
+                     task = std::move( queue.mTasks.back() );
+                     queue.mTasks.pop_back();
+                  }
+
+                  return task;
+               }
+
+               std::this_thread::yield();
+            }
+         }
+
+         void WorkerLoop( std::size_t iWorker )
+         {
+            for( ;; )
+            {
+               {
+                  std::unique_lock<std::mutex> lock( mMutex );
+                  mCondition.wait( lock, [this]{ return mStop || mQueuedTasks; } );
+                  if( !mQueuedTasks )
+                     return;
+
+                  mQueuedTasks--;
+               }
+
+               task_t task = TakeTask( iWorker );
+
+               const auto start = std::chrono::steady_clock::now();
+               task();
+               const auto duration = std::chrono::steady_clock::now() - start;
+
+               mBusyNanoseconds[iWorker] += std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count();
+               mTaskCounts[iWorker]++;
+            }
+         }
+
+         std::vector<worker_queue>               mQueues;
+         std::vector<std::thread>                mThreads;
+         std::atomic<std::size_t>                mNextQueue { 0 };
+
+         std::mutex                              mMutex;
+         std::condition_variable                 mCondition;
+         std::size_t                             mQueuedTasks = 0;
+         bool                                    mStop = false;
+
+         std::vector<std::atomic<std::uint64_t>> mBusyNanoseconds;
+         std::vector<std::atomic<std::uint64_t>> mTaskCounts;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
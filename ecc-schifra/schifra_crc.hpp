@@ -24,13 +24,81 @@
 #define INCLUDE_SCHIFRA_CRC_HPP
 
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(NO_CRCSIMD)
+   #define SCHIFRA_CRC_SIMD_X86
+   #include <immintrin.h>
+#endif
+
 
 namespace schifra
 {
 
+   /*
+      Engines of crc32::update(const unsigned char[]), from the slowest to the
+      fastest. sse42 is the crc32 instruction, it only computes CRC32C
+      (key 0x82F63B78); pclmul folds 64 bytes per iteration with carry-less
+      multiplications, for any reflected 32 bit key.
+   */
+   enum crc_engine
+   {
+      e_crc_table    = 0,
+      e_crc_slicing8 = 1,
+      e_crc_pclmul   = 2,
+      e_crc_sse42    = 3
+   };
+
+   const std::size_t crc32c_key = 0x82F63B78;
+
+   inline bool crc_engine_supported(const crc_engine engine, const std::size_t key)
+   {
+      if (key > 0xFFFFFFFF)
+      {
+         return (e_crc_table == engine);
+      }
+
+      #if defined(SCHIFRA_CRC_SIMD_X86)
+         __builtin_cpu_init();
+
+         switch (engine)
+         {
+            case e_crc_sse42  : return (crc32c_key == key) && __builtin_cpu_supports("sse4.2");
+            case e_crc_pclmul : return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+            default           : return true;
+         }
+      #else
+         return (e_crc_table == engine) || (e_crc_slicing8 == engine);
+      #endif
+   }
+
+   // The CPU is probed for every key, the engines are cheap to test
+   inline crc_engine detect_crc_engine(const std::size_t key)
+   {
+      crc_engine engine = e_crc_sse42;
+
+      while ((engine != e_crc_table) && !crc_engine_supported(engine, key))
+      {
+         engine = static_cast<crc_engine>(engine - 1);
+      }
+
+      return engine;
+   }
+
+   inline const char* crc_engine_name(const crc_engine engine)
+   {
+      switch (engine)
+      {
+         case e_crc_slicing8 : return "slicing8";
+         case e_crc_pclmul   : return "pclmul";
+         case e_crc_sse42    : return "sse42";
+         default             : return "table";
+      }
+   }
+
    class crc32
    {
    public:
@@ -40,9 +108,11 @@ namespace schifra
       crc32(const crc32_t& _key, const crc32_t& _state = 0x00)
       : key(_key),
         state(_state),
-        initial_state(_state)
+        initial_state(_state),
+        engine_(detect_crc_engine(_key))
       {
          initialize_crc32_table();
+         initialize_fold_constants();
       }
 
       void reset()
@@ -50,16 +120,34 @@ namespace schifra
          state = initial_state;
       }
 
+      // Every overload of update goes through this definition (or an engine equal to it)
       void update_1byte(const unsigned char data)
       {
-         state = (state >> 8) ^ table[data];
+         state = (state >> 8) ^ table[(state ^ data) & 0xFF];
       }
 
       void update(const unsigned char data[], const std::size_t& count)
       {
-         for (std::size_t i = 0; i < count; ++i)
+         const unsigned char* end = data + count;
+
+         switch (engine_)
          {
-            update_1byte(data[i]);
+            #if defined(SCHIFRA_CRC_SIMD_X86)
+            case e_crc_sse42  : data = update_sse42(data, end);
+                                break;
+
+            case e_crc_pclmul : data = update_slicing8(update_pclmul(data, end), end);
+                                break;
+            #endif
+            case e_crc_slicing8 : data = update_slicing8(data, end);
+                                  break;
+
+            default : break;
+         }
+
+         for (; data != end; ++data)
+         {
+            state = (state >> 8) ^ table[(state ^ *data) & 0xFF];
          }
       }
 
@@ -92,13 +180,45 @@ namespace schifra
          return state;
       }
 
+      crc_engine engine() const
+      {
+         return engine_;
+      }
+
+      // Force an engine (validation, benchmarks), false if the CPU or the key does not support it
+      bool set_engine(const crc_engine engine)
+      {
+         if (!crc_engine_supported(engine, key))
+            return false;
+
+         engine_ = engine;
+         return true;
+      }
+
+      /*
+         crc of A|B from crc1 = crc of A and crc2 = crc of B, both started from
+         the initial state: crc1.x^(8.length2) + crc2 + initial_state.x^(8.length2)
+         mod the polynomial. The parts of a buffer can then be computed by as
+         many threads (or engines) as wanted, and merged in O(log(length2)).
+         The values are the states (crc()), not the final ones (~crc()).
+      */
+      crc32_t combine(const crc32_t crc1, const crc32_t crc2, const std::size_t length2) const
+      {
+         if (0 == length2)
+            return crc1;
+
+         const crc32_t shift = x2n_mod_p(length2, 3);
+
+         return multiply_mod_p(shift, crc1 ^ initial_state) ^ crc2;
+      }
+
    private:
 
       crc32& operator=(const crc32&);
 
       void initialize_crc32_table()
       {
-         for (std::size_t i = 0; i < 0xFF; ++i)
+         for (std::size_t i = 0; i < 0x100; ++i)
          {
             crc32_t reg = i;
 
@@ -109,14 +229,290 @@ namespace schifra
 
             table[i] = reg;
          }
+
+         // slice[k][i]: crc of the byte i followed by k zero bytes
+         for (std::size_t i = 0; i < 0x100; ++i)
+         {
+            slice[0][i] = static_cast<std::uint32_t>(table[i]);
+
+            for (std::size_t k = 1; k < 8; ++k)
+            {
+               slice[k][i] = (slice[k - 1][i] >> 8) ^ static_cast<std::uint32_t>(table[slice[k - 1][i] & 0xFF]);
+            }
+         }
+      }
+
+      /*
+         Reflected arithmetic mod the polynomial (bit 31 is x^0, as zlib):
+         a.b, and x^(n.2^k) by squarings of x.
+      */
+      crc32_t multiply_mod_p(crc32_t a, crc32_t b) const
+      {
+         crc32_t product = 0;
+
+         for (crc32_t m = crc32_t(1) << 31; m != 0; m >>= 1)
+         {
+            if (a & m)
+            {
+               product ^= b;
+            }
+
+            b = (b & 1) ? (b >> 1) ^ key : b >> 1;
+         }
+
+         return product;
+      }
+
+      crc32_t x2n_mod_p(std::size_t n, unsigned int k) const
+      {
+         crc32_t x2k = crc32_t(1) << 30; // x^1
+
+         for (unsigned int i = 0; i < k; ++i)
+         {
+            x2k = multiply_mod_p(x2k, x2k);
+         }
+
+         crc32_t product = crc32_t(1) << 31; // x^0
+
+         for (; n != 0; n >>= 1)
+         {
+            if (n & 1)
+            {
+               product = multiply_mod_p(x2k, product);
+            }
+
+            x2k = multiply_mod_p(x2k, x2k);
+         }
+
+         return product;
+      }
+
+      /*
+         Constants of the folding (Intel, "Fast CRC Computation Using PCLMULQDQ"):
+            k(n) = x^n mod P, reflected and shifted to 33 bits
+            mu   = x^64 / P, reflected on 33 bits
+         computed for the key instead of hardcoded for a single polynomial.
+      */
+      void initialize_fold_constants()
+      {
+         if (key > 0xFFFFFFFF)
+            return;
+
+         fold_4x128[0] = static_cast<std::uint64_t>(x2n_mod_p(4 * 128 + 32, 0)) << 1;
+         fold_4x128[1] = static_cast<std::uint64_t>(x2n_mod_p(4 * 128 - 32, 0)) << 1;
+         fold_128  [0] = static_cast<std::uint64_t>(x2n_mod_p(    128 + 32, 0)) << 1;
+         fold_128  [1] = static_cast<std::uint64_t>(x2n_mod_p(    128 - 32, 0)) << 1;
+         fold_64   [0] = static_cast<std::uint64_t>(x2n_mod_p(          64, 0)) << 1;
+         fold_64   [1] = 0;
+
+         // Quotient of x^64 by the normal form of the polynomial (x^32 + reflected key)
+         std::uint64_t normal = std::uint64_t(1) << 32;
+
+         for (unsigned int i = 0; i < 32; ++i)
+         {
+            normal |= static_cast<std::uint64_t>((key >> i) & 1) << (31 - i);
+         }
+
+         std::uint64_t remainder = 0;
+         std::uint64_t quotient  = 0;
+
+         for (int i = 64; i >= 0; --i)
+         {
+            remainder = (remainder << 1) | ((64 == i) ? 1 : 0);
+
+            if (remainder & (std::uint64_t(1) << 32))
+            {
+               quotient  |= std::uint64_t(1) << i;
+               remainder ^= normal;
+            }
+         }
+
+         std::uint64_t mu = 0;
+
+         for (unsigned int i = 0; i < 33; ++i)
+         {
+            mu |= ((quotient >> i) & 1) << (32 - i);
+         }
+
+         barrett[0] = (static_cast<std::uint64_t>(key) << 1) | 1;
+         barrett[1] = mu;
+      }
+
+      // 8 bytes per iteration, little endian loads from bytes: any alignment, any endianness
+      const unsigned char* update_slicing8(const unsigned char* data, const unsigned char* end)
+      {
+         std::uint32_t crc = static_cast<std::uint32_t>(state);
+
+         for (; (end - data) >= 8; data += 8)
+         {
+            const std::uint32_t low = crc ^ (static_cast<std::uint32_t>(data[0])         |
+                                             (static_cast<std::uint32_t>(data[1]) <<  8) |
+                                             (static_cast<std::uint32_t>(data[2]) << 16) |
+                                             (static_cast<std::uint32_t>(data[3]) << 24));
+
+            crc = slice[7][(low      ) & 0xFF] ^
+                  slice[6][(low >>  8) & 0xFF] ^
+                  slice[5][(low >> 16) & 0xFF] ^
+                  slice[4][(low >> 24)       ] ^
+                  slice[3][data[4]] ^
+                  slice[2][data[5]] ^
+                  slice[1][data[6]] ^
+                  slice[0][data[7]];
+         }
+
+         state = crc;
+
+         return data;
+      }
+
+      #if defined(SCHIFRA_CRC_SIMD_X86)
+
+      __attribute__((target("sse4.2")))
+      const unsigned char* update_sse42(const unsigned char* data, const unsigned char* end)
+      {
+         #if defined(__x86_64__)
+            std::uint64_t crc = static_cast<std::uint32_t>(state);
+
+            for (; (end - data) >= 8; data += 8)
+            {
+               std::uint64_t word;
+               __builtin_memcpy(&word, data, sizeof(word));
+               crc = _mm_crc32_u64(crc, word);
+            }
+         #else
+            std::uint32_t crc = static_cast<std::uint32_t>(state);
+
+            for (; (end - data) >= 4; data += 4)
+            {
+               std::uint32_t word;
+               __builtin_memcpy(&word, data, sizeof(word));
+               crc = _mm_crc32_u32(crc, word);
+            }
+         #endif
+
+         for (; data != end; ++data)
+         {
+            crc = _mm_crc32_u8(static_cast<std::uint32_t>(crc), *data);
+         }
+
+         state = static_cast<std::uint32_t>(crc);
+
+         return data;
       }
 
+      /*
+         Folding by 4 x 128 bits, then to 128 bits, then 16 bytes at a time,
+         reduced to 64 bits then to 32 bits (Barrett), as zlib's crc32_simd.
+         Only the multiple of 16 bytes (at least 64) is folded, the tail is
+         left to the tables.
+      */
+      __attribute__((target("pclmul,sse4.1")))
+      const unsigned char* update_pclmul(const unsigned char* data, const unsigned char* end)
+      {
+         std::size_t length = static_cast<std::size_t>(end - data);
+
+         if (length < 64)
+            return data;
+
+         length &= ~static_cast<std::size_t>(15);
+
+         __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+         x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+         x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+         x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+         x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+
+         x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(static_cast<std::uint32_t>(state))));
+
+         x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fold_4x128));
+
+         data   += 64;
+         length -= 64;
+
+         for (; length >= 64; data += 64, length -= 64)
+         {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+         }
+
+         // 4 x 128 -> 128
+         x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fold_128));
+
+         x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+         x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+         x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+         x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+         x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+         x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+         x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+         x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+         x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+         for (; length >= 16; data += 16, length -= 16)
+         {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+         }
+
+         // 128 -> 64
+         x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+         x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+         x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+         x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fold_64));
+
+         x2 = _mm_srli_si128(x1, 4);
+         x1 = _mm_and_si128(x1, x3);
+         x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+         x1 = _mm_xor_si128(x1, x2);
+
+         // 64 -> 32
+         x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(barrett));
+
+         x2 = _mm_and_si128(x1, x3);
+         x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+         x2 = _mm_and_si128(x2, x3);
+         x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+         x1 = _mm_xor_si128(x1, x2);
+
+         state = static_cast<std::uint32_t>(_mm_extract_epi32(x1, 1));
+
+         return data;
+      }
+
+      #endif
+
    protected:
 
       crc32_t key;
       crc32_t state;
       const crc32_t initial_state;
       crc32_t table[256];
+
+   private:
+
+      crc_engine    engine_;
+      std::uint32_t slice[8][256];
+      std::uint64_t fold_4x128[2];
+      std::uint64_t fold_128[2];
+      std::uint64_t fold_64[2];
+      std::uint64_t barrett[2];
    };
 
    class schifra_crc : public crc32
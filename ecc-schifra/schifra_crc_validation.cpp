@@ -0,0 +1,237 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: Every engine of crc32::update (tables, slicing-by-8, SSE4.2,
+                PCLMULQDQ folding) against the byte at a time reference and
+                the per-byte path (update_1byte) of the other overloads, for
+                CRC32 and CRC32C, the check values, random lengths and
+                alignments, the folding constants and crc32::combine, and
+                every overload of update on the same bytes.
+*/
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra_crc.hpp"
+
+
+typedef schifra::crc32::crc32_t crc32_t;
+
+// The reference: one byte at a time, straight from the definition of a reflected crc
+crc32_t reference_crc(const crc32_t key, crc32_t state, const unsigned char data[], const std::size_t count)
+{
+   for (std::size_t i = 0; i < count; ++i)
+   {
+      state ^= data[i];
+
+      for (int j = 0; j < 8; ++j)
+      {
+         state = (state & 1) ? (state >> 1) ^ key : state >> 1;
+      }
+   }
+
+   return state;
+}
+
+crc32_t engine_crc(const crc32_t key, const schifra::crc_engine engine, const unsigned char data[], const std::size_t count)
+{
+   schifra::crc32 crc(key, 0xFFFFFFFF);
+   crc.set_engine(engine);
+   crc.update(data, count);
+   return crc.crc();
+}
+
+// Every overload of update on the same bytes: unsigned char[], char[], std::string, std::size_t and update_1byte
+bool overload_validation_test(const crc32_t key, const crc32_t check)
+{
+   char digits[] = "123456789";
+   const std::string text(digits);
+   const char* names[] = { "unsigned char[]", "char[]", "std::string", "update_1byte", "std::size_t" };
+
+   schifra::crc32 crc(key, 0xFFFFFFFF);
+   crc.set_engine(schifra::e_crc_table);
+
+   for (std::size_t overload = 0; overload < 5; ++overload)
+   {
+      crc.reset();
+
+      switch (overload)
+      {
+         case 0 : crc.update(reinterpret_cast<const unsigned char*>(digits), text.size());
+                  break;
+
+         case 1 : crc.update(digits, text.size());
+                  break;
+
+         case 2 : crc.update(text);
+                  break;
+
+         case 3 : for (std::size_t i = 0; i < text.size(); ++i)
+                  {
+                     crc.update_1byte(static_cast<unsigned char>(text[i]));
+                  }
+                  break;
+
+         default : crc.update(static_cast<std::size_t>(0x34333231)); // "1234", least significant byte first
+                   crc.update(text.substr(4));
+                   break;
+      }
+
+      if ((~crc.crc() & 0xFFFFFFFF) != check)
+      {
+         std::cout << "Error - update(" << names[overload] << "): wrong check value" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool crc_validation_test(const crc32_t key, const crc32_t check)
+{
+   const unsigned char digits[] = "123456789";
+
+   std::vector<unsigned char> buffer(70000);
+
+   // The per-byte path (update_1byte) of the char[] overload, every engine must agree with it
+   schifra::crc32 bytewise(key, 0xFFFFFFFF);
+
+   for (std::size_t i = 0; i < buffer.size(); ++i)
+   {
+      buffer[i] = static_cast<unsigned char>(::rand());
+   }
+
+   for (int e = schifra::e_crc_table; e <= schifra::e_crc_sse42; ++e)
+   {
+      const schifra::crc_engine engine = static_cast<schifra::crc_engine>(e);
+
+      if (!schifra::crc_engine_supported(engine, key))
+      {
+         std::cout << "Engine " << schifra::crc_engine_name(engine) << " not available, skipped" << std::endl;
+         continue;
+      }
+
+      if ((~engine_crc(key, engine, digits, 9) & 0xFFFFFFFF) != check)
+      {
+         std::cout << "Error - " << schifra::crc_engine_name(engine) << ": wrong check value" << std::endl;
+         return false;
+      }
+
+      // Every length around the 16 / 64 byte steps of the folding, then random ones, at every alignment
+      for (std::size_t round = 0; round < 2000; ++round)
+      {
+         const std::size_t offset = round % 16;
+         const std::size_t length = (round < 300) ? round : static_cast<std::size_t>(::rand()) % (buffer.size() - 16);
+
+         const crc32_t expected = reference_crc(key, 0xFFFFFFFF, &buffer[offset], length);
+
+         const crc32_t crc_of_engine = engine_crc(key, engine, &buffer[offset], length);
+
+         if (crc_of_engine != expected)
+         {
+            std::cout << "Error - " << schifra::crc_engine_name(engine) << ": wrong crc, length: " << length << " offset: " << offset << std::endl;
+            return false;
+         }
+
+         bytewise.reset();
+         bytewise.update(reinterpret_cast<char*>(&buffer[offset]), length);
+
+         if (bytewise.crc() != crc_of_engine)
+         {
+            std::cout << "Error - " << schifra::crc_engine_name(engine) << ": not the crc of update(char[]), length: " << length << " offset: " << offset << std::endl;
+            return false;
+         }
+
+         // The same bytes in two updates
+         schifra::crc32 crc(key, 0xFFFFFFFF);
+         crc.set_engine(engine);
+         crc.update(&buffer[offset], length / 3);
+         crc.update(&buffer[offset + length / 3], length - length / 3);
+
+         if (crc.crc() != expected)
+         {
+            std::cout << "Error - " << schifra::crc_engine_name(engine) << ": wrong crc in two updates, length: " << length << std::endl;
+            return false;
+         }
+      }
+   }
+
+   // The parts of a buffer, each computed on its own, then merged
+   schifra::crc32 crc(key, 0xFFFFFFFF);
+
+   for (std::size_t round = 0; round < 200; ++round)
+   {
+      const std::size_t length = static_cast<std::size_t>(::rand()) % buffer.size();
+      const std::size_t parts  = 1 + static_cast<std::size_t>(::rand()) % 8;
+
+      crc32_t combined = 0xFFFFFFFF;
+      std::size_t begin = 0;
+
+      for (std::size_t part = 0; part < parts; ++part)
+      {
+         const std::size_t end = (part + 1 == parts) ? length : begin + static_cast<std::size_t>(::rand()) % (length - begin + 1);
+
+         crc.reset();
+         crc.update(&buffer[begin], end - begin);
+         combined = crc.combine(combined, crc.crc(), end - begin);
+
+         begin = end;
+      }
+
+      if (combined != reference_crc(key, 0xFFFFFFFF, &buffer[0], length))
+      {
+         std::cout << "Error - Wrong combined crc, length: " << length << " parts: " << parts << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   ::srand(0xC3C32);
+
+   std::cout << "Best CRC32 engine:  " << schifra::crc_engine_name(schifra::detect_crc_engine(0xEDB88320)) << std::endl;
+   std::cout << "Best CRC32C engine: " << schifra::crc_engine_name(schifra::detect_crc_engine(schifra::crc32c_key)) << std::endl;
+
+   if (
+        overload_validation_test(0xEDB88320, 0xCBF43926) &&
+        overload_validation_test(schifra::crc32c_key, 0xE3069283) &&
+        crc_validation_test(0xEDB88320, 0xCBF43926) &&
+        crc_validation_test(schifra::crc32c_key, 0xE3069283)
+      )
+   {
+      std::cout << "Schifra CRC Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra CRC Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -25,9 +25,11 @@
 
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <limits>
+#include <mutex>
 #include <string>
 
 
@@ -40,13 +42,39 @@ namespace schifra
       typedef int          field_symbol;
       const   field_symbol GFERROR = -1;
 
+      /*
+         The lookup tables of the arithmetic (mul, div, exp, inverse) are
+         (field_size + 1)^2 symbols each: a field can be created with only
+         some of them, the others are built when a codec prepares them
+         (once, the next preparations are a single atomic load).
+      */
       class field
       {
       public:
 
-         field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly);
+         enum table_set
+         {
+            e_no_tables        =  0,
+            e_mul_table        =  1,
+            e_div_table        =  2,
+            e_exp_table        =  4,
+            e_inverse_table    =  8,
+            e_linear_exp_table = 16,
+            e_all_tables       = 31
+         };
+
+         field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly, const unsigned int tables = e_all_tables);
         ~field();
 
+         // Build the tables not built yet among the given ones (before mul, div, exp or inverse use them), thread safe
+         void prepare(const unsigned int tables) const;
+
+         // Table-free arithmetic (log/antilog), for the one-off computations building the tables of the codecs
+         field_symbol gen_mul       (const field_symbol& a, const field_symbol& b) const;
+         field_symbol gen_div       (const field_symbol& a, const field_symbol& b) const;
+         field_symbol gen_exp       (const field_symbol& a, const std::size_t&  n) const;
+         field_symbol gen_inverse   (const field_symbol& val) const;
+
          bool operator==(const field& gf) const;
          bool operator!=(const field& gf) const;
 
@@ -101,6 +129,11 @@ namespace schifra
             return x;
          }
 
+         /*
+            mul, div, exp and inverse look up their table: on a field created
+            without it, prepare() it first (field_element, field_polynomial and
+            the codecs do), or use the table-free gen_* functions.
+         */
          inline field_symbol mul(const field_symbol& a, const field_symbol& b) const
          {
             #if !defined(NO_GFLUT)
@@ -191,77 +224,42 @@ namespace schifra
          field(const field& gfield);
          field& operator=(const field& gfield);
 
-         void         generate_field(const unsigned int* prim_poly_);
-         field_symbol gen_mul       (const field_symbol& a, const field_symbol& b) const;
-         field_symbol gen_div       (const field_symbol& a, const field_symbol& b) const;
-         field_symbol gen_exp       (const field_symbol& a, const std::size_t&  n) const;
-         field_symbol gen_inverse   (const field_symbol& val) const;
-
-         std::size_t create_array(char buffer_[],
-                                  const std::size_t& length,
-                                  const std::size_t offset,
-                                  field_symbol** array);
-
-         std::size_t create_2d_array(char buffer_[],
-                                     std::size_t row_cnt, std::size_t col_cnt,
-                                     const std::size_t offset,
-                                     field_symbol*** array);
-         unsigned int   power_;
-         std::size_t    prim_poly_deg_;
-         unsigned int   field_size_;
-         unsigned int   prim_poly_hash_;
-         unsigned int*  prim_poly_;
-         field_symbol*  alpha_to_;    // aka exponential or anti-log
-         field_symbol*  index_of_;    // aka log
-         field_symbol*  mul_inverse_; // multiplicative inverse
-         field_symbol** mul_table_;
-         field_symbol** div_table_;
-         field_symbol** exp_table_;
-         field_symbol** linear_exp_table_;
-         char*          buffer_;
+         void generate_field(const unsigned int* prim_poly_);
+         void build_tables(const unsigned int tables) const;
+
+         static field_symbol** create_table (const std::size_t row_count, const std::size_t column_count);
+         static void           destroy_table(field_symbol** table);
+
+         unsigned int           power_;
+         std::size_t            prim_poly_deg_;
+         unsigned int           field_size_;
+         unsigned int           prim_poly_hash_;
+         unsigned int*          prim_poly_;
+         field_symbol*          alpha_to_;    // aka exponential or anti-log
+         field_symbol*          index_of_;    // aka log
+         mutable field_symbol*  mul_inverse_; // multiplicative inverse
+         mutable field_symbol** mul_table_;
+         mutable field_symbol** div_table_;
+         mutable field_symbol** exp_table_;
+         mutable field_symbol** linear_exp_table_;
+         mutable std::mutex     tables_mutex_;
+         mutable std::atomic<unsigned int> prepared_tables_;
       };
 
-      inline field::field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly)
+      inline field::field(const int  pwr, const std::size_t primpoly_deg, const unsigned int* primitive_poly, const unsigned int tables)
       : power_(pwr),
         prim_poly_deg_(primpoly_deg),
-        field_size_((1 << power_) - 1)
+        field_size_((1 << power_) - 1),
+        mul_inverse_(0),
+        mul_table_(0),
+        div_table_(0),
+        exp_table_(0),
+        linear_exp_table_(0),
+        prepared_tables_(e_no_tables)
       {
          alpha_to_    = new field_symbol [field_size_ + 1];
          index_of_    = new field_symbol [field_size_ + 1];
 
-         #if !defined(NO_GFLUT)
-
-         #ifdef LINEAR_EXP_LUT
-         static const std::size_t buffer_size = ((6 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
-         #else
-         static const std::size_t buffer_size = ((4 * (field_size_ + 1) * (field_size_ + 1)) + ((field_size_ + 1) * 2)) * sizeof(field_symbol);
-         #endif
-
-         buffer_ = new char[buffer_size];
-         std::size_t offset = 0;
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&mul_table_);
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&div_table_);
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1),offset,&exp_table_);
-
-         #ifdef LINEAR_EXP_LUT
-         offset = create_2d_array(buffer_,(field_size_ + 1),(field_size_ + 1) * 2,offset,&linear_exp_table_);
-         #else
-         linear_exp_table_ = 0;
-         #endif
-
-         offset = create_array(buffer_,(field_size_ + 1) * 2,offset,&mul_inverse_);
-
-         #else
-
-           buffer_      = 0;
-           mul_table_   = 0;
-           div_table_   = 0;
-           exp_table_   = 0;
-           mul_inverse_ = 0;
-           linear_exp_table_ = 0;
-
-         #endif
-
          prim_poly_ = new unsigned int [prim_poly_deg_ + 1];
 
          for (unsigned int i = 0; i < (prim_poly_deg_ + 1); ++i)
@@ -278,6 +276,8 @@ namespace schifra
          }
 
          generate_field(primitive_poly);
+
+         prepare(tables);
       }
 
       inline field::~field()
@@ -286,17 +286,119 @@ namespace schifra
          if (0 !=  index_of_) { delete [] index_of_;  index_of_  = 0; }
          if (0 != prim_poly_) { delete [] prim_poly_; prim_poly_ = 0; }
 
+         if (0 != mul_inverse_) { delete [] mul_inverse_; mul_inverse_ = 0; }
+
+         destroy_table(mul_table_);
+         destroy_table(div_table_);
+         destroy_table(exp_table_);
+         destroy_table(linear_exp_table_);
+      }
+
+      inline void field::prepare(const unsigned int tables) const
+      {
          #if !defined(NO_GFLUT)
 
-         if (0 != mul_table_) { delete [] mul_table_; mul_table_ = 0; }
-         if (0 != div_table_) { delete [] div_table_; div_table_ = 0; }
-         if (0 != exp_table_) { delete [] exp_table_; exp_table_ = 0; }
+           if ((prepared_tables_.load(std::memory_order_acquire) & tables) != tables)
+           {
+              build_tables(tables);
+           }
+
+         #else
+
+           (void)tables;
 
-         #ifdef LINEAR_EXP_LUT
-         if (0 != linear_exp_table_) { delete [] linear_exp_table_; linear_exp_table_ = 0; }
          #endif
+      }
+
+      inline void field::build_tables(const unsigned int tables) const
+      {
+         #if !defined(NO_GFLUT)
+
+           std::lock_guard<std::mutex> lock(tables_mutex_);
+
+           // Each table is filled before being published
+           const field_symbol size = static_cast<field_symbol>(field_size_ + 1);
+
+           if ((tables & e_mul_table) && (0 == mul_table_))
+           {
+              field_symbol** table = create_table(size, size);
+
+              for (field_symbol i = 0; i < size; ++i)
+              {
+                 for (field_symbol j = 0; j < size; ++j)
+                 {
+                    table[i][j] = gen_mul(i,j);
+                 }
+              }
+
+              mul_table_ = table;
+           }
+
+           if ((tables & e_div_table) && (0 == div_table_))
+           {
+              field_symbol** table = create_table(size, size);
+
+              for (field_symbol i = 0; i < size; ++i)
+              {
+                 for (field_symbol j = 0; j < size; ++j)
+                 {
+                    table[i][j] = gen_div(i,j);
+                 }
+              }
+
+              div_table_ = table;
+           }
+
+           if ((tables & e_exp_table) && (0 == exp_table_))
+           {
+              field_symbol** table = create_table(size, size);
+
+              for (field_symbol i = 0; i < size; ++i)
+              {
+                 for (field_symbol j = 0; j < size; ++j)
+                 {
+                    table[i][j] = gen_exp(i,j);
+                 }
+              }
+
+              exp_table_ = table;
+           }
+
+           #ifdef LINEAR_EXP_LUT
+           if ((tables & e_linear_exp_table) && (0 == linear_exp_table_))
+           {
+              field_symbol** table = create_table(size, size * 2);
+
+              for (field_symbol i = 0; i < size; ++i)
+              {
+                 for (int j = 0; j < static_cast<field_symbol>(2 * field_size_); ++j)
+                 {
+                    table[i][j] = gen_exp(i,j);
+                 }
+              }
+
+              linear_exp_table_ = table;
+           }
+           #endif
+
+           if ((tables & e_inverse_table) && (0 == mul_inverse_))
+           {
+              field_symbol* table = new field_symbol [size * 2];
+
+              for (field_symbol i = 0; i < size; ++i)
+              {
+                 table[i] = gen_inverse(i);
+                 table[i + size] = table[i];
+              }
+
+              mul_inverse_ = table;
+           }
+
+           prepared_tables_.fetch_or(tables, std::memory_order_release);
+
+         #else
 
-         if (0 != buffer_) { delete [] buffer_; buffer_ = 0; }
+           (void)tables;
 
          #endif
       }
@@ -355,36 +457,6 @@ namespace schifra
 
          index_of_[0] = GFERROR;
          alpha_to_[field_size_] = 1;
-
-         #if !defined(NO_GFLUT)
-
-           for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
-           {
-              for (field_symbol j = 0; j < static_cast<field_symbol>(field_size_ + 1); ++j)
-              {
-                 mul_table_[i][j] = gen_mul(i,j);
-                 div_table_[i][j] = gen_div(i,j);
-                 exp_table_[i][j] = gen_exp(i,j);
-              }
-           }
-
-           #ifdef LINEAR_EXP_LUT
-           for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
-           {
-              for (int j = 0; j < static_cast<field_symbol>(2 * field_size_); ++j)
-              {
-                 linear_exp_table_[i][j] = gen_exp(i,j);
-              }
-           }
-           #endif
-
-           for (field_symbol i = 0; i < static_cast<field_symbol>(field_size_ + 1); ++i)
-           {
-              mul_inverse_[i] = gen_inverse(i);
-              mul_inverse_[i + (field_size_ + 1)] = mul_inverse_[i];
-           }
-
-         #endif
       }
 
       inline field_symbol field::gen_mul(const field_symbol& a, const field_symbol& b) const
@@ -416,29 +488,27 @@ namespace schifra
          return alpha_to_[normalize(field_size_ - index_of_[val])];
       }
 
-      inline std::size_t field::create_array(char buffer[],
-                                             const std::size_t& length,
-                                             const std::size_t offset,
-                                             field_symbol** array)
+      inline field_symbol** field::create_table(const std::size_t row_count, const std::size_t column_count)
       {
-         const std::size_t row_size = length * sizeof(field_symbol);
-         (*array) = new(buffer + offset)field_symbol[length];
-         return row_size + offset;
+         field_symbol** table = new field_symbol* [row_count];
+
+         table[0] = new field_symbol [row_count * column_count];
+
+         for (std::size_t i = 1; i < row_count; ++i)
+         {
+            table[i] = table[0] + (i * column_count);
+         }
+
+         return table;
       }
 
-      inline std::size_t field::create_2d_array(char buffer[],
-                                                std::size_t row_cnt, std::size_t col_cnt,
-                                                const std::size_t offset,
-                                                field_symbol*** array)
+      inline void field::destroy_table(field_symbol** table)
       {
-         const std::size_t row_size = col_cnt * sizeof(field_symbol);
-         char* buffer__offset = buffer + offset;
-         (*array) = new field_symbol* [row_cnt];
-         for (std::size_t i = 0; i < row_cnt; ++i)
+         if (0 != table)
          {
-            (*array)[i] = new(buffer__offset + (i * row_size))field_symbol[col_cnt];
+            delete [] table[0];
+            delete [] table;
          }
-         return (row_cnt * row_size) + offset;
       }
 
       inline std::ostream& operator << (std::ostream& os, const field& gf)
@@ -452,64 +522,64 @@ namespace schifra
       }
 
       /* 1x^0 + 1x^1 + 0x^2 + 1x^3 */
-      const unsigned int primitive_polynomial00[]    = {1, 1, 0, 1};
-      const unsigned int primitive_polynomial_size00 = 4;
+      constexpr unsigned int primitive_polynomial00[]    = {1, 1, 0, 1};
+      constexpr unsigned int primitive_polynomial_size00 = 4;
 
       /* 1x^0 + 1x^1 + 0x^2 + 0x^3 + 1x^4*/
-      const unsigned int primitive_polynomial01[]    = {1, 1, 0, 0, 1};
-      const unsigned int primitive_polynomial_size01 = 5;
+      constexpr unsigned int primitive_polynomial01[]    = {1, 1, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size01 = 5;
 
       /* 1x^0 + 0x^1 + 1x^2 + 0x^3 + 0x^4 + 1x^5 */
-      const unsigned int primitive_polynomial02[]    = {1, 0, 1, 0, 0, 1};
-      const unsigned int primitive_polynomial_size02 = 6;
+      constexpr unsigned int primitive_polynomial02[]    = {1, 0, 1, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size02 = 6;
 
       /* 1x^0 + 1x^1 + 0x^2 + 0x^3 + 0x^4 + 0x^5 + 1x^6 */
-      const unsigned int primitive_polynomial03[]    = {1, 1, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size03 = 7;
+      constexpr unsigned int primitive_polynomial03[]    = {1, 1, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size03 = 7;
 
       /* 1x^0 + 0x^1 + 0x^2 + 1x^3 + 0x^4 + 0x^5 + 0x^6 + 1x^7 */
-      const unsigned int primitive_polynomial04[]    = {1, 0, 0, 1, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size04 = 8;
+      constexpr unsigned int primitive_polynomial04[]    = {1, 0, 0, 1, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size04 = 8;
 
       /* 1x^0 + 0x^1 + 1x^2 + 1x^3 + 1x^4 + 0x^5 + 0x^6 + 0x^7 + 1x^8 */
-      const unsigned int primitive_polynomial05[]    = {1, 0, 1, 1, 1, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size05 = 9;
+      constexpr unsigned int primitive_polynomial05[]    = {1, 0, 1, 1, 1, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size05 = 9;
 
       /* 1x^0 + 1x^1 + 1x^2 + 0x^3 + 0x^4 + 0x^5 + 0x^6 + 1x^7 + 1x^8 */
-      const unsigned int primitive_polynomial06[]    = {1, 1, 1, 0, 0, 0, 0, 1, 1};
-      const unsigned int primitive_polynomial_size06 = 9;
+      constexpr unsigned int primitive_polynomial06[]    = {1, 1, 1, 0, 0, 0, 0, 1, 1};
+      constexpr unsigned int primitive_polynomial_size06 = 9;
 
       /* 1x^0 + 0x^1 + 0x^2 + 0x^3 + 1x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 1x^9 */
-      const unsigned int primitive_polynomial07[]    = {1, 0, 0, 0, 1, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size07 = 10;
+      constexpr unsigned int primitive_polynomial07[]    = {1, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size07 = 10;
 
       /* 1x^0 + 0x^1 + 0x^2 + 1x^3 + 0x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 0x^9 + 1x^10 */
-      const unsigned int primitive_polynomial08[]    = {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size08 = 11;
+      constexpr unsigned int primitive_polynomial08[]    = {1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size08 = 11;
 
       /* 1x^0 + 0x^1 + 1x^2 + 0x^3 + 0x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 0x^9 + 0x^10 + 1x^11 */
-      const unsigned int primitive_polynomial09[]    = {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size09 = 12;
+      constexpr unsigned int primitive_polynomial09[]    = {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size09 = 12;
 
       /* 1x^0 + 1x^1 + 0x^2 + 0x^3 + 1x^4 + 0x^5 + 1x^6 + 0x^7 + 0x^8 + 0x^9 + 0x^10 + 0x^11 + 1x^12 */
-      const unsigned int primitive_polynomial10[]    = {1, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size10 = 13;
+      constexpr unsigned int primitive_polynomial10[]    = {1, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size10 = 13;
 
       /* 1x^0 + 1x^1 + 0x^2 + 1x^3 + 1x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 0x^9 + 0x^10 + 0x^11 + 0x^12 + 1x^13 */
-      const unsigned int primitive_polynomial11[]    = {1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size11 = 14;
+      constexpr unsigned int primitive_polynomial11[]    = {1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size11 = 14;
 
       /* 1x^0 + 1x^1 + 0x^2 + 0x^3 + 0x^4 + 0x^5 + 1x^6 + 0x^7 + 0x^8 + 0x^9 + 1x^10 + 0x^11 + 0x^12 + 0x^13 + 1x^14 */
-      const unsigned int primitive_polynomial12[]    = {1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size12 = 15;
+      constexpr unsigned int primitive_polynomial12[]    = {1, 1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size12 = 15;
 
       /* 1x^0 + 1x^1 + 0x^2 + 0x^3 + 0x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 0x^9 + 0x^10 + 0x^11 + 0x^12 + 0x^13 + 0x^14 + 1x^15 */
-      const unsigned int primitive_polynomial13[]    = {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size13 = 16;
+      constexpr unsigned int primitive_polynomial13[]    = {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size13 = 16;
 
       /* 1x^0 + 1x^1 + 0x^2 + 1x^3 + 0x^4 + 0x^5 + 0x^6 + 0x^7 + 0x^8 + 0x^9 + 0x^10 + 0x^11 + 1x^12 + 0x^13 + 0x^14 + 0x^15 + 1x^16 */
-      const unsigned int primitive_polynomial14[]    = {1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1};
-      const unsigned int primitive_polynomial_size14 = 17;
+      constexpr unsigned int primitive_polynomial14[]    = {1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1};
+      constexpr unsigned int primitive_polynomial_size14 = 17;
 
    } // namespace galois
 
@@ -100,30 +100,35 @@ namespace schifra
 
          inline field_element& operator *= (const field_element& gfe)
          {
+            field_.prepare(field::e_mul_table);
             poly_value_ = field_.mul(poly_value_, gfe.poly_value_);
             return *this;
          }
 
          inline field_element& operator *= (const field_symbol& v)
          {
+            field_.prepare(field::e_mul_table);
             poly_value_ = field_.mul(poly_value_, v);
             return *this;
          }
 
          inline field_element& operator /= (const field_element& gfe)
          {
+            field_.prepare(field::e_div_table);
             poly_value_ = field_.div(poly_value_, gfe.poly_value_);
             return *this;
          }
 
          inline field_element& operator /= (const field_symbol& v)
          {
+            field_.prepare(field::e_div_table);
             poly_value_ = field_.div(poly_value_, v);
             return *this;
          }
 
          inline field_element& operator ^= (const int& n)
          {
+            field_.prepare(field::e_exp_table);
             poly_value_ = field_.exp(poly_value_,n);
             return *this;
          }
@@ -190,6 +195,7 @@ namespace schifra
 
          inline field_symbol inverse() const
          {
+            field_.prepare(field::e_inverse_table);
             return field_.inverse(poly_value_);
          }
 
@@ -479,6 +479,8 @@ namespace schifra
 
          if (!poly_.empty())
          {
+            field_.prepare(field::e_mul_table | field::e_exp_table);
+
             int i = 0;
             field_symbol total_sum = 0 ;
             field_symbol value_poly_form = value.poly();
@@ -498,6 +500,8 @@ namespace schifra
       {
          if (!poly_.empty())
          {
+            field_.prepare(field::e_mul_table | field::e_exp_table);
+
             int i = 0;
             field_symbol total_sum = 0 ;
             field_symbol value_poly_form = value.poly();
@@ -517,6 +521,8 @@ namespace schifra
       {
          if (!poly_.empty())
          {
+            field_.prepare(field::e_mul_table | field::e_exp_table);
+
             int i = 0;
             field_symbol total_sum = 0 ;
 
@@ -535,6 +541,8 @@ namespace schifra
       {
          if (!poly_.empty())
          {
+            field_.prepare(field::e_mul_table | field::e_exp_table);
+
             int i = 0;
             field_symbol total_sum = 0 ;
 
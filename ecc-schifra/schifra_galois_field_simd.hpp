@@ -0,0 +1,191 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_GALOIS_FIELD_SIMD_HPP
+#define INCLUDE_SCHIFRA_GALOIS_FIELD_SIMD_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "schifra_galois_field.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(NO_GFSIMD)
+   #define SCHIFRA_GALOIS_SIMD_X86
+   #include <immintrin.h>
+#endif
+
+
+namespace schifra
+{
+
+   namespace galois
+   {
+
+      /*
+         Split-nibble multiplication by a constant c in GF(2^8):
+            c.x = lo[x & 0x0F] ^ hi[x >> 4]
+         Each half is a 16 entry table, the size of a pshufb lookup.
+      */
+      struct nibble_table
+      {
+         unsigned char lo[16];
+         unsigned char hi[16];
+
+         void assign(const field& gfield, const field_symbol c)
+         {
+            for (field_symbol x = 0; x < 16; ++x)
+            {
+               lo[x] = static_cast<unsigned char>(gfield.gen_mul(c, x     ));
+               hi[x] = static_cast<unsigned char>(gfield.gen_mul(c, x << 4));
+            }
+         }
+
+         inline unsigned char mul(const unsigned char x) const
+         {
+            return lo[x & 0x0F] ^ hi[x >> 4];
+         }
+      };
+
+      /*
+         Multiplication by a constant c in GF(2^8) as an 8x8 bit matrix, the
+         layout of the GF2P8AFFINEQB instruction: byte (7 - i) of the matrix
+         is row i, bit j of the row is bit i of c.x^j. Being linear over
+         GF(2), the product works for any primitive polynomial.
+      */
+      struct affine_matrix
+      {
+         std::uint64_t bits;
+
+         void assign(const field& gfield, const field_symbol c)
+         {
+            bits = 0;
+
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+               std::uint64_t row = 0;
+
+               for (unsigned int j = 0; j < 8; ++j)
+               {
+                  row |= static_cast<std::uint64_t>((gfield.gen_mul(c, 1 << j) >> i) & 1) << j;
+               }
+
+               bits |= row << (8 * (7 - i));
+            }
+         }
+      };
+
+      #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+      // Four copies of a 16 byte table, one per 128 bit lane
+      __attribute__((target("avx512f")))
+      inline __m512i broadcast_table_avx512(const unsigned char table[])
+      {
+         return _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+      }
+
+      #endif
+
+      /*
+         Engines of the batch kernels, from the slowest to the fastest.
+         gfni is GF2P8AFFINEQB on 512 bit vectors, so it also needs AVX-512BW.
+      */
+      enum simd_level
+      {
+         e_simd_scalar   = 0,
+         e_simd_ssse3    = 1,
+         e_simd_avx2     = 2,
+         e_simd_avx512bw = 3,
+         e_simd_gfni     = 4
+      };
+
+      inline bool simd_level_supported(const simd_level level)
+      {
+         #if defined(SCHIFRA_GALOIS_SIMD_X86)
+            __builtin_cpu_init();
+
+            switch (level)
+            {
+               case e_simd_gfni     : if (!__builtin_cpu_supports("gfni")) return false;
+                                      /* fall through */
+               case e_simd_avx512bw : if (!__builtin_cpu_supports("avx512bw")) return false;
+                                      /* fall through */
+               case e_simd_avx2     : if (!__builtin_cpu_supports("avx2")) return false;
+                                      /* fall through */
+               case e_simd_ssse3    : return __builtin_cpu_supports("ssse3");
+               default              : return true;
+            }
+         #else
+            return (e_simd_scalar == level);
+         #endif
+      }
+
+      // The CPU is probed once, the best engine is then reused by every kernel
+      inline simd_level detect_simd_level()
+      {
+         static const simd_level best = []
+         {
+            simd_level level = e_simd_gfni;
+
+            while ((level != e_simd_scalar) && !simd_level_supported(level))
+            {
+               level = static_cast<simd_level>(level - 1);
+            }
+
+            return level;
+         }();
+
+         return best;
+      }
+
+      inline const char* simd_level_name(const simd_level level)
+      {
+         switch (level)
+         {
+            case e_simd_ssse3    : return "ssse3";
+            case e_simd_avx2     : return "avx2";
+            case e_simd_avx512bw : return "avx512bw";
+            case e_simd_gfni     : return "gfni";
+            default              : return "scalar";
+         }
+      }
+
+      inline bool simd_level_from_name(const std::string& name, simd_level& level)
+      {
+         for (int i = e_simd_scalar; i <= e_simd_gfni; ++i)
+         {
+            if (name == simd_level_name(static_cast<simd_level>(i)))
+            {
+               level = static_cast<simd_level>(i);
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+   } // namespace galois
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,188 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The constant multiplication tables of the SIMD kernels
+                (split-nibble tables, GF2P8AFFINEQB bit matrices) against
+                field.mul for every constant and every symbol of the GF(2^8)
+                fields, and the names and detection of the engines.
+*/
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_simd.hpp"
+
+
+// Product of the documented layout: bit i of c.x is the parity of row i (byte 7 - i) and x
+unsigned char affine_product(const schifra::galois::affine_matrix& matrix, const unsigned char x)
+{
+   unsigned char product = 0;
+
+   for (unsigned int i = 0; i < 8; ++i)
+   {
+      const unsigned int row = static_cast<unsigned int>((matrix.bits >> (8 * (7 - i))) & 0xFF) & x;
+      product |= static_cast<unsigned char>(__builtin_parity(row) << i);
+   }
+
+   return product;
+}
+
+#if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+// Product by the instruction itself, 16 symbols at a time
+__attribute__((target("gfni")))
+void affine_product_gfni(const schifra::galois::affine_matrix& matrix, const unsigned char x[], unsigned char product[])
+{
+   const __m128i bits = _mm_set1_epi64x(static_cast<long long>(matrix.bits));
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(product), _mm_gf2p8affine_epi64_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)), bits, 0));
+}
+
+#endif
+
+bool field_simd_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[])
+{
+   const schifra::galois::field field(8, prim_poly_size, prim_poly);
+
+   const bool gfni = schifra::galois::simd_level_supported(schifra::galois::e_simd_gfni);
+
+   for (schifra::galois::field_symbol c = 0; c < 256; ++c)
+   {
+      schifra::galois::nibble_table  table;
+      schifra::galois::affine_matrix matrix;
+
+      table.assign(field, c);
+      matrix.assign(field, c);
+
+      unsigned char symbols[256];
+      unsigned char products[256];
+
+      for (schifra::galois::field_symbol x = 0; x < 256; ++x)
+      {
+         symbols[x] = static_cast<unsigned char>(x);
+
+         const unsigned char expected = static_cast<unsigned char>(field.mul(c, x));
+
+         if ((table.mul(symbols[x]) != expected) || (affine_product(matrix, symbols[x]) != expected))
+         {
+            std::cout << "Error - Constant multiplication mismatch: " << c << "." << x << std::endl;
+            return false;
+         }
+      }
+
+      #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+      if (gfni)
+      {
+         for (std::size_t x = 0; x < 256; x += 16)
+         {
+            affine_product_gfni(matrix, symbols + x, products + x);
+         }
+
+         for (schifra::galois::field_symbol x = 0; x < 256; ++x)
+         {
+            if (products[x] != static_cast<unsigned char>(field.mul(c, x)))
+            {
+               std::cout << "Error - GF2P8AFFINEQB product mismatch: " << c << "." << x << std::endl;
+               return false;
+            }
+         }
+      }
+
+      #else
+         (void)gfni;
+         (void)products;
+      #endif
+   }
+
+   return true;
+}
+
+bool simd_level_validation_test()
+{
+   using namespace schifra::galois;
+
+   if (!simd_level_supported(e_simd_scalar) || !simd_level_supported(detect_simd_level()))
+   {
+      std::cout << "Error - Unsupported engine detected" << std::endl;
+      return false;
+   }
+
+   for (int i = e_simd_scalar; i <= e_simd_gfni; ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+      simd_level parsed_level = e_simd_scalar;
+
+      if (!simd_level_from_name(simd_level_name(level), parsed_level) || (parsed_level != level))
+      {
+         std::cout << "Error - Engine name mismatch: " << simd_level_name(level) << std::endl;
+         return false;
+      }
+
+      // The engines are ordered: each one needs the features of the previous ones
+      if (simd_level_supported(level) && (i > e_simd_scalar) && !simd_level_supported(static_cast<simd_level>(i - 1)))
+      {
+         std::cout << "Error - Engine supported without the previous one: " << simd_level_name(level) << std::endl;
+         return false;
+      }
+
+      if (simd_level_supported(level) && (level > detect_simd_level()))
+      {
+         std::cout << "Error - Engine better than the detected one: " << simd_level_name(level) << std::endl;
+         return false;
+      }
+   }
+
+   simd_level parsed_level = e_simd_scalar;
+
+   if (simd_level_from_name("sse9", parsed_level))
+   {
+      std::cout << "Error - Unknown engine name accepted" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   bool field_simd_validation_result = field_simd_validation_test(primitive_polynomial_size05,primitive_polynomial05) &&
+                                       field_simd_validation_test(primitive_polynomial_size06,primitive_polynomial06) &&
+                                       simd_level_validation_test();
+
+   if (field_simd_validation_result)
+   {
+      std::cout << "Schifra Galois Field SIMD Successfully Validated! (engine: " << simd_level_name(detect_simd_level()) << ")" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Galois Field SIMD Validation Failure!" << std::endl;
+      return 1;
+   }
+}
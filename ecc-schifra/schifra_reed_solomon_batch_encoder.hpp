@@ -0,0 +1,443 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_BATCH_ENCODER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_BATCH_ENCODER_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_ecc_traits.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+         /*
+            The vector kernels encode one codeword per byte lane: the data
+            of 'lanes' consecutive codewords is first transposed into a
+            tile where row d holds symbol d of every codeword, then the
+            LFSR runs on whole rows, each register cell being a vector.
+         */
+
+         template <std::size_t lanes, std::size_t data_length>
+         inline void gather_tile(const unsigned char data[], unsigned char tile[])
+         {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+               const unsigned char* block_data = data + (lane * data_length);
+
+               for (std::size_t d = 0; d < data_length; ++d)
+               {
+                  tile[(d * lanes) + lane] = block_data[d];
+               }
+            }
+         }
+
+         template <std::size_t lanes, std::size_t fec_length>
+         inline void scatter_tile(const unsigned char tile[], unsigned char fec[])
+         {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+               unsigned char* block_fec = fec + (lane * fec_length);
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  block_fec[i] = tile[(i * lanes) + lane];
+               }
+            }
+         }
+
+         #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("ssse3")))
+         inline void batch_parity_ssse3(const galois::nibble_table table[], const unsigned char data[], unsigned char fec[])
+         {
+            const std::size_t lanes = 16;
+
+            alignas(16) unsigned char tile[data_length * lanes];
+            gather_tile<lanes,data_length>(data, tile);
+
+            __m128i tlo[fec_length];
+            __m128i thi[fec_length];
+            __m128i reg[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].lo));
+               thi[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].hi));
+               reg[i] = _mm_setzero_si128();
+            }
+
+            const __m128i mask = _mm_set1_epi8(0x0F);
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const __m128i feedback = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(tile + (d * lanes))), reg[0]);
+               const __m128i lo = _mm_and_si128(feedback, mask);
+               const __m128i hi = _mm_and_si128(_mm_srli_epi16(feedback, 4), mask);
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  reg[i] = _mm_xor_si128(reg[i + 1], _mm_xor_si128(_mm_shuffle_epi8(tlo[i], lo), _mm_shuffle_epi8(thi[i], hi)));
+               }
+
+               reg[fec_length - 1] = _mm_xor_si128(_mm_shuffle_epi8(tlo[fec_length - 1], lo), _mm_shuffle_epi8(thi[fec_length - 1], hi));
+            }
+
+            alignas(16) unsigned char parity_tile[fec_length * lanes];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               _mm_store_si128(reinterpret_cast<__m128i*>(parity_tile + (i * lanes)), reg[i]);
+            }
+
+            scatter_tile<lanes,fec_length>(parity_tile, fec);
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx2")))
+         inline void batch_parity_avx2(const galois::nibble_table table[], const unsigned char data[], unsigned char fec[])
+         {
+            const std::size_t lanes = 32;
+
+            alignas(32) unsigned char tile[data_length * lanes];
+            gather_tile<lanes,data_length>(data, tile);
+
+            __m256i tlo[fec_length];
+            __m256i thi[fec_length];
+            __m256i reg[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].lo)));
+               thi[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].hi)));
+               reg[i] = _mm256_setzero_si256();
+            }
+
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const __m256i feedback = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(tile + (d * lanes))), reg[0]);
+               const __m256i lo = _mm256_and_si256(feedback, mask);
+               const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(feedback, 4), mask);
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  reg[i] = _mm256_xor_si256(reg[i + 1], _mm256_xor_si256(_mm256_shuffle_epi8(tlo[i], lo), _mm256_shuffle_epi8(thi[i], hi)));
+               }
+
+               reg[fec_length - 1] = _mm256_xor_si256(_mm256_shuffle_epi8(tlo[fec_length - 1], lo), _mm256_shuffle_epi8(thi[fec_length - 1], hi));
+            }
+
+            alignas(32) unsigned char parity_tile[fec_length * lanes];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               _mm256_store_si256(reinterpret_cast<__m256i*>(parity_tile + (i * lanes)), reg[i]);
+            }
+
+            scatter_tile<lanes,fec_length>(parity_tile, fec);
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx512f,avx512bw")))
+         inline void batch_parity_avx512bw(const galois::nibble_table table[], const unsigned char data[], unsigned char fec[])
+         {
+            const std::size_t lanes = 64;
+
+            alignas(64) unsigned char tile[data_length * lanes];
+            gather_tile<lanes,data_length>(data, tile);
+
+            __m512i tlo[fec_length];
+            __m512i thi[fec_length];
+            __m512i reg[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i] = galois::broadcast_table_avx512(table[i].lo);
+               thi[i] = galois::broadcast_table_avx512(table[i].hi);
+               reg[i] = _mm512_setzero_si512();
+            }
+
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const __m512i feedback = _mm512_xor_si512(_mm512_load_si512(reinterpret_cast<const void*>(tile + (d * lanes))), reg[0]);
+               const __m512i lo = _mm512_and_si512(feedback, mask);
+               const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(feedback, 4), mask);
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  reg[i] = _mm512_xor_si512(reg[i + 1], _mm512_xor_si512(_mm512_shuffle_epi8(tlo[i], lo), _mm512_shuffle_epi8(thi[i], hi)));
+               }
+
+               reg[fec_length - 1] = _mm512_xor_si512(_mm512_shuffle_epi8(tlo[fec_length - 1], lo), _mm512_shuffle_epi8(thi[fec_length - 1], hi));
+            }
+
+            alignas(64) unsigned char parity_tile[fec_length * lanes];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               _mm512_store_si512(reinterpret_cast<void*>(parity_tile + (i * lanes)), reg[i]);
+            }
+
+            scatter_tile<lanes,fec_length>(parity_tile, fec);
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx512f,avx512bw,gfni")))
+         inline void batch_parity_gfni(const galois::affine_matrix matrix[], const unsigned char data[], unsigned char fec[])
+         {
+            const std::size_t lanes = 64;
+
+            alignas(64) unsigned char tile[data_length * lanes];
+            gather_tile<lanes,data_length>(data, tile);
+
+            __m512i tmat[fec_length];
+            __m512i reg[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tmat[i] = _mm512_set1_epi64(static_cast<long long>(matrix[i].bits));
+               reg[i]  = _mm512_setzero_si512();
+            }
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const __m512i feedback = _mm512_xor_si512(_mm512_load_si512(reinterpret_cast<const void*>(tile + (d * lanes))), reg[0]);
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  reg[i] = _mm512_xor_si512(reg[i + 1], _mm512_gf2p8affine_epi64_epi8(feedback, tmat[i], 0));
+               }
+
+               reg[fec_length - 1] = _mm512_gf2p8affine_epi64_epi8(feedback, tmat[fec_length - 1], 0);
+            }
+
+            alignas(64) unsigned char parity_tile[fec_length * lanes];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               _mm512_store_si512(reinterpret_cast<void*>(parity_tile + (i * lanes)), reg[i]);
+            }
+
+            scatter_tile<lanes,fec_length>(parity_tile, fec);
+         }
+
+         #endif
+
+      } // namespace details
+
+      /*
+         GF(2^8) systematic encoder working directly on byte buffers, many
+         codewords at a time. The parity is the same as encoder's (same
+         LFSR, same generator normalisation), only the multiplications by
+         the generator coefficients are split-nibble lookups, which the
+         SSSE3/AVX2/AVX-512BW kernels run 16/32/64 codewords side by side,
+         or GF2P8AFFINEQB bit matrix products with the GFNI kernel.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class batch_encoder
+      {
+      public:
+
+         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
+
+         batch_encoder(const galois::field& gfield,
+                       const galois::field_polynomial& generator,
+                       const galois::simd_level level = galois::detect_simd_level())
+         : encoder_valid_((code_length == gfield.size()) && (8 == gfield.pwr()) && (generator.deg() == static_cast<int>(fec_length))),
+           level_(level)
+         {
+            if (encoder_valid_)
+            {
+               create_tables(gfield, generator);
+            }
+         }
+
+         inline galois::simd_level level() const
+         {
+            return level_;
+         }
+
+         // Single codeword: data_length data bytes in, fec_length parity bytes out
+         inline bool encode(const std::uint8_t data[], std::uint8_t parity[]) const
+         {
+            if (!encoder_valid_)
+            {
+               return false;
+            }
+
+            encode_scalar(data, parity);
+
+            return true;
+         }
+
+         inline bool encode(byte_block<code_length,fec_length>& rsblock) const
+         {
+            if (!encoder_valid_)
+            {
+               rsblock.error = block<code_length,fec_length>::e_encoder_error0;
+               return false;
+            }
+
+            encode_scalar(rsblock.data, rsblock.data + data_length);
+
+            return true;
+         }
+
+         /*
+            data: block_count consecutive codeword data parts (data_length bytes each)
+            fec : block_count consecutive parities (fec_length bytes each)
+         */
+         inline bool encode_batch(const unsigned char data[], const std::size_t block_count, unsigned char fec[]) const
+         {
+            if (!encoder_valid_)
+            {
+               return false;
+            }
+
+            std::size_t block = 0;
+
+            #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+            /* Wide kernels first, the remaining codewords fall through to the narrower ones */
+
+            if (level_ >= galois::e_simd_gfni)
+            {
+               for ( ; (block + 64) <= block_count; block += 64)
+               {
+                  details::batch_parity_gfni<data_length,fec_length>(affine_matrix_, data + (block * data_length), fec + (block * fec_length));
+               }
+            }
+
+            if (level_ >= galois::e_simd_avx512bw)
+            {
+               for ( ; (block + 64) <= block_count; block += 64)
+               {
+                  details::batch_parity_avx512bw<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length));
+               }
+            }
+
+            if (level_ >= galois::e_simd_avx2)
+            {
+               for ( ; (block + 32) <= block_count; block += 32)
+               {
+                  details::batch_parity_avx2<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length));
+               }
+            }
+
+            if (level_ >= galois::e_simd_ssse3)
+            {
+               for ( ; (block + 16) <= block_count; block += 16)
+               {
+                  details::batch_parity_ssse3<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length));
+               }
+            }
+
+            #endif
+
+            for ( ; block < block_count; ++block)
+            {
+               encode_scalar(data + (block * data_length), fec + (block * fec_length));
+            }
+
+            return true;
+         }
+
+      private:
+
+         batch_encoder();
+         batch_encoder(const batch_encoder& enc);
+         batch_encoder& operator=(const batch_encoder& enc);
+
+         void create_tables(const galois::field& gfield, const galois::field_polynomial& generator)
+         {
+            /*
+              Register cell i is multiplied by g[fec_length - 1 - i] (generator
+              made monic), see encoder::create_lfsr_table.
+            */
+
+            const galois::field_symbol leading = generator[fec_length].poly();
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               const galois::field_symbol g = gfield.gen_div(generator[fec_length - 1 - i].poly(), leading);
+
+               nibble_table_[i].assign(gfield, g);
+               affine_matrix_[i].assign(gfield, g);
+
+               for (std::size_t f = 0; f < 256; ++f)
+               {
+                  lfsr_table_[(f * fec_length) + i] = static_cast<unsigned char>(gfield.gen_mul(static_cast<galois::field_symbol>(f), g));
+               }
+            }
+         }
+
+         inline void encode_scalar(const unsigned char data[], unsigned char fec[]) const
+         {
+            unsigned char parities[fec_length] = { 0 };
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const unsigned char* product = &lfsr_table_[(data[d] ^ parities[0]) * fec_length];
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  parities[i] = parities[i + 1] ^ product[i];
+               }
+
+               parities[fec_length - 1] = product[fec_length - 1];
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               fec[i] = parities[i];
+            }
+         }
+
+         const bool               encoder_valid_;
+         const galois::simd_level level_;
+         galois::nibble_table     nibble_table_[fec_length];
+         galois::affine_matrix    affine_matrix_[fec_length];
+         unsigned char            lfsr_table_[256 * fec_length];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
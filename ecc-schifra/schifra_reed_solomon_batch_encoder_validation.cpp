@@ -0,0 +1,164 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The batch_encoder, with every engine supported by the CPU,
+                against the reference reed_solomon::encoder. The batch sizes
+                go through all the kernels and their fall through to the
+                narrower ones and to the scalar encoding.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+
+
+template <std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+bool batch_encoder_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[], const schifra::galois::simd_level level)
+{
+   typedef schifra::reed_solomon::encoder<code_length,fec_length>       encoder_t;
+   typedef schifra::reed_solomon::batch_encoder<code_length,fec_length> batch_encoder_t;
+   typedef schifra::reed_solomon::block<code_length,fec_length>         block_t;
+
+   const std::size_t data_length = code_length - fec_length;
+
+   const schifra::galois::field field(8, prim_poly_size, prim_poly);
+
+   schifra::galois::field_polynomial generator(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator))
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t       encoder(field, generator);
+   const batch_encoder_t batch_encoder(field, generator, level);
+
+   const std::size_t block_counts[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 241 };
+   const std::size_t block_count_size = sizeof(block_counts) / sizeof(std::size_t);
+
+   for (std::size_t c = 0; c < block_count_size; ++c)
+   {
+      const std::size_t block_count = block_counts[c];
+
+      std::vector<unsigned char> data(block_count * data_length + 1);
+      std::vector<unsigned char> fec (block_count * fec_length  + 1);
+
+      for (std::size_t i = 0; i < data.size(); ++i)
+      {
+         data[i] = static_cast<unsigned char>(::rand() & 0xFF);
+      }
+
+      // The batch must not write past its parities
+      const unsigned char guard = fec.back() = 0xA5;
+
+      if (!batch_encoder.encode_batch(&data[0], block_count, &fec[0]) || (guard != fec.back()))
+      {
+         std::cout << "Error - Failed to encode a batch of " << block_count << " codewords" << std::endl;
+         return false;
+      }
+
+      for (std::size_t b = 0; b < block_count; ++b)
+      {
+         block_t block;
+
+         for (std::size_t i = 0; i < data_length; ++i)
+         {
+            block.data[i] = data[(b * data_length) + i];
+         }
+
+         if (!encoder.encode(block))
+         {
+            std::cout << "Error - Failed to encode codeword " << b << std::endl;
+            return false;
+         }
+
+         for (std::size_t i = 0; i < fec_length; ++i)
+         {
+            if (block.fec(i) != fec[(b * fec_length) + i])
+            {
+               std::cout << "Error - batch_encoder (" << schifra::galois::simd_level_name(level) << ") parity mismatch on RS("
+                         << code_length << "," << data_length << "), codeword " << b << " of a batch of " << block_count << std::endl;
+               return false;
+            }
+         }
+
+         std::vector<std::uint8_t> parity(fec_length);
+
+         if (!batch_encoder.encode(&data[b * data_length], &parity[0]) ||
+             !std::equal(parity.begin(), parity.end(), &fec[b * fec_length]))
+         {
+            std::cout << "Error - batch_encoder single codeword parity mismatch on RS("
+                      << code_length << "," << data_length << "), codeword " << b << std::endl;
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   ::srand(0x2B7E151);
+
+   bool batch_encoder_validation_result = true;
+
+   for (int i = e_simd_scalar; batch_encoder_validation_result && (i <= e_simd_gfni); ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+
+      if (!simd_level_supported(level))
+         continue;
+
+      batch_encoder_validation_result = batch_encoder_validation_test<120,255, 2>(primitive_polynomial_size06,primitive_polynomial06,level) &&
+                                        batch_encoder_validation_test<120,255,32>(primitive_polynomial_size06,primitive_polynomial06,level) &&
+                                        batch_encoder_validation_test<  1,255,16>(primitive_polynomial_size05,primitive_polynomial05,level) &&
+                                        batch_encoder_validation_test<  0,255,64>(primitive_polynomial_size05,primitive_polynomial05,level) ;
+   }
+
+   if (batch_encoder_validation_result)
+   {
+      std::cout << "Schifra Reed-Solomon Batch Encoder Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Batch Encoder Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -0,0 +1,415 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_BATCH_SYNDROME_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_BATCH_SYNDROME_HPP
+
+
+#include <cstddef>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_ecc_traits.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+         /*
+            Same layout as the batch encoder: row j of the tile holds
+            symbol j (data then fec) of 'lanes' consecutive codewords.
+         */
+
+         template <std::size_t lanes, std::size_t data_length, std::size_t fec_length>
+         inline void gather_codeword_tile(const unsigned char data[], const unsigned char fec[], unsigned char tile[])
+         {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+               const unsigned char* block_data = data + (lane * data_length);
+               const unsigned char* block_fec  = fec  + (lane * fec_length );
+
+               for (std::size_t j = 0; j < data_length; ++j)
+               {
+                  tile[(j * lanes) + lane] = block_data[j];
+               }
+
+               for (std::size_t j = 0; j < fec_length; ++j)
+               {
+                  tile[((data_length + j) * lanes) + lane] = block_fec[j];
+               }
+            }
+         }
+
+         #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("ssse3")))
+         inline void batch_syndrome_ssse3(const galois::nibble_table table[], const unsigned char data[], const unsigned char fec[], unsigned char flags[])
+         {
+            const std::size_t lanes = 16;
+            const std::size_t code_length = data_length + fec_length;
+
+            alignas(16) unsigned char tile[code_length * lanes];
+            gather_codeword_tile<lanes,data_length,fec_length>(data, fec, tile);
+
+            __m128i tlo[fec_length];
+            __m128i thi[fec_length];
+            __m128i syndrome[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i]      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].lo));
+               thi[i]      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].hi));
+               syndrome[i] = _mm_setzero_si128();
+            }
+
+            const __m128i mask = _mm_set1_epi8(0x0F);
+
+            for (std::size_t j = 0; j < code_length; ++j)
+            {
+               const __m128i symbol = _mm_load_si128(reinterpret_cast<const __m128i*>(tile + (j * lanes)));
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  const __m128i lo = _mm_and_si128(syndrome[i], mask);
+                  const __m128i hi = _mm_and_si128(_mm_srli_epi16(syndrome[i], 4), mask);
+                  syndrome[i] = _mm_xor_si128(symbol, _mm_xor_si128(_mm_shuffle_epi8(tlo[i], lo), _mm_shuffle_epi8(thi[i], hi)));
+               }
+            }
+
+            __m128i error_flag = syndrome[0];
+
+            for (std::size_t i = 1; i < fec_length; ++i)
+            {
+               error_flag = _mm_or_si128(error_flag, syndrome[i]);
+            }
+
+            error_flag = _mm_andnot_si128(_mm_cmpeq_epi8(error_flag, _mm_setzero_si128()), _mm_set1_epi8(1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(flags), error_flag);
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx2")))
+         inline void batch_syndrome_avx2(const galois::nibble_table table[], const unsigned char data[], const unsigned char fec[], unsigned char flags[])
+         {
+            const std::size_t lanes = 32;
+            const std::size_t code_length = data_length + fec_length;
+
+            alignas(32) unsigned char tile[code_length * lanes];
+            gather_codeword_tile<lanes,data_length,fec_length>(data, fec, tile);
+
+            __m256i tlo[fec_length];
+            __m256i thi[fec_length];
+            __m256i syndrome[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i]      = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].lo)));
+               thi[i]      = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table[i].hi)));
+               syndrome[i] = _mm256_setzero_si256();
+            }
+
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+
+            for (std::size_t j = 0; j < code_length; ++j)
+            {
+               const __m256i symbol = _mm256_load_si256(reinterpret_cast<const __m256i*>(tile + (j * lanes)));
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  const __m256i lo = _mm256_and_si256(syndrome[i], mask);
+                  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(syndrome[i], 4), mask);
+                  syndrome[i] = _mm256_xor_si256(symbol, _mm256_xor_si256(_mm256_shuffle_epi8(tlo[i], lo), _mm256_shuffle_epi8(thi[i], hi)));
+               }
+            }
+
+            __m256i error_flag = syndrome[0];
+
+            for (std::size_t i = 1; i < fec_length; ++i)
+            {
+               error_flag = _mm256_or_si256(error_flag, syndrome[i]);
+            }
+
+            error_flag = _mm256_andnot_si256(_mm256_cmpeq_epi8(error_flag, _mm256_setzero_si256()), _mm256_set1_epi8(1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(flags), error_flag);
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx512f,avx512bw")))
+         inline void batch_syndrome_avx512bw(const galois::nibble_table table[], const unsigned char data[], const unsigned char fec[], unsigned char flags[])
+         {
+            const std::size_t lanes = 64;
+            const std::size_t code_length = data_length + fec_length;
+
+            alignas(64) unsigned char tile[code_length * lanes];
+            gather_codeword_tile<lanes,data_length,fec_length>(data, fec, tile);
+
+            __m512i tlo[fec_length];
+            __m512i thi[fec_length];
+            __m512i syndrome[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tlo[i]      = galois::broadcast_table_avx512(table[i].lo);
+               thi[i]      = galois::broadcast_table_avx512(table[i].hi);
+               syndrome[i] = _mm512_setzero_si512();
+            }
+
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+
+            for (std::size_t j = 0; j < code_length; ++j)
+            {
+               const __m512i symbol = _mm512_load_si512(reinterpret_cast<const void*>(tile + (j * lanes)));
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  const __m512i lo = _mm512_and_si512(syndrome[i], mask);
+                  const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(syndrome[i], 4), mask);
+                  syndrome[i] = _mm512_xor_si512(symbol, _mm512_xor_si512(_mm512_shuffle_epi8(tlo[i], lo), _mm512_shuffle_epi8(thi[i], hi)));
+               }
+            }
+
+            __m512i error_flag = syndrome[0];
+
+            for (std::size_t i = 1; i < fec_length; ++i)
+            {
+               error_flag = _mm512_or_si512(error_flag, syndrome[i]);
+            }
+
+            _mm512_storeu_si512(reinterpret_cast<void*>(flags), _mm512_maskz_set1_epi8(_mm512_test_epi8_mask(error_flag, error_flag), 1));
+         }
+
+         template <std::size_t data_length, std::size_t fec_length>
+         __attribute__((target("avx512f,avx512bw,gfni")))
+         inline void batch_syndrome_gfni(const galois::affine_matrix matrix[], const unsigned char data[], const unsigned char fec[], unsigned char flags[])
+         {
+            const std::size_t lanes = 64;
+            const std::size_t code_length = data_length + fec_length;
+
+            alignas(64) unsigned char tile[code_length * lanes];
+            gather_codeword_tile<lanes,data_length,fec_length>(data, fec, tile);
+
+            __m512i tmat[fec_length];
+            __m512i syndrome[fec_length];
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               tmat[i]     = _mm512_set1_epi64(static_cast<long long>(matrix[i].bits));
+               syndrome[i] = _mm512_setzero_si512();
+            }
+
+            for (std::size_t j = 0; j < code_length; ++j)
+            {
+               const __m512i symbol = _mm512_load_si512(reinterpret_cast<const void*>(tile + (j * lanes)));
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  syndrome[i] = _mm512_xor_si512(symbol, _mm512_gf2p8affine_epi64_epi8(syndrome[i], tmat[i], 0));
+               }
+            }
+
+            __m512i error_flag = syndrome[0];
+
+            for (std::size_t i = 1; i < fec_length; ++i)
+            {
+               error_flag = _mm512_or_si512(error_flag, syndrome[i]);
+            }
+
+            _mm512_storeu_si512(reinterpret_cast<void*>(flags), _mm512_maskz_set1_epi8(_mm512_test_epi8_mask(error_flag, error_flag), 1));
+         }
+
+         #endif
+
+      } // namespace details
+
+      /*
+         Clean-block filter for the decoder: computes the syndromes of many
+         GF(2^8) codewords at once, straight from the data and parity bytes,
+         and flags the codewords having at least one non-zero syndrome. Only
+         the flagged codewords need the full decoding.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class batch_syndrome
+      {
+      public:
+
+         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
+
+         batch_syndrome(const galois::field& gfield,
+                        const unsigned int gen_initial_index = 0,
+                        const galois::simd_level level = galois::detect_simd_level())
+         : syndrome_valid_((code_length == gfield.size()) && (8 == gfield.pwr())),
+           level_(level)
+         {
+            if (syndrome_valid_)
+            {
+               create_tables(gfield, gen_initial_index);
+            }
+         }
+
+         inline galois::simd_level level() const
+         {
+            return level_;
+         }
+
+         /*
+            data : block_count consecutive codeword data parts (data_length bytes each)
+            fec  : block_count consecutive parities (fec_length bytes each)
+            flags: one byte per codeword, set to 1 when the codeword has errors
+
+            Return the number of flagged codewords.
+         */
+         inline std::size_t check_batch(const unsigned char data[], const unsigned char fec[], const std::size_t block_count, unsigned char flags[]) const
+         {
+            std::size_t block = 0;
+
+            if (!syndrome_valid_)
+            {
+               for ( ; block < block_count; ++block)
+               {
+                  flags[block] = 1;
+               }
+
+               return block_count;
+            }
+
+            #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+            if (level_ >= galois::e_simd_gfni)
+            {
+               for ( ; (block + 64) <= block_count; block += 64)
+               {
+                  details::batch_syndrome_gfni<data_length,fec_length>(affine_matrix_, data + (block * data_length), fec + (block * fec_length), flags + block);
+               }
+            }
+
+            if (level_ >= galois::e_simd_avx512bw)
+            {
+               for ( ; (block + 64) <= block_count; block += 64)
+               {
+                  details::batch_syndrome_avx512bw<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length), flags + block);
+               }
+            }
+
+            if (level_ >= galois::e_simd_avx2)
+            {
+               for ( ; (block + 32) <= block_count; block += 32)
+               {
+                  details::batch_syndrome_avx2<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length), flags + block);
+               }
+            }
+
+            if (level_ >= galois::e_simd_ssse3)
+            {
+               for ( ; (block + 16) <= block_count; block += 16)
+               {
+                  details::batch_syndrome_ssse3<data_length,fec_length>(nibble_table_, data + (block * data_length), fec + (block * fec_length), flags + block);
+               }
+            }
+
+            #endif
+
+            for ( ; block < block_count; ++block)
+            {
+               flags[block] = check_scalar(data + (block * data_length), fec + (block * fec_length));
+            }
+
+            std::size_t flagged = 0;
+
+            for (std::size_t i = 0; i < block_count; ++i)
+            {
+               flagged += flags[i];
+            }
+
+            return flagged;
+         }
+
+      private:
+
+         batch_syndrome();
+         batch_syndrome(const batch_syndrome& bs);
+         batch_syndrome& operator=(const batch_syndrome& bs);
+
+         void create_tables(const galois::field& gfield, const unsigned int gen_initial_index)
+         {
+            // Syndrome i is the received polynomial evaluated at alpha^(gen_initial_index + i)
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               const galois::field_symbol root = gfield.alpha(static_cast<galois::field_symbol>(gen_initial_index + i));
+
+               nibble_table_[i].assign(gfield, root);
+               affine_matrix_[i].assign(gfield, root);
+
+               for (std::size_t s = 0; s < 256; ++s)
+               {
+                  mul_table_[(i * 256) + s] = static_cast<unsigned char>(gfield.gen_mul(static_cast<galois::field_symbol>(s), root));
+               }
+            }
+         }
+
+         inline unsigned char check_scalar(const unsigned char data[], const unsigned char fec[]) const
+         {
+            unsigned char syndrome[fec_length] = { 0 };
+
+            for (std::size_t j = 0; j < data_length; ++j)
+            {
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  syndrome[i] = mul_table_[(i * 256) + syndrome[i]] ^ data[j];
+               }
+            }
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  syndrome[i] = mul_table_[(i * 256) + syndrome[i]] ^ fec[j];
+               }
+            }
+
+            unsigned char error_flag = 0;
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               error_flag |= syndrome[i];
+            }
+
+            return (error_flag ? 1 : 0);
+         }
+
+         const bool               syndrome_valid_;
+         const galois::simd_level level_;
+         galois::nibble_table     nibble_table_[fec_length];
+         galois::affine_matrix    affine_matrix_[fec_length];
+         unsigned char            mul_table_[fec_length * 256];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
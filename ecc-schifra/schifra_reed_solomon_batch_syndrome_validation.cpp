@@ -0,0 +1,162 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The batch_syndrome filter, with every engine supported by
+                the CPU, on batches of clean and damaged codewords: exactly
+                the damaged codewords must be flagged. The batch sizes go
+                through all the kernels and the scalar fall through.
+*/
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_batch_encoder.hpp"
+#include "schifra_reed_solomon_batch_syndrome.hpp"
+
+
+template <std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+bool batch_syndrome_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[], const schifra::galois::simd_level level)
+{
+   typedef schifra::reed_solomon::batch_encoder <code_length,fec_length> encoder_t;
+   typedef schifra::reed_solomon::batch_syndrome<code_length,fec_length> syndrome_t;
+
+   const std::size_t data_length = code_length - fec_length;
+
+   const schifra::galois::field field(8, prim_poly_size, prim_poly);
+
+   schifra::galois::field_polynomial generator(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator))
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   // The parities come from the scalar engine, validated against the reference encoder
+   const encoder_t  encoder(field, generator, schifra::galois::e_simd_scalar);
+   const syndrome_t syndrome(field, gen_poly_index, level);
+
+   const std::size_t block_counts[] = { 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 241 };
+   const std::size_t block_count_size = sizeof(block_counts) / sizeof(std::size_t);
+
+   for (std::size_t c = 0; c < block_count_size; ++c)
+   {
+      const std::size_t block_count = block_counts[c];
+
+      std::vector<unsigned char> data(block_count * data_length);
+      std::vector<unsigned char> fec (block_count * fec_length );
+      std::vector<unsigned char> damaged(block_count, 0);
+      std::vector<unsigned char> flags  (block_count, 0);
+
+      for (std::size_t i = 0; i < data.size(); ++i)
+      {
+         data[i] = static_cast<unsigned char>(::rand() & 0xFF);
+      }
+
+      encoder.encode_batch(&data[0], block_count, &fec[0]);
+
+      if (0 != syndrome.check_batch(&data[0], &fec[0], block_count, &flags[0]))
+      {
+         std::cout << "Error - batch_syndrome (" << schifra::galois::simd_level_name(level) << ") flagged clean codewords in a batch of " << block_count << std::endl;
+         return false;
+      }
+
+      // One symbol of about a third of the codewords, in their data or their parity (the first and the last of the batch always)
+      std::size_t damaged_count = 0;
+
+      for (std::size_t b = 0; b < block_count; ++b)
+      {
+         if ((0 != b) && ((block_count - 1) != b) && (0 != (::rand() % 3)))
+            continue;
+
+         const std::size_t position = static_cast<std::size_t>(::rand()) % code_length;
+         const unsigned char noise = static_cast<unsigned char>(1 + (::rand() % 255));
+
+         if (position < data_length)
+            data[(b * data_length) + position] ^= noise;
+         else
+            fec[(b * fec_length) + (position - data_length)] ^= noise;
+
+         damaged[b] = 1;
+         ++damaged_count;
+      }
+
+      if (damaged_count != syndrome.check_batch(&data[0], &fec[0], block_count, &flags[0]))
+      {
+         std::cout << "Error - batch_syndrome (" << schifra::galois::simd_level_name(level) << ") wrong flagged count in a batch of " << block_count << std::endl;
+         return false;
+      }
+
+      for (std::size_t b = 0; b < block_count; ++b)
+      {
+         if ((0 != flags[b]) != (0 != damaged[b]))
+         {
+            std::cout << "Error - batch_syndrome (" << schifra::galois::simd_level_name(level) << ") wrong flag of RS("
+                      << code_length << "," << data_length << ") codeword " << b << " of a batch of " << block_count << std::endl;
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   ::srand(0x6A09E66);
+
+   bool batch_syndrome_validation_result = true;
+
+   for (int i = e_simd_scalar; batch_syndrome_validation_result && (i <= e_simd_gfni); ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+
+      if (!simd_level_supported(level))
+         continue;
+
+      batch_syndrome_validation_result = batch_syndrome_validation_test<120,255, 2>(primitive_polynomial_size06,primitive_polynomial06,level) &&
+                                         batch_syndrome_validation_test<120,255,32>(primitive_polynomial_size06,primitive_polynomial06,level) &&
+                                         batch_syndrome_validation_test<  1,255,16>(primitive_polynomial_size05,primitive_polynomial05,level) &&
+                                         batch_syndrome_validation_test<  0,255,64>(primitive_polynomial_size05,primitive_polynomial05,level) ;
+   }
+
+   if (batch_syndrome_validation_result)
+   {
+      std::cout << "Schifra Reed-Solomon Batch Syndrome Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Batch Syndrome Validation Failure!" << std::endl;
+      return 1;
+   }
+}
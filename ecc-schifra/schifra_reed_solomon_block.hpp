@@ -24,6 +24,7 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_BLOCK_HPP
 
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -214,6 +215,62 @@ namespace schifra
          galois::field_symbol data[code_length];
       };
 
+      /*
+         Codeword of a GF(2^8) code stored one byte per symbol (a quarter
+         of the size of block), so that it can be filled from and written
+         back to byte buffers with plain copies. The decoding state is the
+         same as block's.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      struct byte_block
+      {
+      public:
+
+         typedef std::uint8_t symbol_type;
+         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
+         typedef typename block<code_length,fec_length,data_length>::error_t error_t;
+
+         byte_block()
+         : errors_detected (0),
+           errors_corrected(0),
+           zero_numerators (0),
+           unrecoverable(false),
+           error(block<code_length,fec_length,data_length>::e_no_error)
+         {
+            traits::validate_reed_solomon_block_parameters<code_length,fec_length,data_length>();
+         }
+
+         std::uint8_t& operator[](const std::size_t& index)
+         {
+            return data[index];
+         }
+
+         const std::uint8_t& operator[](const std::size_t& index) const
+         {
+            return data[index];
+         }
+
+         std::uint8_t& fec(const std::size_t& index)
+         {
+            return data[data_length + index];
+         }
+
+         void clear(std::uint8_t value = 0)
+         {
+            for (std::size_t i = 0; i < code_length; ++i)
+            {
+               data[i] = value;
+            }
+         }
+
+         std::size_t  errors_detected;
+         std::size_t errors_corrected;
+         std::size_t  zero_numerators;
+         bool           unrecoverable;
+         error_t                error;
+         std::uint8_t data[code_length];
+      };
+
       template <std::size_t code_length, std::size_t fec_length>
       inline void copy(const block<code_length,fec_length>& src_block, block<code_length,fec_length>& dest_block)
       {
@@ -0,0 +1,350 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_CHIEN_SEARCH_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_CHIEN_SEARCH_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_simd.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      namespace details
+      {
+         /*
+            Each lane evaluates the locator at one field position: lane l of
+            term[k] holds lambda[k].alpha^(k.i) for position i = first + l.
+            Moving all the lanes to the next 'lanes' positions multiplies
+            term[k] by the constant alpha^(k.lanes).
+         */
+
+         #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+         template <std::size_t fec_length>
+         __attribute__((target("ssse3")))
+         inline std::size_t chien_search_ssse3(const galois::nibble_table step[], const unsigned char terms[], const std::size_t degree,
+                                               const std::size_t code_length, std::size_t root_list[])
+         {
+            const std::size_t lanes = 16;
+
+            __m128i term[fec_length + 1];
+
+            for (std::size_t k = 0; k <= degree; ++k)
+            {
+               term[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(terms + (k * lanes)));
+            }
+
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            std::size_t root_count = 0;
+
+            for (std::size_t first = 1; first <= code_length; first += lanes)
+            {
+               __m128i sum = term[0];
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  sum = _mm_xor_si128(sum, term[k]);
+               }
+
+               std::uint32_t zeros = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(sum, _mm_setzero_si128())));
+
+               if ((first + lanes) > (code_length + 1))
+               {
+                  zeros &= (std::uint32_t(1) << (code_length + 1 - first)) - 1;
+               }
+
+               for ( ; zeros; zeros &= (zeros - 1))
+               {
+                  root_list[root_count++] = first + static_cast<std::size_t>(__builtin_ctz(zeros));
+
+                  if (degree == root_count)
+                     return root_count;
+               }
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  const __m128i lo = _mm_and_si128(term[k], mask);
+                  const __m128i hi = _mm_and_si128(_mm_srli_epi16(term[k], 4), mask);
+                  term[k] = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(step[k].lo)), lo),
+                                          _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(step[k].hi)), hi));
+               }
+            }
+
+            return root_count;
+         }
+
+         template <std::size_t fec_length>
+         __attribute__((target("avx2")))
+         inline std::size_t chien_search_avx2(const galois::nibble_table step[], const unsigned char terms[], const std::size_t degree,
+                                              const std::size_t code_length, std::size_t root_list[])
+         {
+            const std::size_t lanes = 32;
+
+            __m256i term[fec_length + 1];
+
+            for (std::size_t k = 0; k <= degree; ++k)
+            {
+               term[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(terms + (k * lanes)));
+            }
+
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            std::size_t root_count = 0;
+
+            for (std::size_t first = 1; first <= code_length; first += lanes)
+            {
+               __m256i sum = term[0];
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  sum = _mm256_xor_si256(sum, term[k]);
+               }
+
+               std::uint32_t zeros = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(sum, _mm256_setzero_si256())));
+
+               if ((first + lanes) > (code_length + 1))
+               {
+                  zeros &= (std::uint32_t(1) << (code_length + 1 - first)) - 1;
+               }
+
+               for ( ; zeros; zeros &= (zeros - 1))
+               {
+                  root_list[root_count++] = first + static_cast<std::size_t>(__builtin_ctz(zeros));
+
+                  if (degree == root_count)
+                     return root_count;
+               }
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  const __m256i lo = _mm256_and_si256(term[k], mask);
+                  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(term[k], 4), mask);
+                  term[k] = _mm256_xor_si256(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(step[k].lo))), lo),
+                                             _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(step[k].hi))), hi));
+               }
+            }
+
+            return root_count;
+         }
+
+         template <std::size_t fec_length>
+         __attribute__((target("avx512f,avx512bw")))
+         inline std::size_t chien_search_avx512bw(const galois::nibble_table step[], const unsigned char terms[], const std::size_t degree,
+                                                  const std::size_t code_length, std::size_t root_list[])
+         {
+            const std::size_t lanes = 64;
+
+            __m512i term[fec_length + 1];
+
+            for (std::size_t k = 0; k <= degree; ++k)
+            {
+               term[k] = _mm512_loadu_si512(reinterpret_cast<const void*>(terms + (k * lanes)));
+            }
+
+            const __m512i mask = _mm512_set1_epi8(0x0F);
+            std::size_t root_count = 0;
+
+            for (std::size_t first = 1; first <= code_length; first += lanes)
+            {
+               __m512i sum = term[0];
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  sum = _mm512_xor_si512(sum, term[k]);
+               }
+
+               std::uint64_t zeros = _mm512_cmpeq_epi8_mask(sum, _mm512_setzero_si512());
+
+               if ((first + lanes) > (code_length + 1))
+               {
+                  zeros &= (std::uint64_t(1) << (code_length + 1 - first)) - 1;
+               }
+
+               for ( ; zeros; zeros &= (zeros - 1))
+               {
+                  root_list[root_count++] = first + static_cast<std::size_t>(__builtin_ctzll(zeros));
+
+                  if (degree == root_count)
+                     return root_count;
+               }
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  const __m512i lo = _mm512_and_si512(term[k], mask);
+                  const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(term[k], 4), mask);
+                  term[k] = _mm512_xor_si512(_mm512_shuffle_epi8(galois::broadcast_table_avx512(step[k].lo), lo),
+                                             _mm512_shuffle_epi8(galois::broadcast_table_avx512(step[k].hi), hi));
+               }
+            }
+
+            return root_count;
+         }
+
+         #endif
+
+      } // namespace details
+
+      /*
+         Incremental Chien search: the roots of the error locator are the
+         positions i (1 <= i <= code_length) where sum(lambda[k].alpha^(k.i))
+         is zero. Rather than evaluating the whole polynomial at every
+         alpha^i, one running term is kept per coefficient and multiplied
+         by alpha^k at each step. For GF(2^8) the positions are scanned
+         16/32/64 at a time by the SIMD kernels (the gfni engine uses the
+         AVX-512BW kernel, there are only a few constant multiplies per
+         step). The search stops as soon as 'degree' roots are found.
+      */
+      template <std::size_t code_length, std::size_t fec_length>
+      class chien_search
+      {
+      public:
+
+         chien_search(const galois::field& gfield, const galois::simd_level level = galois::detect_simd_level())
+         : field_(gfield),
+           lanes_(((code_length == gfield.size()) && (8 == gfield.pwr())) ? lane_count(level) : 1),
+           level_((1 == lanes_) ? galois::e_simd_scalar : level)
+         {
+            for (std::size_t k = 0; k <= fec_length; ++k)
+            {
+               alpha_power_[k] = field_.alpha(static_cast<galois::field_symbol>(k));
+            }
+
+            if (lanes_ > 1)
+            {
+               for (std::size_t k = 0; k <= fec_length; ++k)
+               {
+                  step_table_[k].assign(field_, field_.gen_exp(alpha_power_[k], lanes_));
+
+                  for (std::size_t l = 0; l < lanes_; ++l)
+                  {
+                     position_table_[(k * max_lanes) + l] = static_cast<unsigned char>(field_.gen_exp(alpha_power_[k], l + 1));
+                  }
+               }
+            }
+         }
+
+         // Return the number of roots, stored in root_list (at most degree of them)
+         inline std::size_t find_roots(const galois::field_symbol lambda[], const std::size_t degree, std::size_t root_list[]) const
+         {
+            if ((0 == degree) || (degree > fec_length))
+               return 0;
+
+            field_.prepare(galois::field::e_mul_table);
+
+            #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+            if (lanes_ > 1)
+            {
+               // Lane l of term k starts at position 1 + l
+               unsigned char terms[(fec_length + 1) * max_lanes];
+
+               for (std::size_t k = 0; k <= degree; ++k)
+               {
+                  for (std::size_t l = 0; l < lanes_; ++l)
+                  {
+                     terms[(k * lanes_) + l] = static_cast<unsigned char>(field_.mul(lambda[k], position_table_[(k * max_lanes) + l]));
+                  }
+               }
+
+               switch (level_)
+               {
+                  case galois::e_simd_gfni     :
+                  case galois::e_simd_avx512bw : return details::chien_search_avx512bw<fec_length>(step_table_, terms, degree, code_length, root_list);
+                  case galois::e_simd_avx2     : return details::chien_search_avx2    <fec_length>(step_table_, terms, degree, code_length, root_list);
+                  default                      : return details::chien_search_ssse3   <fec_length>(step_table_, terms, degree, code_length, root_list);
+               }
+            }
+
+            #endif
+
+            galois::field_symbol term[fec_length + 1];
+
+            for (std::size_t k = 0; k <= degree; ++k)
+            {
+               term[k] = lambda[k];
+            }
+
+            std::size_t root_count = 0;
+
+            for (std::size_t i = 1; i <= code_length; ++i)
+            {
+               galois::field_symbol sum = term[0];
+
+               for (std::size_t k = 1; k <= degree; ++k)
+               {
+                  term[k] = field_.mul(term[k], alpha_power_[k]);
+                  sum ^= term[k];
+               }
+
+               if (0 == sum)
+               {
+                  root_list[root_count++] = i;
+
+                  if (degree == root_count)
+                     break;
+               }
+            }
+
+            return root_count;
+         }
+
+      private:
+
+         enum { max_lanes = 64 };
+
+         chien_search();
+         chien_search(const chien_search& cs);
+         chien_search& operator=(const chien_search& cs);
+
+         static std::size_t lane_count(const galois::simd_level level)
+         {
+            switch (level)
+            {
+               case galois::e_simd_gfni     :
+               case galois::e_simd_avx512bw : return 64;
+               case galois::e_simd_avx2     : return 32;
+               case galois::e_simd_ssse3    : return 16;
+               default                      : return 1;
+            }
+         }
+
+         const galois::field&     field_;
+         const std::size_t        lanes_;
+         const galois::simd_level level_;
+         galois::field_symbol     alpha_power_[fec_length + 1];
+         galois::nibble_table     step_table_[fec_length + 1];
+         unsigned char            position_table_[(fec_length + 1) * max_lanes];
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
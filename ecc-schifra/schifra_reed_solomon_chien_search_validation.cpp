@@ -0,0 +1,147 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The Chien search, with every engine supported by the CPU,
+                on error locators built from known roots (all of them must
+                be found, in increasing order) and on random locators (the
+                roots must match the scalar search).
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_reed_solomon_chien_search.hpp"
+
+
+template <std::size_t code_length, std::size_t fec_length>
+bool chien_search_validation_test(const std::size_t field_descriptor, const std::size_t prim_poly_size, const unsigned int prim_poly[],
+                                  const schifra::galois::simd_level level, const std::size_t trial_count)
+{
+   typedef schifra::reed_solomon::chien_search<code_length,fec_length> chien_search_t;
+
+   const schifra::galois::field field(static_cast<int>(field_descriptor), prim_poly_size, prim_poly);
+
+   const chien_search_t scalar_search(field, schifra::galois::e_simd_scalar);
+   const chien_search_t search(field, level);
+
+   for (std::size_t trial = 0; trial < trial_count; ++trial)
+   {
+      schifra::galois::field_symbol lambda[fec_length + 1] = { 1 };
+      std::size_t degree = 1 + (static_cast<std::size_t>(::rand()) % fec_length);
+
+      std::size_t expected[fec_length];
+      std::size_t expected_count = 0;
+
+      if (trial % 2)
+      {
+         // Product of (1 + alpha^-p.x): a root at every position p
+         while (expected_count < degree)
+         {
+            const std::size_t position = 1 + static_cast<std::size_t>(::rand()) % code_length;
+
+            if (std::find(expected, expected + expected_count, position) != (expected + expected_count))
+               continue;
+
+            const schifra::galois::field_symbol x = field.alpha(static_cast<schifra::galois::field_symbol>(code_length - (position % code_length)));
+
+            for (std::size_t k = expected_count + 1; k > 0; --k)
+            {
+               lambda[k] ^= field.mul(x, lambda[k - 1]);
+            }
+
+            expected[expected_count++] = position;
+         }
+
+         std::sort(expected, expected + expected_count);
+      }
+      else
+      {
+         for (std::size_t k = 1; k <= degree; ++k)
+         {
+            lambda[k] = static_cast<schifra::galois::field_symbol>(::rand()) & field.mask();
+         }
+
+         lambda[degree] |= 1;
+         expected_count = scalar_search.find_roots(lambda, degree, expected);
+      }
+
+      std::size_t roots[fec_length];
+      const std::size_t root_count = search.find_roots(lambda, degree, roots);
+
+      if ((root_count != expected_count) || !std::equal(roots, roots + root_count, expected))
+      {
+         std::cout << "Error - chien_search (" << schifra::galois::simd_level_name(level) << ") roots mismatch on trial " << trial
+                   << " (degree " << degree << ", " << root_count << " roots instead of " << expected_count << ")" << std::endl;
+         return false;
+      }
+   }
+
+   std::size_t roots[fec_length];
+   const schifra::galois::field_symbol constant[fec_length + 1] = { 1 };
+
+   if (0 != search.find_roots(constant, 0, roots))
+   {
+      std::cout << "Error - chien_search found roots of a constant" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   ::srand(0x510E527);
+
+   bool chien_search_validation_result = true;
+
+   for (int i = e_simd_scalar; chien_search_validation_result && (i <= e_simd_gfni); ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+
+      if (!simd_level_supported(level))
+         continue;
+
+      chien_search_validation_result = chien_search_validation_test<255,32>(8,primitive_polynomial_size06,primitive_polynomial06,level,4000) &&
+                                       chien_search_validation_test<255, 2>(8,primitive_polynomial_size06,primitive_polynomial06,level,1000) &&
+                                       chien_search_validation_test<255,64>(8,primitive_polynomial_size05,primitive_polynomial05,level,1000) &&
+                                       chien_search_validation_test< 15, 6>(4,primitive_polynomial_size01,primitive_polynomial01,level,1000) ;
+   }
+
+   if (chien_search_validation_result)
+   {
+      std::cout << "Schifra Reed-Solomon Chien Search Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Chien Search Validation Failure!" << std::endl;
+      return 1;
+   }
+}
@@ -52,6 +52,9 @@ namespace schifra
          {
             if (decoder_valid_)
             {
+               // The polynomial arithmetic of the decoding uses all of them
+               field_.prepare(galois::field::e_all_tables);
+
                //Note: code_length and field size can be used interchangeably
                create_lookup_tables();
             }
@@ -25,6 +25,7 @@
 
 
 #include <string>
+#include <vector>
 
 #include "schifra_galois_field.hpp"
 #include "schifra_galois_field_element.hpp"
@@ -49,9 +50,15 @@ namespace schifra
 
          encoder(const galois::field& gfield, const galois::field_polynomial& generator)
          : encoder_valid_(code_length == gfield.size()),
+           generator_valid_(generator.deg() == static_cast<int>(fec_length)),
            field_(gfield),
            generator_(generator)
-         {}
+         {
+            if (encoder_valid_ && generator_valid_)
+            {
+               create_lfsr_table();
+            }
+         }
 
         ~encoder()
          {}
@@ -64,17 +71,7 @@ namespace schifra
                return false;
             }
 
-            const galois::field_polynomial parities = msg_poly(rsblock) % generator_;
-            const galois::field_symbol     mask     = field_.mask();
-
-            if (parities.deg() == (fec_length - 1))
-            {
-               for (std::size_t i = 0; i < fec_length; ++i)
-               {
-                  rsblock.fec(i) = parities[fec_length - 1 - i].poly() & mask;
-               }
-            }
-            else
+            if (!generator_valid_)
             {
                /*
                   Note: Encoder should never branch here.
@@ -87,6 +84,15 @@ namespace schifra
                return false;
             }
 
+            galois::field_symbol parities[fec_length];
+
+            compute_parities(rsblock.data, parities);
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               rsblock.fec(i) = parities[i];
+            }
+
             return true;
          }
 
@@ -109,21 +115,66 @@ namespace schifra
          encoder(const encoder& enc);
          encoder& operator=(const encoder& enc);
 
-         inline galois::field_polynomial msg_poly(const block_type& rsblock) const
+         void create_lfsr_table()
          {
-            galois::field_polynomial message(field_, code_length);
+            /*
+              Systematic encoding is the remainder of msg(x).x^fec_length
+              divided by the generator g(x). It is computed with a linear
+              feedback shift register, where each step multiplies the
+              feedback symbol by every (monic normalised) coefficient of
+              g(x). Those products are precomputed: the row of the feedback
+              value f holds f.g[fec_length - 1 - i] for each register cell i.
+            */
+
+            const std::size_t row_count = field_.size() + 1;
+            const galois::field_symbol leading = generator_[fec_length].poly();
 
-            for (std::size_t i = fec_length; i < code_length; ++i)
+            lfsr_table_.resize(row_count * fec_length);
+
+            for (std::size_t f = 0; f < row_count; ++f)
             {
-               message[i] = rsblock.data[code_length - 1 - i];
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  const galois::field_symbol g = field_.gen_div(generator_[fec_length - 1 - i].poly(), leading);
+                  lfsr_table_[(f * fec_length) + i] = field_.gen_mul(static_cast<galois::field_symbol>(f), g);
+               }
             }
+         }
 
-            return message;
+         template <typename T>
+         inline void compute_parities(const T data[], galois::field_symbol parities[]) const
+         {
+            /*
+              Register cell i holds the coefficient of x^(fec_length - 1 - i)
+              of the running remainder, so parities come out in fec order.
+            */
+
+            const galois::field_symbol mask = field_.mask();
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               parities[i] = 0;
+            }
+
+            for (std::size_t d = 0; d < data_length; ++d)
+            {
+               const galois::field_symbol  feedback = (static_cast<galois::field_symbol>(data[d]) ^ parities[0]) & mask;
+               const galois::field_symbol* product  = &lfsr_table_[feedback * fec_length];
+
+               for (std::size_t i = 0; i < (fec_length - 1); ++i)
+               {
+                  parities[i] = parities[i + 1] ^ product[i];
+               }
+
+               parities[fec_length - 1] = product[fec_length - 1];
+            }
          }
 
-         const bool                     encoder_valid_;
-         const galois::field&           field_;
-         const galois::field_polynomial generator_;
+         const bool                        encoder_valid_;
+         const bool                        generator_valid_;
+         const galois::field&              field_;
+         const galois::field_polynomial    generator_;
+         std::vector<galois::field_symbol> lfsr_table_;
       };
 
       template <std::size_t code_length,
@@ -0,0 +1,154 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The table driven (LFSR) encoder against the remainder of
+                msg(x).x^fec_length divided by the generator, computed with
+                field_polynomial arithmetic, for various codes and messages.
+*/
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_codec_validator.hpp"
+
+
+template <std::size_t code_length, std::size_t fec_length>
+bool reference_parities(const schifra::galois::field& field,
+                        const schifra::galois::field_polynomial& generator,
+                        const schifra::reed_solomon::block<code_length,fec_length>& block)
+{
+   /* msg(x).x^fec_length mod g(x), the data symbol 0 being the highest power */
+   schifra::galois::field_polynomial message(field, code_length - 1);
+
+   for (std::size_t i = fec_length; i < code_length; ++i)
+   {
+      message[i] = block.data[code_length - 1 - i];
+   }
+
+   const schifra::galois::field_polynomial remainder = message % generator;
+
+   for (std::size_t i = 0; i < fec_length; ++i)
+   {
+      const std::size_t term = fec_length - 1 - i;
+      const schifra::galois::field_symbol expected = (static_cast<int>(term) <= remainder.deg()) ? remainder[term].poly() : 0;
+
+      if (block.data[code_length - fec_length + i] != expected)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+template <std::size_t field_descriptor, std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+bool encoder_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[])
+{
+   typedef schifra::reed_solomon::encoder<code_length,fec_length> encoder_t;
+   typedef schifra::reed_solomon::block<code_length,fec_length>   block_t;
+
+   const std::size_t data_length = code_length - fec_length;
+
+   const schifra::galois::field field(field_descriptor, prim_poly_size, prim_poly);
+
+   schifra::galois::field_polynomial generator(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator))
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t encoder(field, generator);
+
+   std::vector<std::string> message_list;
+   schifra::reed_solomon::create_messages<data_length>(message_list);
+
+   for (std::size_t i = 0; i < 32; ++i)
+   {
+      std::string message(data_length, 0x00);
+
+      for (std::size_t j = 0; j < data_length; ++j)
+      {
+         message[j] = static_cast<char>(::rand() & 0xFF);
+      }
+
+      message_list.push_back(message);
+   }
+
+   for (std::size_t i = 0; i < message_list.size(); ++i)
+   {
+      block_t block;
+
+      if (!encoder.encode(message_list[i], block))
+      {
+         std::cout << "Error - Failed to encode message " << i << " of RS("
+                   << code_length << "," << data_length << ")" << std::endl;
+         return false;
+      }
+
+      if (!reference_parities(field, generator, block))
+      {
+         std::cout << "Error - Parity mismatch on message " << i << " of RS("
+                   << code_length << "," << data_length << ")" << std::endl;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   ::srand(0x5C41F8A);
+
+   bool encoder_validation_result = encoder_validation_test<8,120,255,  2>(primitive_polynomial_size06,primitive_polynomial06) &&
+                                    encoder_validation_test<8,120,255,  7>(primitive_polynomial_size06,primitive_polynomial06) &&
+                                    encoder_validation_test<8,120,255, 16>(primitive_polynomial_size06,primitive_polynomial06) &&
+                                    encoder_validation_test<8,120,255, 32>(primitive_polynomial_size06,primitive_polynomial06) &&
+                                    encoder_validation_test<8,120,255,128>(primitive_polynomial_size06,primitive_polynomial06) &&
+                                    encoder_validation_test<8,  1,255, 32>(primitive_polynomial_size05,primitive_polynomial05) &&
+                                    encoder_validation_test<8,  0,255, 20>(primitive_polynomial_size05,primitive_polynomial05) &&
+                                    encoder_validation_test<4,  1, 15,  6>(primitive_polynomial_size01,primitive_polynomial01) ;
+
+   if (encoder_validation_result)
+   {
+      std::cout << "Schifra Reed-Solomon Encoder Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Encoder Validation Failure!" << std::endl;
+      return 1;
+   }
+}
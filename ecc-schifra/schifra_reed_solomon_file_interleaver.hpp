@@ -24,8 +24,11 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_FILE_INTERLEAVER_HPP
 
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "schifra_reed_solomon_interleaving.hpp"
 #include "schifra_fileio.hpp"
@@ -37,13 +40,26 @@ namespace schifra
    namespace reed_solomon
    {
 
+      /*
+         The files are streamed by buffers of whole stacks (about 8MB), each stack
+         is (de)interleaved from the input buffer to the output buffer: two stream
+         calls per buffer instead of two per block.
+      */
+      template <std::size_t block_length, std::size_t stack_size>
+      inline std::size_t file_interleaver_buffer_size()
+      {
+         const std::size_t stack_bytes = block_length * stack_size;
+
+         return stack_bytes * std::max<std::size_t>(1, (8 * 1024 * 1024) / stack_bytes);
+      }
+
       template <std::size_t block_length, std::size_t stack_size>
       class file_interleaver
       {
       public:
 
          file_interleaver(const std::string& input_file_name,
-                          const std::string& output_file_name)
+                         const std::string& output_file_name)
          {
             std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
 
@@ -69,15 +85,33 @@ namespace schifra
                return;
             }
 
-            while (remaining_bytes >= (block_length * stack_size))
-            {
-               process_block(in_stream,out_stream);
-               remaining_bytes -= (block_length * stack_size);
-            }
+            const std::size_t buffer_size = file_interleaver_buffer_size<block_length,stack_size>();
 
-            if (remaining_bytes > 0)
+            std::vector<unsigned char> in_buffer (std::min(buffer_size,remaining_bytes));
+            std::vector<unsigned char> out_buffer(in_buffer.size());
+
+            while (remaining_bytes > 0)
             {
-               process_incomplete_block(in_stream,out_stream,remaining_bytes);
+               const std::size_t amount = std::min(buffer_size,remaining_bytes);
+
+               if (!in_stream.read(reinterpret_cast<char*>(&in_buffer[0]),static_cast<std::streamsize>(amount)))
+               {
+                  std::cout << "reed_solomon::file_interleaver() - Error: input file could not be read." << std::endl;
+                  return;
+               }
+
+               for (std::size_t offset = 0; offset < amount; offset += (block_length * stack_size))
+               {
+                  process_stack(&in_buffer[offset],std::min(block_length * stack_size,amount - offset),&out_buffer[offset]);
+               }
+
+               if (!out_stream.write(reinterpret_cast<const char*>(&out_buffer[0]),static_cast<std::streamsize>(amount)))
+               {
+                  std::cout << "reed_solomon::file_interleaver() - Error: output file could not be written." << std::endl;
+                  return;
+               }
+
+               remaining_bytes -= amount;
             }
 
             in_stream.close();
@@ -86,57 +120,18 @@ namespace schifra
 
       private:
 
-         inline void process_block(std::ifstream& in_stream,
-                                   std::ofstream& out_stream)
-         {
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            interleave<char,block_length,stack_size>(block_stack_);
-
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-         }
-
-         inline void process_incomplete_block(std::ifstream& in_stream,
-                                              std::ofstream& out_stream,
-                                              const std::size_t amount)
+         // A full stack, or the incomplete one at the end of the file (its last block may be partial)
+         inline void process_stack(const unsigned char* in, const std::size_t amount, unsigned char* out)
          {
-            std::size_t complete_row_count = amount / block_length;
-            std::size_t remainder = amount % block_length;
-
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            if (remainder != 0)
-            {
-               in_stream.read(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
+            const std::size_t complete_row_count = amount / block_length;
+            const std::size_t remainder = amount % block_length;
 
             if (remainder == 0)
-               interleave<char,block_length,stack_size>(block_stack_,complete_row_count);
+               interleave(in,complete_row_count,block_length,block_length,out);
             else
-               interleave<char,block_length>(block_stack_,complete_row_count + 1,remainder);
-
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            if (remainder != 0)
-            {
-               out_stream.write(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
+               interleave(in,complete_row_count + 1,block_length,remainder,out);
          }
 
-         data_block<char,block_length> block_stack_[stack_size];
-
       };
 
       template <std::size_t block_length, std::size_t stack_size>
@@ -145,11 +140,11 @@ namespace schifra
       public:
 
          file_deinterleaver(const std::string& input_file_name,
-                            const std::string& output_file_name)
+                           const std::string& output_file_name)
          {
-            std::size_t input_file_size = schifra::fileio::file_size(input_file_name);
+            std::size_t remaining_bytes = schifra::fileio::file_size(input_file_name);
 
-            if (input_file_size == 0)
+            if (0 == remaining_bytes)
             {
                std::cout << "reed_solomon::file_deinterleaver() - Error: input file has ZERO size." << std::endl;
                return;
@@ -171,14 +166,33 @@ namespace schifra
                return;
             }
 
-            for (std::size_t i = 0; i < (input_file_size / (block_length * stack_size)); ++i)
-            {
-               process_block(in_stream,out_stream);
-            }
+            const std::size_t buffer_size = file_interleaver_buffer_size<block_length,stack_size>();
+
+            std::vector<unsigned char> in_buffer (std::min(buffer_size,remaining_bytes));
+            std::vector<unsigned char> out_buffer(in_buffer.size());
 
-            if ((input_file_size % (block_length * stack_size)) != 0)
+            while (remaining_bytes > 0)
             {
-               process_incomplete_block(in_stream,out_stream,(input_file_size % (block_length * stack_size)));
+               const std::size_t amount = std::min(buffer_size,remaining_bytes);
+
+               if (!in_stream.read(reinterpret_cast<char*>(&in_buffer[0]),static_cast<std::streamsize>(amount)))
+               {
+                  std::cout << "reed_solomon::file_deinterleaver() - Error: input file could not be read." << std::endl;
+                  return;
+               }
+
+               for (std::size_t offset = 0; offset < amount; offset += (block_length * stack_size))
+               {
+                  process_stack(&in_buffer[offset],std::min(block_length * stack_size,amount - offset),&out_buffer[offset]);
+               }
+
+               if (!out_stream.write(reinterpret_cast<const char*>(&out_buffer[0]),static_cast<std::streamsize>(amount)))
+               {
+                  std::cout << "reed_solomon::file_deinterleaver() - Error: output file could not be written." << std::endl;
+                  return;
+               }
+
+               remaining_bytes -= amount;
             }
 
             in_stream.close();
@@ -187,57 +201,18 @@ namespace schifra
 
       private:
 
-         inline void process_block(std::ifstream& in_stream,
-                                   std::ofstream& out_stream)
-         {
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            deinterleave<char,block_length,stack_size>(block_stack_);
-
-            for (std::size_t i = 0; i < stack_size; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-         }
-
-         inline void process_incomplete_block(std::ifstream& in_stream,
-                                              std::ofstream& out_stream,
-                                              const std::size_t amount)
+         // A full stack, or the incomplete one at the end of the file (its last block may be partial)
+         inline void process_stack(const unsigned char* in, const std::size_t amount, unsigned char* out)
          {
-            std::size_t complete_row_count = amount / block_length;
-            std::size_t remainder = amount % block_length;
-
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               in_stream.read(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            if (remainder != 0)
-            {
-               in_stream.read(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
+            const std::size_t complete_row_count = amount / block_length;
+            const std::size_t remainder = amount % block_length;
 
             if (remainder == 0)
-               deinterleave<char,block_length>(block_stack_,complete_row_count);
+               deinterleave(in,complete_row_count,block_length,block_length,out);
             else
-               deinterleave<char,block_length>(block_stack_,complete_row_count + 1,remainder);
-
-            for (std::size_t i = 0; i < complete_row_count; ++i)
-            {
-               out_stream.write(&block_stack_[i][0],static_cast<std::streamsize>(block_length));
-            }
-
-            if (remainder != 0)
-            {
-               out_stream.write(&block_stack_[complete_row_count][0],static_cast<std::streamsize>(remainder));
-            }
+               deinterleave(in,complete_row_count + 1,block_length,remainder,out);
          }
 
-         data_block<char,block_length> block_stack_[stack_size];
-
       };
 
    } // namespace reed_solomon
@@ -0,0 +1,800 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+#ifndef INCLUDE_SCHIFRA_REED_SOLOMON_FIXED_DECODER_HPP
+#define INCLUDE_SCHIFRA_REED_SOLOMON_FIXED_DECODER_HPP
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_chien_search.hpp"
+#include "schifra_ecc_traits.hpp"
+
+
+namespace schifra
+{
+
+   namespace reed_solomon
+   {
+
+      /*
+         Polynomial with a compile-time capacity, living on the stack.
+         term[i] is the coefficient of x^i, degree is -1 for the zero
+         polynomial.
+      */
+      template <std::size_t capacity>
+      struct fixed_polynomial
+      {
+         galois::field_symbol term[capacity];
+         int                  degree;
+
+         inline void assign(const galois::field_symbol value)
+         {
+            term[0] = value;
+            degree  = (value != 0) ? 0 : -1;
+         }
+
+         inline void simplify()
+         {
+            while ((degree >= 0) && (0 == term[degree]))
+            {
+               --degree;
+            }
+         }
+
+         inline galois::field_symbol evaluate(const galois::field& field, const galois::field_symbol value) const
+         {
+            galois::field_symbol result = 0;
+
+            for (int i = degree; i >= 0; --i)
+            {
+               result = field.mul(result, value) ^ term[i];
+            }
+
+            return result;
+         }
+      };
+
+      /*
+         Same algorithm as reed_solomon::decoder (syndrome, modified
+         Berlekamp-Massey, Chien search, Forney) but every intermediate
+         polynomial is a fixed_polynomial sized from fec_length. All of
+         them are grouped in a workspace, either given by the caller
+         (one per thread) or created on the stack, so that decoding a
+         block never touches the heap.
+
+         The workspace also caches the decoding matrices of the last
+         erasure patterns: the codewords crossing the same lost sectors
+         share their erasure positions, and are then corrected with a
+         matrix-vector product over their syndromes.
+      */
+      template <std::size_t code_length, std::size_t fec_length, std::size_t data_length = code_length - fec_length>
+      class fixed_decoder
+      {
+      public:
+
+         typedef traits::reed_solomon_triat<code_length,fec_length,data_length> trait;
+         typedef block<code_length,fec_length> block_type;
+         typedef byte_block<code_length,fec_length> byte_block_type;
+
+         // The BMA shifts previous_lambda once per round: its degree stays below 2 * fec_length + 2
+         enum { polynomial_capacity = (2 * fec_length) + 2 };
+
+         typedef fixed_polynomial<fec_length>          syndrome_type;
+         typedef fixed_polynomial<polynomial_capacity> locator_type;
+
+         enum { erasure_pattern_cache_size = 4 };
+
+         // Sorted erasure positions of a codeword, and their decoding matrix once built (see decode_erasure_pattern)
+         struct erasure_pattern
+         {
+            const fixed_decoder* owner;
+            std::size_t          count;
+            std::size_t          positions[fec_length];
+            bool                 built;
+            galois::field_symbol matrix[fec_length][fec_length];
+         };
+
+         struct workspace
+         {
+            workspace()
+            : pattern_count(0),
+              next_pattern (0)
+            {}
+
+            syndrome_type   syndrome;
+            locator_type    lambda;
+            locator_type    previous_lambda;
+            locator_type    tau;
+            syndrome_type   omega;
+            locator_type    lambda_derivative;
+            std::size_t     erasure_locations[fec_length];
+            std::size_t     error_locations  [fec_length];
+            std::size_t     error_count;
+            std::size_t     sorted_erasures  [fec_length];
+            erasure_pattern patterns[erasure_pattern_cache_size];
+            std::size_t     pattern_count;
+            std::size_t     next_pattern;
+         };
+
+         fixed_decoder(const galois::field& field,
+                       const unsigned int& gen_initial_index = 0,
+                       const galois::simd_level level = galois::detect_simd_level())
+         : decoder_valid_(field.size() == code_length),
+           field_(field),
+           chien_search_(field, level),
+           gen_initial_index_(gen_initial_index)
+         {
+            if (decoder_valid_)
+            {
+               create_lookup_tables();
+            }
+         }
+
+         const galois::field& field() const
+         {
+            return field_;
+         }
+
+         bool decode(block_type& rsblock) const
+         {
+            workspace ws;
+            return decode(rsblock, 0, 0, ws);
+         }
+
+         bool decode(block_type& rsblock, workspace& ws) const
+         {
+            return decode(rsblock, 0, 0, ws);
+         }
+
+         bool decode(block_type& rsblock, const erasure_locations_t& erasure_list) const
+         {
+            workspace ws;
+            return decode(rsblock, erasure_list.empty() ? 0 : &erasure_list[0], erasure_list.size(), ws);
+         }
+
+         bool decode(block_type& rsblock, const erasure_locations_t& erasure_list, workspace& ws) const
+         {
+            return decode(rsblock, erasure_list.empty() ? 0 : &erasure_list[0], erasure_list.size(), ws);
+         }
+
+         bool decode(block_type& rsblock,
+                     const std::size_t erasure_list[], const std::size_t erasure_count,
+                     workspace& ws) const
+         {
+            return decode_codeword(rsblock, erasure_list, erasure_count, ws);
+         }
+
+         bool decode(byte_block_type& rsblock, workspace& ws) const
+         {
+            return decode_codeword(rsblock, 0, 0, ws);
+         }
+
+         bool decode(byte_block_type& rsblock,
+                     const std::size_t erasure_list[], const std::size_t erasure_count,
+                     workspace& ws) const
+         {
+            return decode_codeword(rsblock, erasure_list, erasure_count, ws);
+         }
+
+         /*
+            GF(2^8) codeword decoded in place in the caller's buffers:
+            data_length data bytes and fec_length parity bytes.
+         */
+         bool decode(std::uint8_t data[], std::uint8_t parity[], workspace& ws) const
+         {
+            buffer_codeword codeword(data, parity);
+            return decode_codeword(codeword, 0, 0, ws);
+         }
+
+         bool decode(std::uint8_t data[], std::uint8_t parity[],
+                     const std::size_t erasure_list[], const std::size_t erasure_count,
+                     workspace& ws) const
+         {
+            buffer_codeword codeword(data, parity);
+            return decode_codeword(codeword, erasure_list, erasure_count, ws);
+         }
+
+      private:
+
+         fixed_decoder();
+         fixed_decoder(const fixed_decoder& dec);
+         fixed_decoder& operator=(const fixed_decoder& dec);
+
+         // Codeword split over two caller buffers, with the decoding state of a block
+         struct buffer_codeword
+         {
+            buffer_codeword(std::uint8_t data[], std::uint8_t parity[])
+            : errors_detected (0),
+              errors_corrected(0),
+              zero_numerators (0),
+              unrecoverable(false),
+              error(block_type::e_no_error),
+              data_(data),
+              parity_(parity)
+            {}
+
+            inline std::uint8_t& operator[](const std::size_t& index)
+            {
+               return (index < data_length) ? data_[index] : parity_[index - data_length];
+            }
+
+            inline const std::uint8_t& operator[](const std::size_t& index) const
+            {
+               return (index < data_length) ? data_[index] : parity_[index - data_length];
+            }
+
+            std::size_t                    errors_detected;
+            std::size_t                   errors_corrected;
+            std::size_t                    zero_numerators;
+            bool                             unrecoverable;
+            typename block_type::error_t             error;
+            std::uint8_t*                            data_;
+            std::uint8_t*                          parity_;
+         };
+
+         template <typename codeword_t>
+         bool decode_codeword(codeword_t& rsblock,
+                              const std::size_t erasure_list[], const std::size_t erasure_count,
+                              workspace& ws) const
+         {
+            if ((!decoder_valid_) || (erasure_count > fec_length))
+            {
+               rsblock.errors_detected  = 0;
+               rsblock.errors_corrected = 0;
+               rsblock.zero_numerators  = 0;
+               rsblock.unrecoverable    = true;
+               rsblock.error            = block_type::e_decoder_error0;
+
+               return false;
+            }
+
+            // Built by the first decoding: the clean codewords of a verification never need them
+            field_.prepare(galois::field::e_mul_table | galois::field::e_div_table);
+
+            if (0 == compute_syndrome(rsblock, ws.syndrome))
+            {
+               rsblock.errors_detected  = 0;
+               rsblock.errors_corrected = 0;
+               rsblock.zero_numerators  = 0;
+               rsblock.unrecoverable    = false;
+
+               return true;
+            }
+
+            if (erasure_count && decode_erasure_pattern(rsblock, erasure_list, erasure_count, ws))
+            {
+               return true;
+            }
+
+            ws.lambda.assign(1);
+
+            if (erasure_count)
+            {
+               prepare_erasure_list(ws.erasure_locations, erasure_list, erasure_count);
+
+               compute_gamma(ws.lambda, ws.erasure_locations, erasure_count);
+            }
+
+            if (erasure_count < fec_length)
+            {
+               modified_berlekamp_massey_algorithm(ws, erasure_count);
+            }
+
+            find_roots(ws.lambda, ws.error_locations, ws.error_count);
+
+            if (0 == ws.error_count)
+            {
+               /*
+                 Syndrome is non-zero yet no error locations have
+                 been obtained: more errors than can be corrected.
+               */
+
+               rsblock.errors_detected  = 0;
+               rsblock.errors_corrected = 0;
+               rsblock.zero_numerators  = 0;
+               rsblock.unrecoverable    = true;
+               rsblock.error            = block_type::e_decoder_error1;
+
+               return false;
+            }
+            else if (((2 * ws.error_count) - erasure_count) > fec_length)
+            {
+               // Too many errors\erasures! 2E + S <= fec_length
+
+               rsblock.errors_detected  = ws.error_count;
+               rsblock.errors_corrected = 0;
+               rsblock.zero_numerators  = 0;
+               rsblock.unrecoverable    = true;
+               rsblock.error            = block_type::e_decoder_error2;
+
+               return false;
+            }
+            else
+               rsblock.errors_detected  = ws.error_count;
+
+            return forney_algorithm(ws, rsblock);
+         }
+
+         /*
+            Erasures only decoding of a known erasure pattern. Without
+            other errors, the errata values are linear in the syndromes:
+            value[k] = sum(j < count) matrix[k][j].S[j] (Forney, omega
+            only depends on the first count syndromes), and the other
+            syndromes must be the ones of those values:
+            S[i] = sum(k < count) matrix[i][k].value[k] for i >= count.
+            A mismatch (errors besides the erasures) returns false, for
+            the full decoding.
+         */
+         template <typename codeword_t>
+         bool decode_erasure_pattern(codeword_t& rsblock,
+                                     const std::size_t erasure_list[], const std::size_t erasure_count,
+                                     workspace& ws) const
+         {
+            const erasure_pattern* pattern = find_erasure_pattern(erasure_list, erasure_count, ws);
+
+            if (0 == pattern)
+               return false;
+
+            const syndrome_type& syndrome = ws.syndrome;
+            galois::field_symbol values[fec_length];
+
+            for (std::size_t k = 0; k < erasure_count; ++k)
+            {
+               galois::field_symbol value = 0;
+
+               for (std::size_t j = 0; j < erasure_count; ++j)
+               {
+                  value ^= field_.mul(pattern->matrix[k][j], syndrome.term[j]);
+               }
+
+               values[k] = value;
+            }
+
+            for (std::size_t i = erasure_count; i < fec_length; ++i)
+            {
+               galois::field_symbol expected = 0;
+
+               for (std::size_t k = 0; k < erasure_count; ++k)
+               {
+                  expected ^= field_.mul(pattern->matrix[i][k], values[k]);
+               }
+
+               if (expected != syndrome.term[i])
+                  return false;
+            }
+
+            rsblock.errors_detected  = erasure_count;
+            rsblock.errors_corrected = 0;
+            rsblock.zero_numerators  = 0;
+
+            for (std::size_t k = 0; k < erasure_count; ++k)
+            {
+               if (0 != values[k])
+               {
+                  rsblock[pattern->positions[k]] ^= values[k];
+                  rsblock.errors_corrected++;
+               }
+               else
+                  ++rsblock.zero_numerators;
+            }
+
+            return true;
+         }
+
+         /*
+            The cached pattern of the erasures, 0 when not usable yet:
+            a pattern seen once is only remembered, its matrix is built
+            the second time (a lone pattern is cheaper to decode through
+            the full algorithm than to invert).
+         */
+         const erasure_pattern* find_erasure_pattern(const std::size_t erasure_list[], const std::size_t erasure_count, workspace& ws) const
+         {
+            std::size_t* sorted = ws.sorted_erasures;
+
+            std::copy(erasure_list, erasure_list + erasure_count, sorted);
+            std::sort(sorted, sorted + erasure_count);
+
+            for (std::size_t i = 0; i < ws.pattern_count; ++i)
+            {
+               erasure_pattern& pattern = ws.patterns[i];
+
+               if ((pattern.owner != this) || (pattern.count != erasure_count) || !std::equal(sorted, sorted + erasure_count, pattern.positions))
+                  continue;
+
+               if (!pattern.built)
+               {
+                  pattern.built = build_erasure_pattern(pattern);
+
+                  // Invalid positions (duplicates): never again
+                  if (!pattern.built)
+                     pattern.owner = 0;
+               }
+
+               return pattern.built ? &pattern : 0;
+            }
+
+            erasure_pattern& pattern = ws.patterns[ws.next_pattern];
+
+            pattern.owner = this;
+            pattern.count = erasure_count;
+            pattern.built = false;
+            std::copy(sorted, sorted + erasure_count, pattern.positions);
+
+            ws.next_pattern = (ws.next_pattern + 1) % erasure_pattern_cache_size;
+
+            if (ws.pattern_count < erasure_pattern_cache_size)
+               ++ws.pattern_count;
+
+            return 0;
+         }
+
+         bool build_erasure_pattern(erasure_pattern& pattern) const
+         {
+            const std::size_t count = pattern.count;
+
+            std::size_t locations[fec_length];
+            prepare_erasure_list(locations, pattern.positions, count);
+
+            locator_type gamma;
+            gamma.assign(1);
+            compute_gamma(gamma, locations, count);
+
+            // Formal derivative: only the odd terms survive in characteristic 2
+            locator_type gamma_derivative;
+            gamma_derivative.degree = gamma.degree - 1;
+
+            for (int j = 0; j <= gamma_derivative.degree; ++j)
+            {
+               gamma_derivative.term[j] = ((j & 1) == 0) ? gamma.term[j + 1] : 0;
+            }
+
+            gamma_derivative.simplify();
+
+            // Row k: value[k] = X^(1 - gen_initial_index).omega(y) / gamma'(y), y = 1/X, omega[m] = sum(i + j = m) gamma[i].S[j]
+            for (std::size_t k = 0; k < count; ++k)
+            {
+               const galois::field_symbol y           = field_.gen_inverse(field_.alpha(static_cast<galois::field_symbol>(locations[k])));
+               const galois::field_symbol denominator = gamma_derivative.evaluate(field_, y);
+
+               if (0 == denominator)
+                  return false;
+
+               const galois::field_symbol scale = field_.div(root_exponent_table_[pattern.positions[k] + 1], denominator);
+
+               // partial[n] = sum(i <= n) gamma[i].y^i
+               galois::field_symbol partial[fec_length];
+               galois::field_symbol power = 1;
+               galois::field_symbol sum   = 0;
+
+               for (std::size_t n = 0; n < count; ++n)
+               {
+                  sum       ^= field_.mul(gamma.term[n], power);
+                  partial[n] = sum;
+                  power      = field_.mul(power, y);
+               }
+
+               // S[j] weighs y^j.partial[count - 1 - j]
+               power = 1;
+
+               for (std::size_t j = 0; j < count; ++j)
+               {
+                  pattern.matrix[k][j] = field_.mul(scale, field_.mul(power, partial[count - 1 - j]));
+                  power = field_.mul(power, y);
+               }
+            }
+
+            // Row i >= count: the contribution of each erasure to S[i], (alpha^(gen_initial_index + i))^location
+            for (std::size_t i = count; i < fec_length; ++i)
+            {
+               for (std::size_t k = 0; k < count; ++k)
+               {
+                  pattern.matrix[i][k] = field_.gen_exp(syndrome_exponent_table_[i], locations[k]);
+               }
+            }
+
+            return true;
+         }
+
+         void create_lookup_tables()
+         {
+            root_exponent_table_.reserve(field_.size() + 1);
+
+            // x^(1 - gen_initial_index), the exponent taken modulo the order of the field
+            const std::size_t root_exponent = (field_.size() + 1 - (gen_initial_index_ % field_.size())) % field_.size();
+
+            for (int i = 0; i < static_cast<int>(field_.size() + 1); ++i)
+            {
+               root_exponent_table_.push_back(field_.gen_exp(field_.alpha(code_length - i), root_exponent));
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               syndrome_exponent_table_[i] = field_.alpha(static_cast<galois::field_symbol>(gen_initial_index_ + i));
+            }
+         }
+
+         void prepare_erasure_list(std::size_t erasure_locations[],
+                                   const std::size_t erasure_list[], const std::size_t erasure_count) const
+         {
+            /*
+              Note: 1. Erasure positions must be unique.
+                    2. Erasure positions must exist within the code block.
+            */
+
+            for (std::size_t i = 0; i < erasure_count; ++i)
+            {
+               erasure_locations[i] = (code_length - 1 - erasure_list[i]);
+            }
+         }
+
+         template <typename codeword_t>
+         galois::field_symbol compute_syndrome(const codeword_t& rsblock, syndrome_type& syndrome) const
+         {
+            /*
+              The received polynomial has rsblock[0] as its highest term,
+              each syndrome is its evaluation at a generator root (Horner).
+              All the syndromes are advanced together, symbol by symbol,
+              so that their multiply chains are independent.
+            */
+
+            const galois::field_symbol mask = field_.mask();
+            galois::field_symbol error_flag = 0;
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               syndrome.term[i] = 0;
+            }
+
+            for (std::size_t j = 0; j < code_length; ++j)
+            {
+               const galois::field_symbol symbol = rsblock[j] & mask;
+
+               for (std::size_t i = 0; i < fec_length; ++i)
+               {
+                  syndrome.term[i] = field_.mul(syndrome.term[i], syndrome_exponent_table_[i]) ^ symbol;
+               }
+            }
+
+            for (std::size_t i = 0; i < fec_length; ++i)
+            {
+               error_flag |= syndrome.term[i];
+            }
+
+            syndrome.degree = static_cast<int>(fec_length) - 1;
+            syndrome.simplify();
+
+            return error_flag;
+         }
+
+         void compute_gamma(locator_type& gamma, const std::size_t erasure_locations[], const std::size_t erasure_count) const
+         {
+            // gamma *= (1 + alpha^location.x) for each erasure
+            for (std::size_t i = 0; i < erasure_count; ++i)
+            {
+               const galois::field_symbol root = field_.alpha(static_cast<galois::field_symbol>(erasure_locations[i]));
+
+               gamma.term[gamma.degree + 1] = 0;
+
+               for (int j = gamma.degree + 1; j > 0; --j)
+               {
+                  gamma.term[j] ^= field_.mul(gamma.term[j - 1], root);
+               }
+
+               ++gamma.degree;
+            }
+
+            gamma.simplify();
+         }
+
+         void find_roots(const locator_type& poly, std::size_t root_list[], std::size_t& root_count) const
+         {
+            /*
+               Chien Search: Find the roots of the error locator polynomial
+               via an exhaustive search over all non-zero elements in the
+               given finite field (incremental and vectorized, see
+               chien_search).
+            */
+
+            const std::size_t polynomial_degree = (poly.degree > 0) ? poly.degree : 0;
+
+            root_count = chien_search_.find_roots(poly.term, polynomial_degree, root_list);
+         }
+
+         void modified_berlekamp_massey_algorithm(workspace& ws, const std::size_t erasure_count) const
+         {
+            /*
+               Modified Berlekamp-Massey Algorithm
+               Identify the shortest length linear feed-back shift register (LFSR)
+               that will generate the sequence equivalent to the syndrome.
+            */
+
+            locator_type& lambda          = ws.lambda;
+            locator_type& previous_lambda = ws.previous_lambda;
+            locator_type& tau             = ws.tau;
+
+            const syndrome_type& syndrome = ws.syndrome;
+
+            int i = -1;
+            std::size_t l = erasure_count;
+
+            // previous_lambda = lambda << 1
+            previous_lambda.term[0] = 0;
+            for (int j = 0; j <= lambda.degree; ++j)
+            {
+               previous_lambda.term[j + 1] = lambda.term[j];
+            }
+            previous_lambda.degree = lambda.degree + 1;
+
+            for (std::size_t round = erasure_count; round < fec_length; ++round)
+            {
+               // Discrepancy of lambda at the current round
+               const int upper_bound = std::min(std::min(static_cast<int>(l), lambda.degree), static_cast<int>(round));
+
+               galois::field_symbol discrepancy = 0;
+
+               for (int j = 0; j <= upper_bound; ++j)
+               {
+                  const std::size_t index = round - j;
+                  const galois::field_symbol s = (static_cast<int>(index) <= syndrome.degree) ? syndrome.term[index] : 0;
+                  discrepancy ^= field_.mul(lambda.term[j], s);
+               }
+
+               if (discrepancy != 0)
+               {
+                  // tau = lambda - discrepancy * previous_lambda
+                  tau.degree = std::max(lambda.degree, previous_lambda.degree);
+
+                  for (int j = 0; j <= tau.degree; ++j)
+                  {
+                     const galois::field_symbol a = (j <= lambda.degree         ) ? lambda.term[j]          : 0;
+                     const galois::field_symbol b = (j <= previous_lambda.degree) ? previous_lambda.term[j] : 0;
+                     tau.term[j] = a ^ field_.mul(discrepancy, b);
+                  }
+
+                  tau.simplify();
+
+                  if (static_cast<int>(l) < (static_cast<int>(round) - i))
+                  {
+                     const std::size_t tmp = round - i;
+                     i = static_cast<int>(round - l);
+                     l = tmp;
+
+                     // previous_lambda = lambda / discrepancy
+                     for (int j = 0; j <= lambda.degree; ++j)
+                     {
+                        previous_lambda.term[j] = field_.div(lambda.term[j], discrepancy);
+                     }
+                     previous_lambda.degree = lambda.degree;
+                  }
+
+                  lambda = tau;
+               }
+
+               // previous_lambda <<= 1
+               for (int j = previous_lambda.degree; j >= 0; --j)
+               {
+                  previous_lambda.term[j + 1] = previous_lambda.term[j];
+               }
+               previous_lambda.term[0] = 0;
+               previous_lambda.degree += 1;
+            }
+         }
+
+         template <typename codeword_t>
+         bool forney_algorithm(workspace& ws, codeword_t& rsblock) const
+         {
+            /*
+               The Forney algorithm for computing the error magnitudes
+            */
+
+            const locator_type&  lambda   = ws.lambda;
+            const syndrome_type& syndrome = ws.syndrome;
+
+            // omega = (lambda * syndrome) mod x^fec_length
+            syndrome_type& omega = ws.omega;
+
+            for (std::size_t j = 0; j < fec_length; ++j)
+            {
+               omega.term[j] = 0;
+            }
+
+            for (int a = 0; a <= lambda.degree; ++a)
+            {
+               for (int b = 0; (b <= syndrome.degree) && ((a + b) < static_cast<int>(fec_length)); ++b)
+               {
+                  omega.term[a + b] ^= field_.mul(lambda.term[a], syndrome.term[b]);
+               }
+            }
+
+            omega.degree = static_cast<int>(fec_length) - 1;
+            omega.simplify();
+
+            // Formal derivative: only the odd terms survive in characteristic 2
+            locator_type& lambda_derivative = ws.lambda_derivative;
+
+            lambda_derivative.degree = lambda.degree - 1;
+
+            for (int j = 0; j <= lambda_derivative.degree; ++j)
+            {
+               lambda_derivative.term[j] = ((j & 1) == 0) ? lambda.term[j + 1] : 0;
+            }
+
+            lambda_derivative.simplify();
+
+            rsblock.errors_corrected = 0;
+            rsblock.zero_numerators  = 0;
+
+            for (std::size_t i = 0; i < ws.error_count; ++i)
+            {
+               const std::size_t          error_location = ws.error_locations[i];
+               const galois::field_symbol alpha_inverse  = field_.alpha(static_cast<galois::field_symbol>(error_location));
+               const galois::field_symbol numerator      = field_.mul(omega.evaluate(field_, alpha_inverse), root_exponent_table_[error_location]);
+               const galois::field_symbol denominator    = lambda_derivative.evaluate(field_, alpha_inverse);
+
+               if (0 != numerator)
+               {
+                  if (0 != denominator)
+                  {
+                     rsblock[error_location - 1] ^= field_.div(numerator, denominator);
+                     rsblock.errors_corrected++;
+                  }
+                  else
+                  {
+                     rsblock.unrecoverable = true;
+                     rsblock.error         = block_type::e_decoder_error3;
+                     return false;
+                  }
+               }
+               else
+                  ++rsblock.zero_numerators;
+            }
+
+            if (lambda.degree == static_cast<int>(rsblock.errors_detected))
+               return true;
+            else
+            {
+               rsblock.unrecoverable = true;
+               rsblock.error         = block_type::e_decoder_error4;
+               return false;
+            }
+         }
+
+         const bool                           decoder_valid_;
+         const galois::field&                 field_;
+         chien_search<code_length,fec_length> chien_search_;
+         std::vector<galois::field_symbol>    root_exponent_table_;
+         galois::field_symbol                 syndrome_exponent_table_[fec_length];
+         const unsigned int                   gen_initial_index_;
+      };
+
+   } // namespace reed_solomon
+
+} // namespace schifra
+
+#endif
@@ -0,0 +1,340 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The fixed_decoder (every engine of its Chien search, its
+                block, byte block and buffer interfaces) against the
+                reference reed_solomon::decoder, on codewords with random
+                errors and erasures, within and beyond the capacity of the
+                code, and on codewords sharing a few erasure patterns (the
+                cached decoding matrices), with and without other errors.
+*/
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "schifra_galois_field.hpp"
+#include "schifra_galois_field_polynomial.hpp"
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_sequential_root_generator_polynomial_creator.hpp"
+#include "schifra_reed_solomon_block.hpp"
+#include "schifra_reed_solomon_encoder.hpp"
+#include "schifra_reed_solomon_decoder.hpp"
+#include "schifra_reed_solomon_fixed_decoder.hpp"
+
+
+// Add distinct random positions of a codeword to positions, up to count of them
+template <std::size_t code_length>
+void random_positions(const std::size_t count, std::vector<std::size_t>& positions)
+{
+   while (positions.size() < count)
+   {
+      const std::size_t position = static_cast<std::size_t>(::rand()) % code_length;
+
+      if (std::find(positions.begin(), positions.end(), position) == positions.end())
+      {
+         positions.push_back(position);
+      }
+   }
+}
+
+template <std::size_t code_length, std::size_t fec_length>
+bool same_result(const schifra::reed_solomon::block<code_length,fec_length>& expected, const bool expected_result,
+                 const schifra::reed_solomon::block<code_length,fec_length>& block, const bool result)
+{
+   if (expected_result != result)
+      return false;
+
+   // Unrecoverable codewords may be left partially corrected by both decoders
+   if (!result)
+      return true;
+
+   for (std::size_t i = 0; i < code_length; ++i)
+   {
+      if (expected.data[i] != block.data[i])
+         return false;
+   }
+
+   return true;
+}
+
+template <std::size_t field_descriptor, std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+bool fixed_decoder_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[],
+                                   const schifra::galois::simd_level level, const std::size_t trial_count)
+{
+   typedef schifra::reed_solomon::encoder<code_length,fec_length>       encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length>       decoder_t;
+   typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length> fixed_decoder_t;
+   typedef schifra::reed_solomon::block<code_length,fec_length>         block_t;
+   typedef typename fixed_decoder_t::byte_block_type                    byte_block_t;
+
+   const std::size_t data_length = code_length - fec_length;
+   const bool byte_symbols = (8 == field_descriptor);
+
+   const schifra::galois::field field(field_descriptor, prim_poly_size, prim_poly);
+
+   schifra::galois::field_polynomial generator(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator))
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t       encoder(field, generator);
+   const decoder_t       decoder(field, gen_poly_index);
+   const fixed_decoder_t fixed_decoder(field, gen_poly_index, level);
+
+   // One workspace for all the trials, as a worker thread would use it
+   typename fixed_decoder_t::workspace* ws = new typename fixed_decoder_t::workspace;
+
+   std::vector<std::size_t> error_positions;
+   std::vector<std::size_t> erasure_positions;
+
+   bool result = true;
+
+   for (std::size_t trial = 0; result && (trial < trial_count); ++trial)
+   {
+      block_t original;
+
+      for (std::size_t i = 0; i < data_length; ++i)
+      {
+         original.data[i] = static_cast<schifra::galois::field_symbol>(::rand()) & field.mask();
+      }
+
+      if (!encoder.encode(original))
+      {
+         std::cout << "Error - Failed to encode trial " << trial << std::endl;
+         result = false;
+         break;
+      }
+
+      erasure_positions.clear();
+      random_positions<code_length>(static_cast<std::size_t>(::rand()) % (fec_length + 1), erasure_positions);
+
+      // Mostly correctable (2.errors + erasures <= fec_length), sometimes beyond
+      const std::size_t erasure_count = erasure_positions.size();
+      const std::size_t max_errors    = (fec_length - erasure_count) / 2 + (((trial % 8) == 7) ? 2 : 0);
+      const std::size_t error_count   = std::min(static_cast<std::size_t>(::rand()) % (max_errors + 1), code_length - erasure_count);
+
+      // The erasures come first
+      error_positions = erasure_positions;
+      random_positions<code_length>(erasure_count + error_count, error_positions);
+
+      block_t received = original;
+
+      for (std::size_t i = 0; i < error_positions.size(); ++i)
+      {
+         // Erasures may hold their correct value, errors never do
+         const schifra::galois::field_symbol noise = static_cast<schifra::galois::field_symbol>(::rand()) & field.mask();
+         received.data[error_positions[i]] ^= ((i < erasure_count) || noise) ? noise : 1;
+      }
+
+      block_t expected = received;
+      const bool expected_result = decoder.decode(expected, erasure_positions);
+
+      if (expected_result && !std::equal(original.data, original.data + code_length, expected.data) && ((2 * error_count) + erasure_count <= fec_length))
+      {
+         std::cout << "Error - Reference decoder failed to correct trial " << trial << std::endl;
+         result = false;
+         break;
+      }
+
+      const std::size_t* erasures = erasure_positions.empty() ? 0 : &erasure_positions[0];
+
+      block_t block = received;
+      const bool fixed_result = fixed_decoder.decode(block, erasures, erasure_count, *ws);
+      result = same_result(expected, expected_result, block, fixed_result);
+
+      if (result && byte_symbols)
+      {
+         byte_block_t byte_block;
+         std::copy(received.data, received.data + code_length, byte_block.data);
+
+         const bool byte_result = fixed_decoder.decode(byte_block, erasures, erasure_count, *ws);
+         std::copy(byte_block.data, byte_block.data + code_length, block.data);
+         result = same_result(expected, expected_result, block, byte_result);
+
+         std::copy(received.data, received.data + code_length, byte_block.data);
+
+         const bool buffer_result = fixed_decoder.decode(byte_block.data, byte_block.data + data_length, erasures, erasure_count, *ws);
+         std::copy(byte_block.data, byte_block.data + code_length, block.data);
+         result = result && same_result(expected, expected_result, block, buffer_result);
+      }
+
+      if (!result)
+      {
+         std::cout << "Error - fixed_decoder (" << schifra::galois::simd_level_name(level) << ") differs from decoder on RS("
+                   << code_length << "," << data_length << ") trial " << trial << ": "
+                   << error_count << " errors, " << erasure_count << " erasures" << std::endl;
+      }
+   }
+
+   delete ws;
+
+   return result;
+}
+
+/*
+   Codewords cycling through pattern_count erasure patterns (more than the
+   cache holds), each one erased with or without a few other errors
+*/
+template <std::size_t field_descriptor, std::size_t gen_poly_index, std::size_t code_length, std::size_t fec_length>
+bool erasure_pattern_validation_test(const std::size_t prim_poly_size, const unsigned int prim_poly[], const std::size_t trial_count)
+{
+   typedef schifra::reed_solomon::encoder<code_length,fec_length>       encoder_t;
+   typedef schifra::reed_solomon::decoder<code_length,fec_length>       decoder_t;
+   typedef schifra::reed_solomon::fixed_decoder<code_length,fec_length> fixed_decoder_t;
+   typedef schifra::reed_solomon::block<code_length,fec_length>         block_t;
+
+   const std::size_t data_length   = code_length - fec_length;
+   const std::size_t pattern_count = fixed_decoder_t::erasure_pattern_cache_size + 1;
+
+   const schifra::galois::field field(field_descriptor, prim_poly_size, prim_poly);
+
+   schifra::galois::field_polynomial generator(field);
+
+   if (!schifra::make_sequential_root_generator_polynomial(field, gen_poly_index, fec_length, generator))
+   {
+      std::cout << "Error - Failed to create sequential root generator!" << std::endl;
+      return false;
+   }
+
+   const encoder_t       encoder(field, generator);
+   const decoder_t       decoder(field, gen_poly_index);
+   const fixed_decoder_t fixed_decoder(field, gen_poly_index);
+
+   typename fixed_decoder_t::workspace* ws = new typename fixed_decoder_t::workspace;
+
+   // From a single erasure to fec_length of them, the last pattern is unsorted
+   std::vector<std::size_t> patterns[pattern_count];
+   for (std::size_t p = 0; p < pattern_count; ++p)
+   {
+      random_positions<code_length>(std::max<std::size_t>(1, (p * fec_length) / (pattern_count - 1)), patterns[p]);
+
+      if (p + 1 < pattern_count)
+         std::sort(patterns[p].begin(), patterns[p].end());
+   }
+
+   std::vector<std::size_t> error_positions;
+
+   bool result = true;
+
+   for (std::size_t trial = 0; result && (trial < trial_count); ++trial)
+   {
+      const std::vector<std::size_t>& erasure_positions = patterns[(trial / 3) % pattern_count];
+      const std::size_t erasure_count = erasure_positions.size();
+
+      block_t original;
+
+      for (std::size_t i = 0; i < data_length; ++i)
+      {
+         original.data[i] = static_cast<schifra::galois::field_symbol>(::rand()) & field.mask();
+      }
+
+      if (!encoder.encode(original))
+      {
+         std::cout << "Error - Failed to encode trial " << trial << std::endl;
+         result = false;
+         break;
+      }
+
+      // Mostly the erasures only, else errors within or beyond the capacity
+      const std::size_t capacity    = (fec_length - erasure_count) / 2;
+      const std::size_t error_count = ((trial % 5) < 3) ? 0 : std::min(capacity + ((trial % 5) - 3) * 2, code_length - erasure_count);
+
+      error_positions = erasure_positions;
+      random_positions<code_length>(erasure_count + error_count, error_positions);
+
+      block_t received = original;
+
+      for (std::size_t i = 0; i < error_positions.size(); ++i)
+      {
+         const schifra::galois::field_symbol noise = static_cast<schifra::galois::field_symbol>(::rand()) & field.mask();
+         received.data[error_positions[i]] ^= ((i < erasure_count) || noise) ? noise : 1;
+      }
+
+      block_t expected = received;
+      const bool expected_result = decoder.decode(expected, erasure_positions);
+
+      block_t block = received;
+      const bool fixed_result = fixed_decoder.decode(block, &erasure_positions[0], erasure_count, *ws);
+
+      if (!same_result(expected, expected_result, block, fixed_result) ||
+          (fixed_result && (block.errors_detected != expected.errors_detected || block.errors_corrected != expected.errors_corrected)))
+      {
+         std::cout << "Error - fixed_decoder differs from decoder on RS(" << code_length << "," << data_length << ") erasure pattern trial "
+                   << trial << ": " << error_count << " errors, " << erasure_count << " erasures" << std::endl;
+         result = false;
+      }
+      else if ((0 == error_count) && (!fixed_result || !std::equal(original.data, original.data + code_length, block.data)))
+      {
+         std::cout << "Error - fixed_decoder failed to correct " << erasure_count << " erasures on RS(" << code_length << "," << data_length << ") trial " << trial << std::endl;
+         result = false;
+      }
+   }
+
+   delete ws;
+
+   return result;
+}
+
+int main()
+{
+   using namespace schifra::galois;
+
+   ::srand(0x3D5E2A1);
+
+   bool fixed_decoder_validation_result = true;
+
+   for (int i = e_simd_scalar; fixed_decoder_validation_result && (i <= e_simd_gfni); ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+
+      if (!simd_level_supported(level))
+         continue;
+
+      fixed_decoder_validation_result = fixed_decoder_validation_test<8,120,255,32>(primitive_polynomial_size06,primitive_polynomial06,level,2000) &&
+                                        fixed_decoder_validation_test<8,  1,255,16>(primitive_polynomial_size05,primitive_polynomial05,level,1000) &&
+                                        fixed_decoder_validation_test<8,  0,255, 6>(primitive_polynomial_size05,primitive_polynomial05,level,1000) &&
+                                        fixed_decoder_validation_test<4,  1, 15, 6>(primitive_polynomial_size01,primitive_polynomial01,level,1000) ;
+   }
+
+   fixed_decoder_validation_result = fixed_decoder_validation_result &&
+                                     erasure_pattern_validation_test<8,120,255,32>(primitive_polynomial_size06,primitive_polynomial06,3000) &&
+                                     erasure_pattern_validation_test<4,  1, 15, 6>(primitive_polynomial_size01,primitive_polynomial01,1000) ;
+
+   if (fixed_decoder_validation_result)
+   {
+      std::cout << "Schifra Reed-Solomon Fixed Decoder Successfully Validated!" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Fixed Decoder Validation Failure!" << std::endl;
+      return 1;
+   }
+}
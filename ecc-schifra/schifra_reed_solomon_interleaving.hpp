@@ -24,10 +24,12 @@
 #define INCLUDE_SCHIFRA_REED_SOLOMON_INTERLEAVING_HPP
 
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <string>
 
+#include "schifra_galois_field_simd.hpp"
 #include "schifra_reed_solomon_block.hpp"
 
 
@@ -632,6 +634,181 @@ namespace schifra
          }
       }
 
+      namespace details
+      {
+         /*
+            Byte transpose kernels: a 16x16 tile is transposed in registers by 4 rounds of
+            byte unpacks, round k interleaving row i with row i + 8 (a perfect shuffle of the
+            rows, 4 of them swap the row and the column index bits). The avx2 kernel runs
+            the same rounds on 16 rows of 32 bytes, one 16x16 tile per 128 bit lane.
+         */
+
+         #if defined(SCHIFRA_GALOIS_SIMD_X86)
+
+         __attribute__((target("sse2")))
+         inline void transpose_tile_sse2(const unsigned char* in, const std::size_t in_stride,
+                                         unsigned char* out, const std::size_t out_stride)
+         {
+            __m128i r[16];
+            __m128i t[16];
+
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + (i * in_stride)));
+            }
+
+            for (std::size_t round = 0; round < 4; ++round)
+            {
+               for (std::size_t i = 0; i < 8; ++i)
+               {
+                  t[2 * i    ] = _mm_unpacklo_epi8(r[i], r[i + 8]);
+                  t[2 * i + 1] = _mm_unpackhi_epi8(r[i], r[i + 8]);
+               }
+
+               for (std::size_t i = 0; i < 16; ++i)
+               {
+                  r[i] = t[i];
+               }
+            }
+
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i * out_stride)), r[i]);
+            }
+         }
+
+         __attribute__((target("avx2")))
+         inline void transpose_tile_avx2(const unsigned char* in, const std::size_t in_stride,
+                                         unsigned char* out, const std::size_t out_stride)
+         {
+            __m256i r[16];
+            __m256i t[16];
+
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               r[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (i * in_stride)));
+            }
+
+            for (std::size_t round = 0; round < 4; ++round)
+            {
+               for (std::size_t i = 0; i < 8; ++i)
+               {
+                  t[2 * i    ] = _mm256_unpacklo_epi8(r[i], r[i + 8]);
+                  t[2 * i + 1] = _mm256_unpackhi_epi8(r[i], r[i + 8]);
+               }
+
+               for (std::size_t i = 0; i < 16; ++i)
+               {
+                  r[i] = t[i];
+               }
+            }
+
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(out + ( i       * out_stride)), _mm256_castsi256_si128(r[i]));
+               _mm_storeu_si128(reinterpret_cast<__m128i*>(out + ((i + 16) * out_stride)), _mm256_extracti128_si256(r[i], 1));
+            }
+         }
+
+         #endif
+
+         inline void transpose_tile_scalar(const unsigned char* in, const std::size_t rows, const std::size_t columns, const std::size_t in_stride,
+                                           unsigned char* out, const std::size_t out_stride)
+         {
+            for (std::size_t column = 0; column < columns; ++column)
+            {
+               for (std::size_t row = 0; row < rows; ++row)
+               {
+                  out[column * out_stride + row] = in[row * in_stride + column];
+               }
+            }
+         }
+      }
+
+      /*
+         Transpose of a matrix of bytes: in is rows x columns (row i at in + i * in_stride),
+         out is columns x rows (row j at out + j * out_stride). The matrix is walked by strips
+         of 16 rows, each strip from the left to the right: the 16 input rows are sequential
+         streams, and within a tile the rows are the inner loop, so every write to out is a
+         run of 16 bytes (a wide stride, e.g. a 4096 byte sector, would otherwise alias every
+         byte access in the same cache set). The full 16x16 tiles go to the vector kernel of
+         the cpu, the edges of the matrix to the scalar loop.
+      */
+      const std::size_t transpose_tile_rows = 16;
+
+      inline void transpose(const unsigned char* in, const std::size_t rows, const std::size_t columns, const std::size_t in_stride,
+                            unsigned char* out, const std::size_t out_stride,
+                            const galois::simd_level level = galois::detect_simd_level())
+      {
+         for (std::size_t row = 0; row < rows; row += transpose_tile_rows)
+         {
+            const std::size_t tile_rows = std::min(transpose_tile_rows, rows - row);
+            std::size_t column = 0;
+
+            #if defined(SCHIFRA_GALOIS_SIMD_X86)
+            if (tile_rows == transpose_tile_rows)
+            {
+               if (level >= galois::e_simd_avx2)
+               {
+                  for ( ; (column + 32) <= columns; column += 32)
+                  {
+                     details::transpose_tile_avx2(in + (row * in_stride) + column, in_stride, out + (column * out_stride) + row, out_stride);
+                  }
+               }
+
+               if (level >= galois::e_simd_ssse3)
+               {
+                  for ( ; (column + 16) <= columns; column += 16)
+                  {
+                     details::transpose_tile_sse2(in + (row * in_stride) + column, in_stride, out + (column * out_stride) + row, out_stride);
+                  }
+               }
+            }
+            #else
+            (void)level;
+            #endif
+
+            details::transpose_tile_scalar(in + (row * in_stride) + column, tile_rows, columns - column, in_stride,
+                                           out + (column * out_stride) + row, out_stride);
+         }
+      }
+
+      inline void transpose(const unsigned char* in, const std::size_t rows, const std::size_t columns, unsigned char* out)
+      {
+         transpose(in, rows, columns, columns, out, rows);
+      }
+
+      /*
+         interleave/deinterleave of a stack of row_count blocks of bytes (block i at
+         in + i * block_length), the last one partial_block_length bytes long: the same
+         symbol order as the data_block versions, out of place and through the transpose.
+         The first partial_block_length columns hold row_count symbols, the others one
+         less, out holds (row_count - 1) * block_length + partial_block_length bytes.
+      */
+      inline void interleave(const unsigned char* in,
+                             const std::size_t row_count,
+                             const std::size_t block_length,
+                             const std::size_t partial_block_length,
+                             unsigned char* out)
+      {
+         transpose(in, row_count, partial_block_length, block_length, out, row_count);
+
+         transpose(in + partial_block_length, row_count - 1, block_length - partial_block_length, block_length,
+                   out + (partial_block_length * row_count), row_count - 1);
+      }
+
+      inline void deinterleave(const unsigned char* in,
+                               const std::size_t row_count,
+                               const std::size_t block_length,
+                               const std::size_t partial_block_length,
+                               unsigned char* out)
+      {
+         transpose(in, partial_block_length, row_count, row_count, out, block_length);
+
+         transpose(in + (partial_block_length * row_count), block_length - partial_block_length, row_count - 1, row_count - 1,
+                   out + partial_block_length, block_length);
+      }
+
    } // namespace reed_solomon
 
 } // namespace schifra
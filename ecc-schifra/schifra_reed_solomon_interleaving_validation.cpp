@@ -0,0 +1,217 @@
+/*
+(**************************************************************************)
+(*                                                                        *)
+(*                                Schifra                                 *)
+(*                Reed-Solomon Error Correcting Code Library              *)
+(*                                                                        *)
+(* Release Version 0.0.1                                                  *)
+(* http://www.schifra.com                                                 *)
+(* Copyright (c) 2000-2020 Arash Partow, All Rights Reserved.             *)
+(*                                                                        *)
+(* The Schifra Reed-Solomon error correcting code library and all its     *)
+(* components are supplied under the terms of the General Schifra License *)
+(* agreement. The contents of the Schifra Reed-Solomon error correcting   *)
+(* code library and all its components may not be copied or disclosed     *)
+(* except in accordance with the terms of that agreement.                 *)
+(*                                                                        *)
+(* URL: http://www.schifra.com/license.html                               *)
+(*                                                                        *)
+(**************************************************************************)
+*/
+
+
+/*
+   Description: The byte transpose of every supported engine against a naive
+                loop (tile edges, strides), the byte interleave/deinterleave
+                against the data_block versions for every row count and partial
+                block length, and the round trip of the file interleaver over
+                several buffers with an incomplete last stack.
+*/
+
+
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "schifra_galois_field_simd.hpp"
+#include "schifra_reed_solomon_interleaving.hpp"
+#include "schifra_reed_solomon_file_interleaver.hpp"
+#include "schifra_fileio.hpp"
+
+
+unsigned char pattern(const std::size_t i)
+{
+   return static_cast<unsigned char>((i * 131) + (i >> 9) + 7);
+}
+
+bool transpose_validation_test()
+{
+   using namespace schifra::galois;
+
+   const std::size_t shapes[][2] = { { 1, 1 }, { 15, 17 }, { 16, 16 }, { 16, 32 }, { 17, 33 }, { 32, 48 }, { 223, 100 }, { 100, 223 }, { 47, 1000 } };
+
+   for (int i = e_simd_scalar; i <= e_simd_gfni; ++i)
+   {
+      const simd_level level = static_cast<simd_level>(i);
+
+      if (!simd_level_supported(level))
+         continue;
+
+      for (std::size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s)
+      {
+         const std::size_t rows       = shapes[s][0];
+         const std::size_t columns    = shapes[s][1];
+         const std::size_t in_stride  = columns + (s % 3) * 5;
+         const std::size_t out_stride = rows    + (s % 2) * 3;
+
+         std::vector<unsigned char> in(rows * in_stride);
+         std::vector<unsigned char> out(columns * out_stride, 0xA5);
+
+         for (std::size_t k = 0; k < in.size(); ++k)
+         {
+            in[k] = pattern(k);
+         }
+
+         schifra::reed_solomon::transpose(&in[0], rows, columns, in_stride, &out[0], out_stride, level);
+
+         for (std::size_t column = 0; column < columns; ++column)
+         {
+            for (std::size_t k = 0; k < out_stride; ++k)
+            {
+               const unsigned char expected = (k < rows) ? in[k * in_stride + column] : static_cast<unsigned char>(0xA5);
+
+               if (out[column * out_stride + k] != expected)
+               {
+                  std::cout << "Error - Transpose mismatch (" << simd_level_name(level) << ") " << rows << "x" << columns << " at " << column << "," << k << std::endl;
+                  return false;
+               }
+            }
+         }
+      }
+   }
+
+   return true;
+}
+
+bool byte_interleave_validation_test()
+{
+   const std::size_t block_length = 37;
+
+   typedef schifra::reed_solomon::data_block<unsigned char,block_length> data_block_t;
+
+   for (std::size_t row_count = 1; row_count <= 40; ++row_count)
+   {
+      for (std::size_t partial_block_length = 1; partial_block_length <= block_length; ++partial_block_length)
+      {
+         const std::size_t size = (row_count - 1) * block_length + partial_block_length;
+
+         std::vector<unsigned char> data(row_count * block_length, 0);
+         std::vector<data_block_t> stack(row_count);
+
+         for (std::size_t k = 0; k < size; ++k)
+         {
+            data[k] = pattern(k + row_count);
+            stack[k / block_length][k % block_length] = data[k];
+         }
+
+         std::vector<unsigned char> interleaved(size);
+         std::vector<unsigned char> deinterleaved(size);
+
+         schifra::reed_solomon::interleave(&data[0], row_count, block_length, partial_block_length, &interleaved[0]);
+         schifra::reed_solomon::interleave<unsigned char,block_length>(&stack[0], row_count, partial_block_length);
+
+         for (std::size_t k = 0; k < size; ++k)
+         {
+            if (interleaved[k] != stack[k / block_length][k % block_length])
+            {
+               std::cout << "Error - Interleave mismatch: " << row_count << " rows, partial block length " << partial_block_length << std::endl;
+               return false;
+            }
+         }
+
+         schifra::reed_solomon::deinterleave(&interleaved[0], row_count, block_length, partial_block_length, &deinterleaved[0]);
+         schifra::reed_solomon::deinterleave<unsigned char,block_length>(&stack[0], row_count, partial_block_length);
+
+         for (std::size_t k = 0; k < size; ++k)
+         {
+            if ((deinterleaved[k] != data[k]) || (stack[k / block_length][k % block_length] != data[k]))
+            {
+               std::cout << "Error - Deinterleave mismatch: " << row_count << " rows, partial block length " << partial_block_length << std::endl;
+               return false;
+            }
+         }
+      }
+   }
+
+   return true;
+}
+
+bool file_interleaver_validation_test()
+{
+   const std::size_t block_length = 255;
+   const std::size_t stack_size   = 255;
+   const std::size_t stack_bytes  = block_length * stack_size;
+   const std::size_t buffer_size  = schifra::reed_solomon::file_interleaver_buffer_size<block_length,stack_size>();
+
+   const std::size_t sizes[] = { 1, block_length + 1, stack_bytes - 1, stack_bytes, 3 * stack_bytes + 2 * block_length, 2 * buffer_size + stack_bytes + 1000 };
+
+   const std::string input_file_name         = "interleaving_validation.dat";
+   const std::string interleaved_file_name   = "interleaving_validation.intr";
+   const std::string deinterleaved_file_name = "interleaving_validation.deintr";
+
+   bool result = true;
+
+   for (std::size_t s = 0; result && (s < sizeof(sizes) / sizeof(sizes[0])); ++s)
+   {
+      std::string data(sizes[s], 0x00);
+
+      for (std::size_t k = 0; k < data.size(); ++k)
+      {
+         data[k] = static_cast<char>(pattern(k));
+      }
+
+      schifra::fileio::write_file(input_file_name, data);
+
+      schifra::reed_solomon::file_interleaver  <block_length,stack_size>(input_file_name, interleaved_file_name);
+      schifra::reed_solomon::file_deinterleaver<block_length,stack_size>(interleaved_file_name, deinterleaved_file_name);
+
+      std::string interleaved;
+      std::string deinterleaved;
+      schifra::fileio::load_file(interleaved_file_name, interleaved);
+      schifra::fileio::load_file(deinterleaved_file_name, deinterleaved);
+
+      // A full stack: block i of the interleaved file holds symbol i of every block
+      if ((sizes[s] >= stack_bytes) && (interleaved[stack_size * 3 + 2] != data[2 * block_length + 3]))
+      {
+         std::cout << "Error - File interleaver symbol order, " << sizes[s] << " bytes" << std::endl;
+         result = false;
+      }
+      else if ((interleaved.size() != data.size()) || (deinterleaved != data))
+      {
+         std::cout << "Error - File interleaver round trip, " << sizes[s] << " bytes" << std::endl;
+         result = false;
+      }
+   }
+
+   std::remove(input_file_name.c_str());
+   std::remove(interleaved_file_name.c_str());
+   std::remove(deinterleaved_file_name.c_str());
+
+   return result;
+}
+
+int main()
+{
+   if (transpose_validation_test() && byte_interleave_validation_test() && file_interleaver_validation_test())
+   {
+      std::cout << "Schifra Reed-Solomon Interleaving Successfully Validated! (engine: " << schifra::galois::simd_level_name(schifra::galois::detect_simd_level()) << ")" << std::endl;
+      return 0;
+   }
+   else
+   {
+      std::cout << "Schifra Reed-Solomon Interleaving Validation Failure!" << std::endl;
+      return 1;
+   }
+}
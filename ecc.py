@@ -20,13 +20,16 @@ import sys
 from colorama import init, Fore
 init( autoreset=True )
 
-from ecc.ecc_schifra import cEccSchifra
+from ecc.ecc_schifra import cEccSchifra, process_batch
 
 #---
 
 parser = argparse.ArgumentParser()
-parser.add_argument( 'action', choices=['create', 'check-size', 'fix', 'fix-and-compare'], help='The action to process' )
+parser.add_argument( 'action', choices=['create', 'check-size', 'verify', 'repair', 'fix', 'fix-and-compare'], help='The action to process' )
 parser.add_argument( '-i', '--input', nargs='+', type=Path, required=True, help='The input file' )
+parser.add_argument( '--sha512', action='store_true', help='create/verify: also create/check the sha512 files (as hash-create.sh/hash-check.sh) in the same read' )
+parser.add_argument( '--crc-index', action='store_true', help='create: store the crc of every codeword in the ecc files (faster verify, bursts up to 32 bytes corrected)' )
+parser.add_argument( '--interleave', action='store_true', help='create: interleave the codewords of the ecc files over 4096 bytes sectors (a dead sector is correctable, not with --crc-index)' )
 args = parser.parse_args()
 
 #---
@@ -55,18 +58,56 @@ if not_existing_input:
 
 #---
 
+# Those actions are processed by a single executable for all the files
+batch_actions = { 'create': 'encode', 'verify': 'verify', 'fix': 'decode' }
+if args.action in batch_actions:
+    print( Fore.GREEN + f'Info: {len(eccs)} files to process' )
+    options = []
+    if args.sha512 and args.action != 'fix':
+        options.append( '--sha512' )
+    if args.crc_index and args.action == 'create':
+        options.append( '--crc-index' )
+    if args.interleave and args.action == 'create':
+        options.append( '--interleave' )
+
+    # The files the executable will create: open to everyone afterwards, as with the per-file actions
+    created_files = []
+    if args.action == 'create':
+        created_files = [ ecc.mFileEcc for ecc in eccs if not ecc.mFileEcc.is_file() ]
+    elif args.action == 'fix':
+        created_files = [ ecc.mFileFix for ecc in eccs if ecc.mFileEcc.is_file() ]
+
+    status = process_batch( batch_actions[args.action], args.input, options )
+
+    for created_file in created_files:
+        if created_file.is_file():
+            created_file.chmod( 0o777 )
+
+    if status:
+        print( Fore.RED + 'Some input files could not be processed or are corrupted' )
+        sys.exit( 1 )
+    sys.exit( 0 )
+
+#---
+
 print( Fore.GREEN + f'Info: {len(eccs)} files to process' )
 
+corrupted_inputs = []
+
 for i, ecc in enumerate( eccs ):
     progress_ratio = i / ( len(eccs) - 1 )
     progress_percent = int( progress_ratio * 100 )
     print( Fore.GREEN + f'Info: file {i}/{len(eccs) - 1} - {progress_percent}%' )
 
-    if args.action == 'create':
-        ecc.ProcessCreate()
-    elif args.action == 'check-size':
+    if args.action == 'check-size':
         ecc.ProcessCheckSize()
-    elif args.action == 'fix':
-        ecc.ProcessFix( False )
+    elif args.action == 'repair':
+        if ecc.ProcessRepair():
+            corrupted_inputs.append( ecc.mFileInput )
     elif args.action == 'fix-and-compare':
         ecc.ProcessFix( True )
+
+if corrupted_inputs:
+    print( Fore.RED + 'Some input files are corrupted:' )
+    [ print( Fore.RED + str(input) ) for input in corrupted_inputs ]
+    sys.exit( 1 )
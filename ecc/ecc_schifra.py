@@ -11,7 +11,9 @@
 
 import datetime
 from pathlib import Path
+import struct
 import subprocess
+import zlib
 
 from colorama import init, deinit, Fore, Style
 init( autoreset=True )
@@ -31,6 +33,15 @@ def now():
 def print_progress( iCurrent, iTotal ):
     print( '[{}]   processed: {:.2f}%'.format( now(), iCurrent / iTotal * 100.0 ), end='\r' )
 
+## The executable of a code, in the directory of ecc.py
+#
+#  @param  iSizeResult  int  The code length
+#  @param  iSizeFec     int  The fec length
+#  @param  iExp         int  The bits per symbol
+#  @return              Path The path of the executable
+def executable_path( iSizeResult=255, iSizeFec=32, iExp=8 ):
+    return Path( __file__ ).resolve().parent.parent / f'ecc-schifra-{iSizeResult}-{iSizeFec}-{iExp}'
+
 #---
 
 ## Manage the ecc file
@@ -49,8 +60,7 @@ class cEccSchifra:
         self.mSizeFec = self.mSizeResult - self.mSizeMessage
         self.mExp = 8
 
-        executable_path = Path( __file__ ).resolve().parent.parent
-        self.mExecutable = Path( executable_path ) / f'ecc-schifra-{self.mSizeResult}-{self.mSizeFec}-{self.mExp}'
+        self.mExecutable = executable_path( self.mSizeResult, self.mSizeFec, self.mExp )
 
         # Contains only the ecc data
         self.mFileEcc = Path( f'ecc-schifra-{self.mSizeResult}-{self.mSizeFec}-{self.mExp}' ) / self.mFileInput.with_suffix( self.mFileInput.suffix + f'.ecc-schifra-{self.mSizeResult}-{self.mSizeFec}-{self.mExp}' )
@@ -78,32 +88,6 @@ class cEccSchifra:
 
     #---
 
-    ## Create the ecc file
-    def ProcessCreate( self ):
-        size_to_process = self.mFileInput.stat().st_size
-
-        if self.mFileEcc.is_file():
-            print( Fore.CYAN + 'Skip: ecc file already exists: {}'.format( self.mFileEcc ) )
-            return
-
-        self.mFileEcc.parent.mkdir( parents=True, exist_ok=True )
-
-        #---
-
-        command = [ self.mExecutable, 
-                    '-v',
-                    'encode',
-                    '-i', self.mFileInput,
-                    '-o', self.mFileEcc ]
-
-        self._PrintHeader( command )
-        completed_process = subprocess.run( command )
-        self._PrintFooter( command )
-
-        #---
-
-        self.mFileEcc.chmod( 0o777 )
-
     ## Fix the input file via its ecc file
     def ProcessFix( self, iCompare ):
         if not self.mFileEcc.is_file():
@@ -140,6 +124,28 @@ class cEccSchifra:
             completed_process = subprocess.run( command )
             self._PrintFooter( command )
 
+    ## Repair the input file in place via its ecc file (only the corrected blocks are rewritten)
+    #
+    #  @return  int  The exit status of the executable (0: repaired or clean, 1: error or some blocks not correctable)
+    def ProcessRepair( self ):
+        if not self.mFileEcc.is_file():
+            print( Fore.CYAN + 'Skip: ecc file doesn\'t exists: {}'.format( self.mFileEcc ) )
+            return 0
+
+        #---
+
+        command = [ self.mExecutable, 
+                    '-v',
+                    'repair',
+                    '-i', self.mFileInput,
+                    '-e', self.mFileEcc ]
+
+        self._PrintHeader( command )
+        completed_process = subprocess.run( command )
+        self._PrintFooter( command )
+
+        return completed_process.returncode
+
     ## Check the ecc file size (proportional to the input file size)
     #
     #  @example: with mSizeResult = 255 & mSizeMessage = 223 & size_input = 411
@@ -170,6 +176,7 @@ class cEccSchifra:
     #                             |                       | begin_of_next_of_last_block_input
     #                 begin_of_last_block_input end_of_last_block_input
     #
+    #  With a header, its sizes are checked instead (the ecc size is then the header size + the records)
     def ProcessCheckSize( self ):
         size_input = self.mFileInput.stat().st_size
 
@@ -182,6 +189,29 @@ class cEccSchifra:
         block_size_ecc = self.mSizeResult - self.mSizeMessage
         block_size_input = self.mSizeMessage
 
+        header = self._ReadHeader()
+        if header:
+            if header['source_size'] != size_input:
+                print( Fore.RED + 'The input file size {} is not the one of the ecc header {}'.format( size_input, header['source_size'] ) )
+                return
+
+            # With a crc index (layout 1), the crc of each codeword (4 bytes) follows its parity
+            record_size = block_size_ecc + ( 4 if header['layout'] == 1 else 0 )
+            expected_size_ecc = header['header_size'] + -( -size_input // block_size_input ) * record_size
+            if size_ecc != expected_size_ecc:
+                print( Fore.RED + 'The ecc file size {} is not the one of its header {}'.format( size_ecc, expected_size_ecc ) )
+            return
+
+        # With a crc index, the crc of each codeword (4 bytes) follows its parity
+        number_of_block_input = -( -size_input // block_size_input )
+        if size_ecc and size_ecc == number_of_block_input * ( block_size_ecc + 4 ):
+            # 1024 codewords: as big as a destroyed header (4096 bytes) followed by the parities
+            if size_ecc == 4096 + number_of_block_input * block_size_ecc:
+                print( Fore.RED + 'The ecc file size {} is ambiguous: headerless with a crc index, or a destroyed header followed by the parities'.format( size_ecc ) )
+                return
+
+            block_size_ecc += 4
+
         number_of_block_ecc, remainder = divmod( size_ecc, block_size_ecc )
         if remainder:
             print( Fore.RED + 'The ecc file size {} is not a multiple of {}'.format( size_ecc, block_size_ecc ) )
@@ -201,6 +231,22 @@ class cEccSchifra:
             print( Fore.RED + 'The input file size {} is not between {} and {}'.format( size_input, begin_of_last_block_input + 1, end_of_last_block_input + 1 ) )
             return
 
+    ## Read the header of the ecc file (the first intact copy of its record, see ecc-header.hpp)
+    #
+    #  @return  dict  The layout, the header size and the source size (None: a headerless ecc file, or a destroyed header)
+    def _ReadHeader( self ):
+        with open( self.mFileEcc, 'rb' ) as file:
+            header = file.read( 4096 )
+
+        for offset in range( 0, len( header ) - 255, 1024 ):
+            record = header[offset:offset + 256]
+            if record[:8] == b'SCHIFRA\x1a' and zlib.crc32( record[:252] ) == struct.unpack( '<I', record[252:] )[0]:
+                version, layout, header_size = struct.unpack( '<HHI', record[8:16] )
+                source_size, = struct.unpack( '<Q', record[40:48] )
+                return { 'version': version, 'layout': layout, 'header_size': header_size, 'source_size': source_size }
+
+        return None
+
     #---
 
     ## Print information before running a command
@@ -231,3 +277,24 @@ class cEccSchifra:
         # print( Style.RESET_ALL )
         # deinit()
         # init( autoreset=True )
+
+#---
+
+## Create/Verify/Fix the ecc files of all the inputs in a single process
+#
+#  The executable walks the directories and applies the same rules as cEccSchifra
+#  (only the .gpg files, skip the existing ecc files on create, skip the missing ones otherwise),
+#  the field, the codec and the threads are shared by all the files.
+#
+#  @param  iAction   string          The action of the executable: 'encode', 'verify' or 'decode'
+#  @param  iInputs   list of Path    The input files and directories (a single file is a batch of one)
+#  @param  iOptions  list of string  The options of the executable ('--sha512': also create/check the 'sha512/<input>.sha512' files in the same read, '--crc-index', '--interleave')
+#  @return           int             The exit status of the executable (for verify: 0: clean, 1: error, 2: correctable, 3: not correctable)
+def process_batch( iAction, iInputs, iOptions=[] ):
+    command = [ executable_path(), '-v', iAction ] + iOptions
+    for input in iInputs:
+        command += [ '-i', input ]
+
+    completed_process = subprocess.run( command )
+
+    return completed_process.returncode